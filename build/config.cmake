@@ -59,6 +59,27 @@ IF (${WALRUS_MODE} STREQUAL "debug")
     SET (WALRUS_DEFINITIONS_COMMON ${WALRUS_DEFINITIONS_COMMON} -DGC_DEBUG)
 ENDIF()
 
+# interpreter dispatch: computed_goto (default with GCC/Clang) or switch
+IF (DEFINED WALRUS_DISPATCH)
+    IF (${WALRUS_DISPATCH} STREQUAL "switch")
+        SET (WALRUS_DEFINITIONS ${WALRUS_DEFINITIONS} -DWALRUS_DISABLE_COMPUTED_GOTO)
+    ELSEIF (NOT ${WALRUS_DISPATCH} STREQUAL "computed_goto")
+        MESSAGE (FATAL_ERROR ${WALRUS_DISPATCH} " is unsupported WALRUS_DISPATCH")
+    ENDIF()
+ENDIF()
+
+# bounds checks of memory accesses: explicit (default) or guard_page
+# guard_page reserves 8GB per memory and turns faults into traps, it needs a 64-bit little endian host
+IF (DEFINED WALRUS_BOUNDS_CHECK)
+    IF (${WALRUS_BOUNDS_CHECK} STREQUAL "guard_page")
+        SET (WALRUS_DEFINITIONS ${WALRUS_DEFINITIONS} -DWALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+        # the trap is thrown by the signal handler of the faulting load or store
+        SET (WALRUS_CXXFLAGS ${WALRUS_CXXFLAGS} -fnon-call-exceptions)
+    ELSEIF (NOT ${WALRUS_BOUNDS_CHECK} STREQUAL "explicit")
+        MESSAGE (FATAL_ERROR ${WALRUS_BOUNDS_CHECK} " is unsupported WALRUS_BOUNDS_CHECK")
+    ENDIF()
+ENDIF()
+
 IF (${WALRUS_OUTPUT} STREQUAL "shared_lib" AND ${WALRUS_HOST} STREQUAL "android")
     SET (WALRUS_LDFLAGS ${WALRUS_LDFLAGS} -shared)
 ENDIF()
@@ -109,6 +130,10 @@ IF (WALRUS_MEM_STATS)
     SET (PROFILER_FLAGS ${PROFILER_FLAGS} -DWALRUS_MEM_STATS)
 ENDIF()
 
+IF (WALRUS_BYTECODE_STATS)
+    SET (PROFILER_FLAGS ${PROFILER_FLAGS} -DWALRUS_BYTECODE_STATS)
+ENDIF()
+
 IF (WALRUS_VALGRIND)
     SET (PROFILER_FLAGS ${PROFILER_FLAGS} -DWALRUS_VALGRIND)
 ENDIF()
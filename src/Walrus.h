@@ -203,6 +203,7 @@ if (f.type == Type::B) { puts("failed in msvc."); }
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <clocale>
@@ -216,6 +217,7 @@ if (f.type == Type::B) { puts("failed in msvc."); }
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <set>
@@ -329,7 +331,7 @@ if (f.type == Type::B) { puts("failed in msvc."); }
 #define MAY_THREAD_LOCAL __thread
 #endif
 
-#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+#if (defined(COMPILER_GCC) || defined(COMPILER_CLANG)) && !defined(WALRUS_DISABLE_COMPUTED_GOTO)
 #define WALRUS_ENABLE_COMPUTED_GOTO
 // some devices cannot support getting label address from outside well
 #if (defined(CPU_ARM64) || (defined(CPU_ARM32) && defined(COMPILER_CLANG))) || defined(OS_DARWIN)
@@ -356,6 +358,31 @@ if (f.type == Type::B) { puts("failed in msvc."); }
 #define STACK_LIMIT_FROM_BASE (1024 * 1024 * 3) // 3MB
 #endif
 
+#ifndef VALUE_STACK_SIZE
+// frames of the wasm functions called by the interpreter loop
+#define VALUE_STACK_SIZE (1024 * 1024 * 16) // 16MB
+#endif
+
+#ifndef MEMORY_RESERVATION_LIMIT
+// address space reserved for a linear memory up front,
+// growing beyond it moves the memory to a new reservation
+#if defined(WALRUS_64)
+#define MEMORY_RESERVATION_LIMIT (1024ULL * 1024 * 1024 * 4) // 4GB
+#else
+#define MEMORY_RESERVATION_LIMIT (1024 * 1024 * 64) // 64MB
+#endif
+#endif
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+#if !defined(WALRUS_64) || defined(WALRUS_BIG_ENDIAN) || defined(COMPILER_MSVC)
+// every address reachable by a 32-bit index must be reserved
+#undef WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK
+#else
+// 4GB index + 4GB static offset, followed by an inaccessible page
+#define MEMORY_GUARD_RESERVATION_SIZE (1024ULL * 1024 * 1024 * 8 + 1024 * 64)
+#endif
+#endif
+
 #include "util/Optional.h"
 
 #endif
@@ -310,6 +310,15 @@ struct wasm_module_t : wasm_ref_t {
     }
 };
 
+struct wasm_module_streaming_t {
+    wasm_module_streaming_t(Store* store)
+        : parser(store, std::string())
+    {
+    }
+
+    WASMStreamingParser parser;
+};
+
 struct wasm_func_t : wasm_extern_t {
     wasm_func_t(const wasm_func_t& other)
         : wasm_extern_t(other.get(), other.type()->clone())
@@ -809,6 +818,25 @@ bool wasm_module_validate(wasm_store_t* store, const wasm_byte_vec_t* binary)
     return true;
 }
 
+own wasm_module_streaming_t* wasm_module_streaming_new(wasm_store_t* store)
+{
+    return new wasm_module_streaming_t(store->get());
+}
+
+bool wasm_module_streaming_append(wasm_module_streaming_t* streaming, const wasm_byte_t* data, size_t size)
+{
+    return streaming->parser.append(reinterpret_cast<const uint8_t*>(data), size).empty();
+}
+
+own wasm_module_t* wasm_module_streaming_finish(wasm_module_streaming_t* streaming)
+{
+    auto parseResult = streaming->parser.finish();
+    if (!parseResult.first.hasValue()) {
+        return nullptr;
+    }
+    return new wasm_module_t(parseResult.first.unwrap());
+}
+
 void wasm_module_imports(const wasm_module_t* module, own wasm_importtype_vec_t* out)
 {
     const VectorWithFixedSize<ImportType*, std::allocator<ImportType*>>& importTypes = module->get()->imports();
@@ -1098,8 +1126,7 @@ bool wasm_table_grow(wasm_table_t* table, wasm_table_size_t delta, wasm_ref_t* i
         return false;
     }
 
-    table->get()->grow(delta + table->get()->size(), init ? const_cast<Object*>(init->get()) : reinterpret_cast<void*>(Value::NullBits));
-    return true;
+    return table->get()->grow(delta + table->get()->size(), init ? const_cast<Object*>(init->get()) : reinterpret_cast<void*>(Value::NullBits));
 }
 
 // Memory Instances
@@ -1109,6 +1136,24 @@ own wasm_memory_t* wasm_memory_new(wasm_store_t* store, const wasm_memorytype_t*
     return new wasm_memory_t(mem, mt->clone());
 }
 
+own wasm_memory_t* wasm_memory_new_from_file(wasm_store_t* store, const wasm_memorytype_t* mt, const char* path)
+{
+    uint64_t initialSizeInByte = (uint64_t)mt->limits.min * MEMORY_PAGE_SIZE;
+    uint64_t maximumSizeInByte = std::min<uint64_t>((uint64_t)mt->limits.max * MEMORY_PAGE_SIZE, std::numeric_limits<uint32_t>::max());
+    if (initialSizeInByte > maximumSizeInByte) {
+        return nullptr;
+    }
+
+    auto result = Memory::createMemoryFromFile(store->get(), path, initialSizeInByte, maximumSizeInByte);
+    if (!result.first) {
+        return nullptr;
+    }
+
+    Memory* mem = result.first.value();
+    wasm_limits_t limits = { mem->sizeInPageSize(), mt->limits.max };
+    return new wasm_memory_t(mem, new wasm_memorytype_t(limits));
+}
+
 own wasm_memorytype_t* wasm_memory_type(const wasm_memory_t* mem)
 {
     return mem->type()->clone();
@@ -1271,6 +1316,7 @@ uint32_t wasm_instance_func_index(const wasm_instance_t* ins, const wasm_func_t*
 //WASM_IMPL_OWN(config);
 WASM_IMPL_OWN(engine);
 WASM_IMPL_OWN(store);
+WASM_IMPL_OWN(module_streaming);
 
 #define WASM_IMPL_VEC_BASE(name, ptr_or_none)                               \
     void wasm_##name##_vec_new_empty(own wasm_##name##_vec_t* out)          \
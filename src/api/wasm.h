@@ -409,6 +409,17 @@ WASM_API_EXTERN void wasm_module_exports(const wasm_module_t*, own wasm_exportty
 WASM_API_EXTERN void wasm_module_serialize(const wasm_module_t*, own wasm_byte_vec_t* out);
 WASM_API_EXTERN own wasm_module_t* wasm_module_deserialize(wasm_store_t*, const wasm_byte_vec_t*);
 
+// Non-standard: compiles a module whose bytes arrive in chunks, e.g. while
+// the binary is downloaded or decompressed. Each function is compiled when
+// its body is complete. Append returns false once the binary is invalid.
+// Finish is called once after the last chunk, and returns NULL if the binary
+// is invalid. The streaming object is deleted by the host in both cases.
+WASM_DECLARE_OWN(module_streaming)
+
+WASM_API_EXTERN own wasm_module_streaming_t* wasm_module_streaming_new(wasm_store_t*);
+WASM_API_EXTERN bool wasm_module_streaming_append(wasm_module_streaming_t*, const wasm_byte_t* data, size_t size);
+WASM_API_EXTERN own wasm_module_t* wasm_module_streaming_finish(wasm_module_streaming_t*);
+
 
 // Function Instances
 
@@ -482,6 +493,12 @@ WASM_API_EXTERN size_t wasm_memory_data_size(const wasm_memory_t*);
 WASM_API_EXTERN wasm_memory_pages_t wasm_memory_size(const wasm_memory_t*);
 WASM_API_EXTERN bool wasm_memory_grow(wasm_memory_t*, wasm_memory_pages_t delta);
 
+// Non-standard: creates a memory whose content is a private mapping of the
+// file at path. The memory has at least limits.min pages and grows up to
+// limits.max pages. Returns NULL if the file cannot be mapped or does not
+// fit in the limits.
+WASM_API_EXTERN own wasm_memory_t* wasm_memory_new_from_file(wasm_store_t*, const wasm_memorytype_t*, const char* path);
+
 
 // Externals
 
@@ -17,6 +17,8 @@
 #ifndef __WalrusByteCode__
 #define __WalrusByteCode__
 
+#include "runtime/ObjectType.h"
+
 #if !defined(NDEBUG)
 #include <cinttypes>
 #include "runtime/Module.h"
@@ -29,6 +31,8 @@ namespace Walrus {
 
 typedef uint16_t ByteCodeStackOffset;
 class FunctionType;
+class Function;
+class Table;
 
 #define FOR_EACH_BYTECODE_OP(F) \
     F(Unreachable)              \
@@ -68,6 +72,11 @@ class FunctionType;
     F(Load64)                   \
     F(Store32)                  \
     F(Store64)                  \
+    F(Load32Unchecked)          \
+    F(Load64Unchecked)          \
+    F(Store32Unchecked)         \
+    F(Store64Unchecked)         \
+    F(LoopBoundsCheck)          \
     F(FillOpcodeTable)
 
 #define FOR_EACH_BYTECODE_BINARY_OP(F)            \
@@ -86,16 +95,6 @@ class FunctionType;
     F(I32ShrU, intShr, uint32_t, uint32_t)        \
     F(I32Rotl, intRotl, uint32_t, uint32_t)       \
     F(I32Rotr, intRotr, uint32_t, uint32_t)       \
-    F(I32Eq, eq, int32_t, int32_t)                \
-    F(I32Ne, ne, int32_t, int32_t)                \
-    F(I32LtS, lt, int32_t, int32_t)               \
-    F(I32LtU, lt, uint32_t, uint32_t)             \
-    F(I32LeS, le, int32_t, int32_t)               \
-    F(I32LeU, le, uint32_t, uint32_t)             \
-    F(I32GtS, gt, int32_t, int32_t)               \
-    F(I32GtU, gt, uint32_t, uint32_t)             \
-    F(I32GeS, ge, int32_t, int32_t)               \
-    F(I32GeU, ge, uint32_t, uint32_t)             \
     F(F32Add, add, float, float)                  \
     F(F32Sub, sub, float, float)                  \
     F(F32Mul, mul, float, float)                  \
@@ -103,12 +102,6 @@ class FunctionType;
     F(F32Max, floatMax, float, float)             \
     F(F32Min, floatMin, float, float)             \
     F(F32Copysign, floatCopysign, float, float)   \
-    F(F32Eq, eq, float, int32_t)                  \
-    F(F32Ne, ne, float, int32_t)                  \
-    F(F32Lt, lt, float, int32_t)                  \
-    F(F32Le, le, float, int32_t)                  \
-    F(F32Gt, gt, float, int32_t)                  \
-    F(F32Ge, ge, float, int32_t)                  \
     F(I64Add, add, int64_t, int64_t)              \
     F(I64Sub, sub, int64_t, int64_t)              \
     F(I64Mul, mul, int64_t, int64_t)              \
@@ -124,16 +117,6 @@ class FunctionType;
     F(I64ShrU, intShr, uint64_t, uint64_t)        \
     F(I64Rotl, intRotl, uint64_t, uint64_t)       \
     F(I64Rotr, intRotr, uint64_t, uint64_t)       \
-    F(I64Eq, eq, int64_t, int32_t)                \
-    F(I64Ne, ne, int64_t, int32_t)                \
-    F(I64LtS, lt, int64_t, int32_t)               \
-    F(I64LtU, lt, uint64_t, uint32_t)             \
-    F(I64LeS, le, int64_t, int32_t)               \
-    F(I64LeU, le, uint64_t, uint32_t)             \
-    F(I64GtS, gt, int64_t, int32_t)               \
-    F(I64GtU, gt, uint64_t, uint32_t)             \
-    F(I64GeS, ge, int64_t, int32_t)               \
-    F(I64GeU, ge, uint64_t, uint32_t)             \
     F(F64Add, add, double, double)                \
     F(F64Sub, sub, double, double)                \
     F(F64Mul, mul, double, double)                \
@@ -141,36 +124,174 @@ class FunctionType;
     F(F64Max, floatMax, double, double)           \
     F(F64Min, floatMin, double, double)           \
     F(F64Copysign, floatCopysign, double, double) \
-    F(F64Eq, eq, double, int32_t)                 \
-    F(F64Ne, ne, double, int32_t)                 \
-    F(F64Lt, lt, double, int32_t)                 \
-    F(F64Le, le, double, int32_t)                 \
-    F(F64Gt, gt, double, int32_t)                 \
+    FOR_EACH_BYTECODE_BINARY_COMPARE_OP(F)
+
+#define FOR_EACH_BYTECODE_BINARY_COMPARE_OP(F) \
+    F(I32Eq, eq, int32_t, int32_t)             \
+    F(I32Ne, ne, int32_t, int32_t)             \
+    F(I32LtS, lt, int32_t, int32_t)            \
+    F(I32LtU, lt, uint32_t, uint32_t)          \
+    F(I32LeS, le, int32_t, int32_t)            \
+    F(I32LeU, le, uint32_t, uint32_t)          \
+    F(I32GtS, gt, int32_t, int32_t)            \
+    F(I32GtU, gt, uint32_t, uint32_t)          \
+    F(I32GeS, ge, int32_t, int32_t)            \
+    F(I32GeU, ge, uint32_t, uint32_t)          \
+    F(F32Eq, eq, float, int32_t)               \
+    F(F32Ne, ne, float, int32_t)               \
+    F(F32Lt, lt, float, int32_t)               \
+    F(F32Le, le, float, int32_t)               \
+    F(F32Gt, gt, float, int32_t)               \
+    F(F32Ge, ge, float, int32_t)               \
+    F(I64Eq, eq, int64_t, int32_t)             \
+    F(I64Ne, ne, int64_t, int32_t)             \
+    F(I64LtS, lt, int64_t, int32_t)            \
+    F(I64LtU, lt, uint64_t, uint32_t)          \
+    F(I64LeS, le, int64_t, int32_t)            \
+    F(I64LeU, le, uint64_t, uint32_t)          \
+    F(I64GtS, gt, int64_t, int32_t)            \
+    F(I64GtU, gt, uint64_t, uint32_t)          \
+    F(I64GeS, ge, int64_t, int32_t)            \
+    F(I64GeU, ge, uint64_t, uint32_t)          \
+    F(F64Eq, eq, double, int32_t)              \
+    F(F64Ne, ne, double, int32_t)              \
+    F(F64Lt, lt, double, int32_t)              \
+    F(F64Le, le, double, int32_t)              \
+    F(F64Gt, gt, double, int32_t)              \
     F(F64Ge, ge, double, int32_t)
 
-#define FOR_EACH_BYTECODE_UNARY_OP(F)   \
-    F(I32Clz, clz, uint32_t)            \
-    F(I32Ctz, ctz, uint32_t)            \
-    F(I32Popcnt, popCount, uint32_t)    \
-    F(I32Eqz, intEqz, uint32_t)         \
-    F(F32Sqrt, floatSqrt, float)        \
-    F(F32Ceil, floatCeil, float)        \
-    F(F32Floor, floatFloor, float)      \
-    F(F32Trunc, floatTrunc, float)      \
-    F(F32Nearest, floatNearest, float)  \
-    F(F32Abs, floatAbs, float)          \
-    F(F32Neg, floatNeg, float)          \
-    F(I64Clz, clz, uint64_t)            \
-    F(I64Ctz, ctz, uint64_t)            \
-    F(I64Popcnt, popCount, uint64_t)    \
-    F(I64Eqz, intEqz, uint64_t)         \
-    F(F64Sqrt, floatSqrt, double)       \
-    F(F64Ceil, floatCeil, double)       \
-    F(F64Floor, floatFloor, double)     \
-    F(F64Trunc, floatTrunc, double)     \
-    F(F64Nearest, floatNearest, double) \
-    F(F64Abs, floatAbs, double)         \
-    F(F64Neg, floatNeg, double)
+#define FOR_EACH_BYTECODE_BINARY_IMM32_OP(F)            \
+    F(I32AddImm, I32Add, add, int32_t, int32_t)         \
+    F(I32SubImm, I32Sub, sub, int32_t, int32_t)         \
+    F(I32MulImm, I32Mul, mul, int32_t, int32_t)         \
+    F(I32DivSImm, I32DivS, intDiv, int32_t, int32_t)    \
+    F(I32DivUImm, I32DivU, intDiv, uint32_t, uint32_t)  \
+    F(I32RemSImm, I32RemS, intRem, int32_t, int32_t)    \
+    F(I32RemUImm, I32RemU, intRem, uint32_t, uint32_t)  \
+    F(I32AndImm, I32And, intAnd, int32_t, int32_t)      \
+    F(I32OrImm, I32Or, intOr, int32_t, int32_t)         \
+    F(I32XorImm, I32Xor, intXor, int32_t, int32_t)      \
+    F(I32ShlImm, I32Shl, intShl, int32_t, int32_t)      \
+    F(I32ShrSImm, I32ShrS, intShr, int32_t, int32_t)    \
+    F(I32ShrUImm, I32ShrU, intShr, uint32_t, uint32_t)  \
+    F(I32RotlImm, I32Rotl, intRotl, uint32_t, uint32_t) \
+    F(I32RotrImm, I32Rotr, intRotr, uint32_t, uint32_t)
+
+#define FOR_EACH_BYTECODE_BINARY_IMM64_OP(F)            \
+    F(I64AddImm, I64Add, add, int64_t, int64_t)         \
+    F(I64SubImm, I64Sub, sub, int64_t, int64_t)         \
+    F(I64MulImm, I64Mul, mul, int64_t, int64_t)         \
+    F(I64DivSImm, I64DivS, intDiv, int64_t, int64_t)    \
+    F(I64DivUImm, I64DivU, intDiv, uint64_t, uint64_t)  \
+    F(I64RemSImm, I64RemS, intRem, int64_t, int64_t)    \
+    F(I64RemUImm, I64RemU, intRem, uint64_t, uint64_t)  \
+    F(I64AndImm, I64And, intAnd, int64_t, int64_t)      \
+    F(I64OrImm, I64Or, intOr, int64_t, int64_t)         \
+    F(I64XorImm, I64Xor, intXor, int64_t, int64_t)      \
+    F(I64ShlImm, I64Shl, intShl, int64_t, int64_t)      \
+    F(I64ShrSImm, I64ShrS, intShr, int64_t, int64_t)    \
+    F(I64ShrUImm, I64ShrU, intShr, uint64_t, uint64_t)  \
+    F(I64RotlImm, I64Rotl, intRotl, uint64_t, uint64_t) \
+    F(I64RotrImm, I64Rotr, intRotr, uint64_t, uint64_t)
+
+#define FOR_EACH_BYTECODE_UNARY_OP(F)     \
+    F(I32Clz, clz, uint32_t)              \
+    F(I32Ctz, ctz, uint32_t)              \
+    F(I32Popcnt, popCount, uint32_t)      \
+    F(F32Sqrt, floatSqrt, float)          \
+    F(F32Ceil, floatCeil, float)          \
+    F(F32Floor, floatFloor, float)        \
+    F(F32Trunc, floatTrunc, float)        \
+    F(F32Nearest, floatNearest, float)    \
+    F(F32Abs, floatAbs, float)            \
+    F(F32Neg, floatNeg, float)            \
+    F(I64Clz, clz, uint64_t)              \
+    F(I64Ctz, ctz, uint64_t)              \
+    F(I64Popcnt, popCount, uint64_t)      \
+    F(F64Sqrt, floatSqrt, double)         \
+    F(F64Ceil, floatCeil, double)         \
+    F(F64Floor, floatFloor, double)       \
+    F(F64Trunc, floatTrunc, double)       \
+    F(F64Nearest, floatNearest, double)   \
+    F(F64Abs, floatAbs, double)           \
+    F(F64Neg, floatNeg, double)           \
+    FOR_EACH_BYTECODE_UNARY_COMPARE_OP(F)
+
+#define FOR_EACH_BYTECODE_UNARY_COMPARE_OP(F) \
+    F(I32Eqz, intEqz, uint32_t)               \
+    F(I64Eqz, intEqz, uint64_t)
+
+#define FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(F) \
+    F(I32EqJumpIfTrue, eq, int32_t, true)           \
+    F(I32EqJumpIfFalse, eq, int32_t, false)         \
+    F(I32NeJumpIfTrue, ne, int32_t, true)           \
+    F(I32NeJumpIfFalse, ne, int32_t, false)         \
+    F(I32LtSJumpIfTrue, lt, int32_t, true)          \
+    F(I32LtSJumpIfFalse, lt, int32_t, false)        \
+    F(I32LtUJumpIfTrue, lt, uint32_t, true)         \
+    F(I32LtUJumpIfFalse, lt, uint32_t, false)       \
+    F(I32LeSJumpIfTrue, le, int32_t, true)          \
+    F(I32LeSJumpIfFalse, le, int32_t, false)        \
+    F(I32LeUJumpIfTrue, le, uint32_t, true)         \
+    F(I32LeUJumpIfFalse, le, uint32_t, false)       \
+    F(I32GtSJumpIfTrue, gt, int32_t, true)          \
+    F(I32GtSJumpIfFalse, gt, int32_t, false)        \
+    F(I32GtUJumpIfTrue, gt, uint32_t, true)         \
+    F(I32GtUJumpIfFalse, gt, uint32_t, false)       \
+    F(I32GeSJumpIfTrue, ge, int32_t, true)          \
+    F(I32GeSJumpIfFalse, ge, int32_t, false)        \
+    F(I32GeUJumpIfTrue, ge, uint32_t, true)         \
+    F(I32GeUJumpIfFalse, ge, uint32_t, false)       \
+    F(F32EqJumpIfTrue, eq, float, true)             \
+    F(F32EqJumpIfFalse, eq, float, false)           \
+    F(F32NeJumpIfTrue, ne, float, true)             \
+    F(F32NeJumpIfFalse, ne, float, false)           \
+    F(F32LtJumpIfTrue, lt, float, true)             \
+    F(F32LtJumpIfFalse, lt, float, false)           \
+    F(F32LeJumpIfTrue, le, float, true)             \
+    F(F32LeJumpIfFalse, le, float, false)           \
+    F(F32GtJumpIfTrue, gt, float, true)             \
+    F(F32GtJumpIfFalse, gt, float, false)           \
+    F(F32GeJumpIfTrue, ge, float, true)             \
+    F(F32GeJumpIfFalse, ge, float, false)           \
+    F(I64EqJumpIfTrue, eq, int64_t, true)           \
+    F(I64EqJumpIfFalse, eq, int64_t, false)         \
+    F(I64NeJumpIfTrue, ne, int64_t, true)           \
+    F(I64NeJumpIfFalse, ne, int64_t, false)         \
+    F(I64LtSJumpIfTrue, lt, int64_t, true)          \
+    F(I64LtSJumpIfFalse, lt, int64_t, false)        \
+    F(I64LtUJumpIfTrue, lt, uint64_t, true)         \
+    F(I64LtUJumpIfFalse, lt, uint64_t, false)       \
+    F(I64LeSJumpIfTrue, le, int64_t, true)          \
+    F(I64LeSJumpIfFalse, le, int64_t, false)        \
+    F(I64LeUJumpIfTrue, le, uint64_t, true)         \
+    F(I64LeUJumpIfFalse, le, uint64_t, false)       \
+    F(I64GtSJumpIfTrue, gt, int64_t, true)          \
+    F(I64GtSJumpIfFalse, gt, int64_t, false)        \
+    F(I64GtUJumpIfTrue, gt, uint64_t, true)         \
+    F(I64GtUJumpIfFalse, gt, uint64_t, false)       \
+    F(I64GeSJumpIfTrue, ge, int64_t, true)          \
+    F(I64GeSJumpIfFalse, ge, int64_t, false)        \
+    F(I64GeUJumpIfTrue, ge, uint64_t, true)         \
+    F(I64GeUJumpIfFalse, ge, uint64_t, false)       \
+    F(F64EqJumpIfTrue, eq, double, true)            \
+    F(F64EqJumpIfFalse, eq, double, false)          \
+    F(F64NeJumpIfTrue, ne, double, true)            \
+    F(F64NeJumpIfFalse, ne, double, false)          \
+    F(F64LtJumpIfTrue, lt, double, true)            \
+    F(F64LtJumpIfFalse, lt, double, false)          \
+    F(F64LeJumpIfTrue, le, double, true)            \
+    F(F64LeJumpIfFalse, le, double, false)          \
+    F(F64GtJumpIfTrue, gt, double, true)            \
+    F(F64GtJumpIfFalse, gt, double, false)          \
+    F(F64GeJumpIfTrue, ge, double, true)            \
+    F(F64GeJumpIfFalse, ge, double, false)
+
+#define FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(F) \
+    F(I32EqzJumpIfTrue, intEqz, uint32_t, true)    \
+    F(I32EqzJumpIfFalse, intEqz, uint32_t, false)  \
+    F(I64EqzJumpIfTrue, intEqz, uint64_t, true)    \
+    F(I64EqzJumpIfFalse, intEqz, uint64_t, false)
 
 #define FOR_EACH_BYTECODE_UNARY_OP_2(F)                                 \
     F(I64Extend8S, intExtend, uint64_t, uint64_t, uint64_t, 7)          \
@@ -235,13 +356,100 @@ class FunctionType;
     F(F32Store, float, float)         \
     F(F64Store, double, double)
 
-#define FOR_EACH_BYTECODE(F)        \
-    FOR_EACH_BYTECODE_OP(F)         \
-    FOR_EACH_BYTECODE_BINARY_OP(F)  \
-    FOR_EACH_BYTECODE_UNARY_OP(F)   \
-    FOR_EACH_BYTECODE_UNARY_OP_2(F) \
-    FOR_EACH_BYTECODE_LOAD_OP(F)    \
-    FOR_EACH_BYTECODE_STORE_OP(F)
+// loads and stores without static offset, the full width
+// ones are covered by Load32/Load64 and Store32/Store64
+#define FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(F)           \
+    F(I32Load8SNoOffset, I32Load8S, int8_t, int32_t)     \
+    F(I32Load8UNoOffset, I32Load8U, uint8_t, int32_t)    \
+    F(I32Load16SNoOffset, I32Load16S, int16_t, int32_t)  \
+    F(I32Load16UNoOffset, I32Load16U, uint16_t, int32_t) \
+    F(I64Load8SNoOffset, I64Load8S, int8_t, int64_t)     \
+    F(I64Load8UNoOffset, I64Load8U, uint8_t, int64_t)    \
+    F(I64Load16SNoOffset, I64Load16S, int16_t, int64_t)  \
+    F(I64Load16UNoOffset, I64Load16U, uint16_t, int64_t) \
+    F(I64Load32SNoOffset, I64Load32S, int32_t, int64_t)  \
+    F(I64Load32UNoOffset, I64Load32U, uint32_t, int64_t)
+
+#define FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(F)         \
+    F(I32Store16NoOffset, I32Store16, int32_t, int16_t) \
+    F(I32Store8NoOffset, I32Store8, int32_t, int8_t)    \
+    F(I64Store32NoOffset, I64Store32, int64_t, int32_t) \
+    F(I64Store16NoOffset, I64Store16, int64_t, int16_t) \
+    F(I64Store8NoOffset, I64Store8, int64_t, int8_t)
+
+// loads and stores of an address computed by i32.add with a constant
+#define FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(F)           \
+    F(I32LoadAddImm, I32Load, int32_t, int32_t)        \
+    F(I32Load8SAddImm, I32Load8S, int8_t, int32_t)     \
+    F(I32Load8UAddImm, I32Load8U, uint8_t, int32_t)    \
+    F(I32Load16SAddImm, I32Load16S, int16_t, int32_t)  \
+    F(I32Load16UAddImm, I32Load16U, uint16_t, int32_t) \
+    F(I64LoadAddImm, I64Load, int64_t, int64_t)        \
+    F(I64Load8SAddImm, I64Load8S, int8_t, int64_t)     \
+    F(I64Load8UAddImm, I64Load8U, uint8_t, int64_t)    \
+    F(I64Load16SAddImm, I64Load16S, int16_t, int64_t)  \
+    F(I64Load16UAddImm, I64Load16U, uint16_t, int64_t) \
+    F(I64Load32SAddImm, I64Load32S, int32_t, int64_t)  \
+    F(I64Load32UAddImm, I64Load32U, uint32_t, int64_t) \
+    F(F32LoadAddImm, F32Load, float, float)            \
+    F(F64LoadAddImm, F64Load, double, double)
+
+#define FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(F)         \
+    F(I32StoreAddImm, I32Store, int32_t, int32_t)     \
+    F(I32Store16AddImm, I32Store16, int32_t, int16_t) \
+    F(I32Store8AddImm, I32Store8, int32_t, int8_t)    \
+    F(I64StoreAddImm, I64Store, int64_t, int64_t)     \
+    F(I64Store32AddImm, I64Store32, int64_t, int32_t) \
+    F(I64Store16AddImm, I64Store16, int64_t, int16_t) \
+    F(I64Store8AddImm, I64Store8, int64_t, int8_t)    \
+    F(F32StoreAddImm, F32Store, float, float)         \
+    F(F64StoreAddImm, F64Store, double, double)
+
+// loads and stores whose range is proven to be in bounds
+#define FOR_EACH_BYTECODE_LOAD_UNCHECKED_OP(F)            \
+    F(I32LoadUnchecked, I32Load, int32_t, int32_t)        \
+    F(I32Load8SUnchecked, I32Load8S, int8_t, int32_t)     \
+    F(I32Load8UUnchecked, I32Load8U, uint8_t, int32_t)    \
+    F(I32Load16SUnchecked, I32Load16S, int16_t, int32_t)  \
+    F(I32Load16UUnchecked, I32Load16U, uint16_t, int32_t) \
+    F(I64LoadUnchecked, I64Load, int64_t, int64_t)        \
+    F(I64Load8SUnchecked, I64Load8S, int8_t, int64_t)     \
+    F(I64Load8UUnchecked, I64Load8U, uint8_t, int64_t)    \
+    F(I64Load16SUnchecked, I64Load16S, int16_t, int64_t)  \
+    F(I64Load16UUnchecked, I64Load16U, uint16_t, int64_t) \
+    F(I64Load32SUnchecked, I64Load32S, int32_t, int64_t)  \
+    F(I64Load32UUnchecked, I64Load32U, uint32_t, int64_t) \
+    F(F32LoadUnchecked, F32Load, float, float)            \
+    F(F64LoadUnchecked, F64Load, double, double)
+
+#define FOR_EACH_BYTECODE_STORE_UNCHECKED_OP(F)          \
+    F(I32StoreUnchecked, I32Store, int32_t, int32_t)     \
+    F(I32Store16Unchecked, I32Store16, int32_t, int16_t) \
+    F(I32Store8Unchecked, I32Store8, int32_t, int8_t)    \
+    F(I64StoreUnchecked, I64Store, int64_t, int64_t)     \
+    F(I64Store32Unchecked, I64Store32, int64_t, int32_t) \
+    F(I64Store16Unchecked, I64Store16, int64_t, int16_t) \
+    F(I64Store8Unchecked, I64Store8, int64_t, int8_t)    \
+    F(F32StoreUnchecked, F32Store, float, float)         \
+    F(F64StoreUnchecked, F64Store, double, double)
+
+#define FOR_EACH_BYTECODE(F)                    \
+    FOR_EACH_BYTECODE_OP(F)                     \
+    FOR_EACH_BYTECODE_BINARY_OP(F)              \
+    FOR_EACH_BYTECODE_BINARY_IMM32_OP(F)        \
+    FOR_EACH_BYTECODE_BINARY_IMM64_OP(F)        \
+    FOR_EACH_BYTECODE_UNARY_OP(F)               \
+    FOR_EACH_BYTECODE_UNARY_OP_2(F)             \
+    FOR_EACH_BYTECODE_LOAD_OP(F)                \
+    FOR_EACH_BYTECODE_STORE_OP(F)               \
+    FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(F)      \
+    FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(F)     \
+    FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(F)        \
+    FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(F)       \
+    FOR_EACH_BYTECODE_LOAD_UNCHECKED_OP(F)      \
+    FOR_EACH_BYTECODE_STORE_UNCHECKED_OP(F)     \
+    FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(F) \
+    FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(F)
 
 class ByteCode {
 public:
@@ -354,6 +562,7 @@ public:
     }
 
     const ByteCodeStackOffset* srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffset[idx] = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
     void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 #if !defined(NDEBUG)
@@ -397,7 +606,9 @@ public:
     {
     }
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 #if !defined(NDEBUG)
     void dump(size_t pos)
     {
@@ -437,6 +648,74 @@ FOR_EACH_BYTECODE_UNARY_OP_2(DEFINE_UNARY_BYTECODE)
 #undef DEFINE_UNARY_BYTECODE_DUMP
 #undef DEFINE_UNARY_BYTECODE
 
+// dummy ByteCode for binary operation which has an immediate rhs operand
+template <typename T>
+class BinaryImmOperation : public ByteCode {
+public:
+    BinaryImmOperation(Opcode code, ByteCodeStackOffset srcOffset, T value, ByteCodeStackOffset dstOffset)
+        : ByteCode(code)
+        , m_srcOffset(srcOffset)
+        , m_dstOffset(dstOffset)
+        , m_value(value)
+    {
+    }
+
+    ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
+    ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
+    T value() const { return m_value; }
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+    }
+#endif
+
+protected:
+    ByteCodeStackOffset m_srcOffset;
+    ByteCodeStackOffset m_dstOffset;
+    T m_value;
+};
+
+typedef BinaryImmOperation<uint32_t> BinaryImm32Operation;
+typedef BinaryImmOperation<uint64_t> BinaryImm64Operation;
+
+#if !defined(NDEBUG)
+#define DEFINE_BINARY_IMM_BYTECODE_DUMP(name)                                                                                                \
+    void dump(size_t pos)                                                                                                                    \
+    {                                                                                                                                        \
+        printf(#name " src: %" PRIu32 " value: %" PRIu64 " dst: %" PRIu32, (uint32_t)m_srcOffset, (uint64_t)m_value, (uint32_t)m_dstOffset); \
+    }
+#else
+#define DEFINE_BINARY_IMM_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_BINARY_IMM32_BYTECODE(name, ...)                                            \
+    class name : public BinaryImm32Operation {                                             \
+    public:                                                                                \
+        name(ByteCodeStackOffset srcOffset, uint32_t value, ByteCodeStackOffset dstOffset) \
+            : BinaryImm32Operation(Opcode::name##Opcode, srcOffset, value, dstOffset)      \
+        {                                                                                  \
+        }                                                                                  \
+        DEFINE_BINARY_IMM_BYTECODE_DUMP(name)                                              \
+    };
+
+#define DEFINE_BINARY_IMM64_BYTECODE(name, ...)                                            \
+    class name : public BinaryImm64Operation {                                             \
+    public:                                                                                \
+        name(ByteCodeStackOffset srcOffset, uint64_t value, ByteCodeStackOffset dstOffset) \
+            : BinaryImm64Operation(Opcode::name##Opcode, srcOffset, value, dstOffset)      \
+        {                                                                                  \
+        }                                                                                  \
+        DEFINE_BINARY_IMM_BYTECODE_DUMP(name)                                              \
+    };
+
+FOR_EACH_BYTECODE_BINARY_IMM32_OP(DEFINE_BINARY_IMM32_BYTECODE)
+FOR_EACH_BYTECODE_BINARY_IMM64_OP(DEFINE_BINARY_IMM64_BYTECODE)
+#undef DEFINE_BINARY_IMM_BYTECODE_DUMP
+#undef DEFINE_BINARY_IMM32_BYTECODE
+#undef DEFINE_BINARY_IMM64_BYTECODE
+
 class Call : public ByteCode {
 public:
     Call(uint32_t index, uint32_t offsetsSize
@@ -500,18 +779,79 @@ public:
         : ByteCode(Opcode::CallIndirectOpcode)
         , m_calleeOffset(stackOffset)
         , m_tableIndex(tableIndex)
+        , m_signatureId(functionType->signatureId())
         , m_functionType(functionType)
+        , m_cacheNext(0)
+#if defined(WALRUS_BYTECODE_STATS)
+        , m_cacheHitCount(0)
+        , m_cacheMissCount(0)
+#endif
     {
+        for (size_t i = 0; i < CacheSize; i++) {
+            m_cache[i].m_sequence.store(0, std::memory_order_relaxed);
+            m_cache[i].m_table.store(nullptr, std::memory_order_relaxed);
+            m_cache[i].m_tableVersion.store(0, std::memory_order_relaxed);
+            m_cache[i].m_index.store(0, std::memory_order_relaxed);
+            m_cache[i].m_target.store(nullptr, std::memory_order_relaxed);
+        }
     }
 
     ByteCodeStackOffset calleeOffset() const { return m_calleeOffset; }
+    void setCalleeOffset(ByteCodeStackOffset o) { m_calleeOffset = o; }
     uint32_t tableIndex() const { return m_tableIndex; }
+    uint32_t signatureId() const { return m_signatureId; }
     FunctionType* functionType() const { return m_functionType; }
     ByteCodeStackOffset* stackOffsets() const
     {
         return reinterpret_cast<ByteCodeStackOffset*>(reinterpret_cast<size_t>(this) + sizeof(CallIndirect));
     }
 
+    // returns the target resolved for the element of the table or nullptr
+    Function* lookupCache(const Table* table, size_t tableVersion, uint32_t index) const
+    {
+        for (size_t i = 0; i < CacheSize; i++) {
+            const CacheEntry& entry = m_cache[i];
+            uint32_t sequence = entry.m_sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+            if (entry.m_table.load(std::memory_order_relaxed) != table || entry.m_index.load(std::memory_order_relaxed) != index
+                || entry.m_tableVersion.load(std::memory_order_relaxed) != tableVersion) {
+                continue;
+            }
+            Function* target = entry.m_target.load(std::memory_order_relaxed);
+            // the fields were read from a single update of the entry
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.m_sequence.load(std::memory_order_relaxed) == sequence) {
+                return target;
+            }
+        }
+        return nullptr;
+    }
+
+    // the cache is best effort, an entry written by another thread is not updated
+    void updateCache(const Table* table, size_t tableVersion, uint32_t index, Function* target)
+    {
+        CacheEntry& entry = m_cache[m_cacheNext.fetch_add(1, std::memory_order_relaxed) % CacheSize];
+        uint32_t sequence = entry.m_sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || !entry.m_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.m_table.store(table, std::memory_order_relaxed);
+        entry.m_tableVersion.store(tableVersion, std::memory_order_relaxed);
+        entry.m_index.store(index, std::memory_order_relaxed);
+        entry.m_target.store(target, std::memory_order_relaxed);
+        entry.m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+#if defined(WALRUS_BYTECODE_STATS)
+    uint64_t cacheHitCount() const { return m_cacheHitCount.load(std::memory_order_relaxed); }
+    uint64_t cacheMissCount() const { return m_cacheMissCount.load(std::memory_order_relaxed); }
+    void countCacheHit() { m_cacheHitCount.fetch_add(1, std::memory_order_relaxed); }
+    void countCacheMiss() { m_cacheMissCount.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
 #if !defined(NDEBUG)
     void dump(size_t pos)
     {
@@ -538,7 +878,27 @@ public:
 protected:
     ByteCodeStackOffset m_calleeOffset;
     uint32_t m_tableIndex;
+    uint32_t m_signatureId;
     FunctionType* m_functionType;
+
+    // The bytecode is shared by the instances of the module, so the table
+    // is part of the key. Any change of the table bumps its version.
+    // Threads running the same bytecode update the entries concurrently,
+    // so each entry is a seqlock: its sequence is odd while it is written.
+    struct CacheEntry {
+        std::atomic<uint32_t> m_sequence;
+        std::atomic<const Table*> m_table;
+        std::atomic<size_t> m_tableVersion;
+        std::atomic<uint32_t> m_index;
+        std::atomic<Function*> m_target;
+    };
+    static const size_t CacheSize = 4;
+    CacheEntry m_cache[CacheSize];
+    std::atomic<uint32_t> m_cacheNext;
+#if defined(WALRUS_BYTECODE_STATS)
+    std::atomic<uint64_t> m_cacheHitCount;
+    std::atomic<uint64_t> m_cacheMissCount;
+#endif
 };
 
 class Move32 : public ByteCode {
@@ -551,7 +911,9 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -577,7 +939,9 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -603,7 +967,9 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -615,10 +981,34 @@ public:
 #endif
 
 protected:
+    Load32(Opcode opcode, ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
+        : ByteCode(opcode)
+        , m_srcOffset(srcOffset)
+        , m_dstOffset(dstOffset)
+    {
+    }
+
     ByteCodeStackOffset m_srcOffset;
     ByteCodeStackOffset m_dstOffset;
 };
 
+class Load32Unchecked : public Load32 {
+public:
+    Load32Unchecked(ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
+        : Load32(Load32UncheckedOpcode, srcOffset, dstOffset)
+    {
+    }
+
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+        printf("load32 unchecked ");
+        DUMP_BYTECODE_OFFSET(srcOffset);
+        DUMP_BYTECODE_OFFSET(dstOffset);
+    }
+#endif
+};
+
 class Load64 : public ByteCode {
 public:
     Load64(ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
@@ -629,7 +1019,9 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -641,10 +1033,34 @@ public:
 #endif
 
 protected:
+    Load64(Opcode opcode, ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
+        : ByteCode(opcode)
+        , m_srcOffset(srcOffset)
+        , m_dstOffset(dstOffset)
+    {
+    }
+
     ByteCodeStackOffset m_srcOffset;
     ByteCodeStackOffset m_dstOffset;
 };
 
+class Load64Unchecked : public Load64 {
+public:
+    Load64Unchecked(ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
+        : Load64(Load64UncheckedOpcode, srcOffset, dstOffset)
+    {
+    }
+
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+        printf("load64 unchecked ");
+        DUMP_BYTECODE_OFFSET(srcOffset);
+        DUMP_BYTECODE_OFFSET(dstOffset);
+    }
+#endif
+};
+
 class Store32 : public ByteCode {
 public:
     Store32(ByteCodeStackOffset src0, ByteCodeStackOffset src1)
@@ -655,7 +1071,9 @@ public:
     }
 
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -667,10 +1085,34 @@ public:
 #endif
 
 protected:
+    Store32(Opcode opcode, ByteCodeStackOffset src0, ByteCodeStackOffset src1)
+        : ByteCode(opcode)
+        , m_src0Offset(src0)
+        , m_src1Offset(src1)
+    {
+    }
+
     ByteCodeStackOffset m_src0Offset;
     ByteCodeStackOffset m_src1Offset;
 };
 
+class Store32Unchecked : public Store32 {
+public:
+    Store32Unchecked(ByteCodeStackOffset src0, ByteCodeStackOffset src1)
+        : Store32(Store32UncheckedOpcode, src0, src1)
+    {
+    }
+
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+        printf("store32 unchecked ");
+        DUMP_BYTECODE_OFFSET(src0Offset);
+        DUMP_BYTECODE_OFFSET(src1Offset);
+    }
+#endif
+};
+
 class Store64 : public ByteCode {
 public:
     Store64(ByteCodeStackOffset src0, ByteCodeStackOffset src1)
@@ -681,7 +1123,9 @@ public:
     }
 
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -693,10 +1137,119 @@ public:
 #endif
 
 protected:
+    Store64(Opcode opcode, ByteCodeStackOffset src0, ByteCodeStackOffset src1)
+        : ByteCode(opcode)
+        , m_src0Offset(src0)
+        , m_src1Offset(src1)
+    {
+    }
+
     ByteCodeStackOffset m_src0Offset;
     ByteCodeStackOffset m_src1Offset;
 };
 
+class Store64Unchecked : public Store64 {
+public:
+    Store64Unchecked(ByteCodeStackOffset src0, ByteCodeStackOffset src1)
+        : Store64(Store64UncheckedOpcode, src0, src1)
+    {
+    }
+
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+        printf("store64 unchecked ");
+        DUMP_BYTECODE_OFFSET(src0Offset);
+        DUMP_BYTECODE_OFFSET(src1Offset);
+    }
+#endif
+};
+
+// Range check in front of a loop whose accesses through the induction
+// variable are unchecked. Jumps to the checked copy of the loop unless
+// every value the base takes in the loop keeps the accesses in bounds.
+class LoopBoundsCheck : public ByteCode {
+public:
+    enum Kind : uint8_t {
+        // the loop ends with a jump back while base < bound
+        LessThan,
+        // the loop ends with a jump back while base <= bound
+        LessOrEqual,
+        // the loop ends with a jump back while base != bound
+        NotEqual,
+        // the loop starts with a jump out unless base < bound
+        Below,
+    };
+
+    LoopBoundsCheck(Kind kind, ByteCodeStackOffset baseOffset, ByteCodeStackOffset boundOffset, uint32_t stride, uint32_t accessEnd, int32_t offset = 0)
+        : ByteCode(Opcode::LoopBoundsCheckOpcode)
+        , m_baseOffset(baseOffset)
+        , m_boundOffset(boundOffset)
+        , m_kind(kind)
+        , m_stride(stride)
+        , m_accessEnd(accessEnd)
+        , m_offset(offset)
+    {
+    }
+
+    Kind kind() const { return m_kind; }
+    ByteCodeStackOffset baseOffset() const { return m_baseOffset; }
+    void setBaseOffset(ByteCodeStackOffset o) { m_baseOffset = o; }
+    ByteCodeStackOffset boundOffset() const { return m_boundOffset; }
+    void setBoundOffset(ByteCodeStackOffset o) { m_boundOffset = o; }
+    int32_t offset() const { return m_offset; }
+    void setOffset(int32_t offset)
+    {
+        m_offset = offset;
+    }
+
+    bool isInBounds(uint32_t base, uint32_t bound, uint32_t memorySize) const
+    {
+        uint32_t limit;
+        switch (m_kind) {
+        case LessThan:
+            limit = (bound != 0 && bound - 1 > base) ? bound - 1 : base;
+            break;
+        case LessOrEqual:
+            limit = bound > base ? bound : base;
+            break;
+        case NotEqual:
+            // the base must reach the bound without wrapping around
+            if (base >= bound || (bound - base) % m_stride) {
+                return false;
+            }
+            limit = bound - m_stride;
+            break;
+        default:
+            ASSERT(m_kind == Below);
+            if (bound == 0) {
+                return true;
+            }
+            limit = bound - 1;
+            break;
+        }
+        return static_cast<uint64_t>(limit) + m_accessEnd <= memorySize;
+    }
+
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+        printf("loop bounds check ");
+        DUMP_BYTECODE_OFFSET(baseOffset);
+        DUMP_BYTECODE_OFFSET(boundOffset);
+        printf("kind: %" PRIu32 " stride: %" PRIu32 " end: %" PRIu32 " dst: %" PRId32, (uint32_t)m_kind, m_stride, m_accessEnd, (int32_t)pos + m_offset);
+    }
+#endif
+
+protected:
+    ByteCodeStackOffset m_baseOffset;
+    ByteCodeStackOffset m_boundOffset;
+    Kind m_kind;
+    uint32_t m_stride;
+    uint32_t m_accessEnd;
+    int32_t m_offset;
+};
+
 class Jump : public ByteCode {
 public:
     Jump(int32_t offset = 0)
@@ -732,6 +1285,7 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     int32_t offset() const { return m_offset; }
     void setOffset(int32_t offset)
     {
@@ -762,6 +1316,7 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     int32_t offset() const { return m_offset; }
     void setOffset(int32_t offset)
     {
@@ -782,6 +1337,109 @@ protected:
     int32_t m_offset;
 };
 
+// dummy ByteCode for binary comparison fused with conditional jump
+class BinaryCompareJump : public ByteCode {
+public:
+    BinaryCompareJump(Opcode code, ByteCodeStackOffset src0Offset, ByteCodeStackOffset src1Offset, int32_t offset)
+        : ByteCode(code)
+        , m_srcOffset{ src0Offset, src1Offset }
+        , m_offset(offset)
+    {
+    }
+
+    const ByteCodeStackOffset* srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffset[idx] = o; }
+    int32_t offset() const { return m_offset; }
+    void setOffset(int32_t offset)
+    {
+        m_offset = offset;
+    }
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+    }
+#endif
+
+protected:
+    ByteCodeStackOffset m_srcOffset[2];
+    int32_t m_offset;
+};
+
+#if !defined(NDEBUG)
+#define DEFINE_BINARY_COMPARE_JUMP_BYTECODE_DUMP(name)                                                                                                   \
+    void dump(size_t pos)                                                                                                                                \
+    {                                                                                                                                                    \
+        printf(#name " src1: %" PRIu32 " src2: %" PRIu32 " dst: %" PRId32, (uint32_t)m_srcOffset[0], (uint32_t)m_srcOffset[1], (int32_t)pos + m_offset); \
+    }
+#else
+#define DEFINE_BINARY_COMPARE_JUMP_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_BINARY_COMPARE_JUMP_BYTECODE(name, ...)                                           \
+    class name : public BinaryCompareJump {                                                      \
+    public:                                                                                      \
+        name(ByteCodeStackOffset src0Offset, ByteCodeStackOffset src1Offset, int32_t offset = 0) \
+            : BinaryCompareJump(Opcode::name##Opcode, src0Offset, src1Offset, offset)            \
+        {                                                                                        \
+        }                                                                                        \
+        DEFINE_BINARY_COMPARE_JUMP_BYTECODE_DUMP(name)                                           \
+    };
+
+// dummy ByteCode for unary comparison fused with conditional jump
+class UnaryCompareJump : public ByteCode {
+public:
+    UnaryCompareJump(Opcode code, ByteCodeStackOffset srcOffset, int32_t offset)
+        : ByteCode(code)
+        , m_srcOffset(srcOffset)
+        , m_offset(offset)
+    {
+    }
+
+    ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
+    int32_t offset() const { return m_offset; }
+    void setOffset(int32_t offset)
+    {
+        m_offset = offset;
+    }
+#if !defined(NDEBUG)
+    void dump(size_t pos)
+    {
+    }
+#endif
+
+protected:
+    ByteCodeStackOffset m_srcOffset;
+    int32_t m_offset;
+};
+
+#if !defined(NDEBUG)
+#define DEFINE_UNARY_COMPARE_JUMP_BYTECODE_DUMP(name)                                                    \
+    void dump(size_t pos)                                                                                \
+    {                                                                                                    \
+        printf(#name " src: %" PRIu32 " dst: %" PRId32, (uint32_t)m_srcOffset, (int32_t)pos + m_offset); \
+    }
+#else
+#define DEFINE_UNARY_COMPARE_JUMP_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_UNARY_COMPARE_JUMP_BYTECODE(name, ...)                   \
+    class name : public UnaryCompareJump {                              \
+    public:                                                             \
+        name(ByteCodeStackOffset srcOffset, int32_t offset = 0)         \
+            : UnaryCompareJump(Opcode::name##Opcode, srcOffset, offset) \
+        {                                                               \
+        }                                                               \
+        DEFINE_UNARY_COMPARE_JUMP_BYTECODE_DUMP(name)                   \
+    };
+
+FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(DEFINE_BINARY_COMPARE_JUMP_BYTECODE)
+FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(DEFINE_UNARY_COMPARE_JUMP_BYTECODE)
+#undef DEFINE_BINARY_COMPARE_JUMP_BYTECODE_DUMP
+#undef DEFINE_BINARY_COMPARE_JUMP_BYTECODE
+#undef DEFINE_UNARY_COMPARE_JUMP_BYTECODE_DUMP
+#undef DEFINE_UNARY_COMPARE_JUMP_BYTECODE
+
 class Select : public ByteCode {
 public:
     Select(ByteCodeStackOffset condOffset, uint16_t size, ByteCodeStackOffset src0, ByteCodeStackOffset src1, ByteCodeStackOffset dst)
@@ -795,13 +1453,17 @@ public:
     }
 
     ByteCodeStackOffset condOffset() const { return m_condOffset; }
+    void setCondOffset(ByteCodeStackOffset o) { m_condOffset = o; }
     uint16_t valueSize() const
     {
         return m_valueSize;
     }
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -833,7 +1495,9 @@ public:
     }
 
     ByteCodeStackOffset condOffset() const { return m_condOffset; }
+    void setCondOffset(ByteCodeStackOffset o) { m_condOffset = o; }
     int32_t defaultOffset() const { return m_defaultOffset; }
+    void setDefaultOffset(int32_t offset) { m_defaultOffset = offset; }
     static inline size_t offsetOfDefault() { return offsetof(BrTable, m_defaultOffset); }
 
     uint32_t tableSize() const { return m_tableSize; }
@@ -871,6 +1535,7 @@ public:
     }
 
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -903,6 +1568,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -934,6 +1600,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -961,6 +1628,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1011,7 +1679,9 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1040,7 +1710,9 @@ public:
 
     uint32_t offset() const { return m_offset; }
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1086,7 +1758,9 @@ public:
 
     uint32_t offset() const { return m_offset; }
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1126,6 +1800,167 @@ FOR_EACH_BYTECODE_STORE_OP(DEFINE_STORE_BYTECODE)
 #undef DEFINE_STORE_BYTECODE_DUMP
 #undef DEFINE_STORE_BYTECODE
 
+#if !defined(NDEBUG)
+#define DEFINE_LOAD_NO_OFFSET_BYTECODE_DUMP(name)                                                      \
+    void dump(size_t pos)                                                                              \
+    {                                                                                                  \
+        printf(#name " src: %" PRIu32 " dst: %" PRIu32, (uint32_t)m_srcOffset, (uint32_t)m_dstOffset); \
+    }
+#define DEFINE_STORE_NO_OFFSET_BYTECODE_DUMP(name)                                                         \
+    void dump(size_t pos)                                                                                  \
+    {                                                                                                      \
+        printf(#name " src0: %" PRIu32 " src1: %" PRIu32, (uint32_t)m_src0Offset, (uint32_t)m_src1Offset); \
+    }
+#else
+#define DEFINE_LOAD_NO_OFFSET_BYTECODE_DUMP(name)
+#define DEFINE_STORE_NO_OFFSET_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_LOAD_NO_OFFSET_BYTECODE(name, baseName, readType, writeType) \
+    class name : public MemoryLoad {                                        \
+    public:                                                                 \
+        name(ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)  \
+            : MemoryLoad(Opcode::name##Opcode, 0, srcOffset, dstOffset)     \
+        {                                                                   \
+        }                                                                   \
+        DEFINE_LOAD_NO_OFFSET_BYTECODE_DUMP(name)                           \
+    };
+
+#define DEFINE_STORE_NO_OFFSET_BYTECODE(name, baseName, readType, writeType) \
+    class name : public MemoryStore {                                        \
+    public:                                                                  \
+        name(ByteCodeStackOffset src0, ByteCodeStackOffset src1)             \
+            : MemoryStore(Opcode::name##Opcode, 0, src0, src1)               \
+        {                                                                    \
+        }                                                                    \
+        DEFINE_STORE_NO_OFFSET_BYTECODE_DUMP(name)                           \
+    };
+
+FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(DEFINE_LOAD_NO_OFFSET_BYTECODE)
+FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(DEFINE_STORE_NO_OFFSET_BYTECODE)
+#undef DEFINE_LOAD_NO_OFFSET_BYTECODE_DUMP
+#undef DEFINE_LOAD_NO_OFFSET_BYTECODE
+#undef DEFINE_STORE_NO_OFFSET_BYTECODE_DUMP
+#undef DEFINE_STORE_NO_OFFSET_BYTECODE
+
+// dummy ByteCode for memory load of (src + value), the addition wraps around before the offset is applied
+class MemoryLoadAddImm : public MemoryLoad {
+public:
+    MemoryLoadAddImm(Opcode code, uint32_t offset, ByteCodeStackOffset srcOffset, uint32_t value, ByteCodeStackOffset dstOffset)
+        : MemoryLoad(code, offset, srcOffset, dstOffset)
+        , m_value(value)
+    {
+    }
+
+    uint32_t value() const { return m_value; }
+
+protected:
+    uint32_t m_value;
+};
+
+// dummy ByteCode for memory store to (src0 + value), the addition wraps around before the offset is applied
+class MemoryStoreAddImm : public MemoryStore {
+public:
+    MemoryStoreAddImm(Opcode code, uint32_t offset, ByteCodeStackOffset src0, uint32_t value, ByteCodeStackOffset src1)
+        : MemoryStore(code, offset, src0, src1)
+        , m_value(value)
+    {
+    }
+
+    uint32_t value() const { return m_value; }
+
+protected:
+    uint32_t m_value;
+};
+
+#if !defined(NDEBUG)
+#define DEFINE_LOAD_ADD_IMM_BYTECODE_DUMP(name)                                                                                \
+    void dump(size_t pos)                                                                                                      \
+    {                                                                                                                          \
+        printf(#name " src: %" PRIu32 " value: %" PRIu32 " dst: %" PRIu32 " offset: %" PRIu32, (uint32_t)m_srcOffset, m_value, \
+               (uint32_t)m_dstOffset, (uint32_t)m_offset);                                                                     \
+    }
+#define DEFINE_STORE_ADD_IMM_BYTECODE_DUMP(name)                                                                                  \
+    void dump(size_t pos)                                                                                                         \
+    {                                                                                                                             \
+        printf(#name " src0: %" PRIu32 " value: %" PRIu32 " src1: %" PRIu32 " offset: %" PRIu32, (uint32_t)m_src0Offset, m_value, \
+               (uint32_t)m_src1Offset, (uint32_t)m_offset);                                                                       \
+    }
+#else
+#define DEFINE_LOAD_ADD_IMM_BYTECODE_DUMP(name)
+#define DEFINE_STORE_ADD_IMM_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_LOAD_ADD_IMM_BYTECODE(name, baseName, readType, writeType)                                   \
+    class name : public MemoryLoadAddImm {                                                                  \
+    public:                                                                                                 \
+        name(uint32_t offset, ByteCodeStackOffset srcOffset, uint32_t value, ByteCodeStackOffset dstOffset) \
+            : MemoryLoadAddImm(Opcode::name##Opcode, offset, srcOffset, value, dstOffset)                   \
+        {                                                                                                   \
+        }                                                                                                   \
+        DEFINE_LOAD_ADD_IMM_BYTECODE_DUMP(name)                                                             \
+    };
+
+#define DEFINE_STORE_ADD_IMM_BYTECODE(name, baseName, readType, writeType)                        \
+    class name : public MemoryStoreAddImm {                                                       \
+    public:                                                                                       \
+        name(uint32_t offset, ByteCodeStackOffset src0, uint32_t value, ByteCodeStackOffset src1) \
+            : MemoryStoreAddImm(Opcode::name##Opcode, offset, src0, value, src1)                  \
+        {                                                                                         \
+        }                                                                                         \
+        DEFINE_STORE_ADD_IMM_BYTECODE_DUMP(name)                                                  \
+    };
+
+FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(DEFINE_LOAD_ADD_IMM_BYTECODE)
+FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(DEFINE_STORE_ADD_IMM_BYTECODE)
+#undef DEFINE_LOAD_ADD_IMM_BYTECODE_DUMP
+#undef DEFINE_LOAD_ADD_IMM_BYTECODE
+#undef DEFINE_STORE_ADD_IMM_BYTECODE_DUMP
+#undef DEFINE_STORE_ADD_IMM_BYTECODE
+
+#if !defined(NDEBUG)
+#define DEFINE_LOAD_UNCHECKED_BYTECODE_DUMP(name)                                                                                              \
+    void dump(size_t pos)                                                                                                                      \
+    {                                                                                                                                          \
+        printf(#name " src: %" PRIu32 " dst: %" PRIu32 " offset: %" PRIu32, (uint32_t)m_srcOffset, (uint32_t)m_dstOffset, (uint32_t)m_offset); \
+    }
+#define DEFINE_STORE_UNCHECKED_BYTECODE_DUMP(name)                                                                                                 \
+    void dump(size_t pos)                                                                                                                          \
+    {                                                                                                                                              \
+        printf(#name " src0: %" PRIu32 " src1: %" PRIu32 " offset: %" PRIu32, (uint32_t)m_src0Offset, (uint32_t)m_src1Offset, (uint32_t)m_offset); \
+    }
+#else
+#define DEFINE_LOAD_UNCHECKED_BYTECODE_DUMP(name)
+#define DEFINE_STORE_UNCHECKED_BYTECODE_DUMP(name)
+#endif
+
+#define DEFINE_LOAD_UNCHECKED_BYTECODE(name, baseName, readType, writeType)                 \
+    class name : public MemoryLoad {                                                        \
+    public:                                                                                 \
+        name(uint32_t offset, ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset) \
+            : MemoryLoad(Opcode::name##Opcode, offset, srcOffset, dstOffset)                \
+        {                                                                                   \
+        }                                                                                   \
+        DEFINE_LOAD_UNCHECKED_BYTECODE_DUMP(name)                                           \
+    };
+
+#define DEFINE_STORE_UNCHECKED_BYTECODE(name, baseName, readType, writeType)      \
+    class name : public MemoryStore {                                             \
+    public:                                                                       \
+        name(uint32_t offset, ByteCodeStackOffset src0, ByteCodeStackOffset src1) \
+            : MemoryStore(Opcode::name##Opcode, offset, src0, src1)               \
+        {                                                                         \
+        }                                                                         \
+        DEFINE_STORE_UNCHECKED_BYTECODE_DUMP(name)                                \
+    };
+
+FOR_EACH_BYTECODE_LOAD_UNCHECKED_OP(DEFINE_LOAD_UNCHECKED_BYTECODE)
+FOR_EACH_BYTECODE_STORE_UNCHECKED_OP(DEFINE_STORE_UNCHECKED_BYTECODE)
+#undef DEFINE_LOAD_UNCHECKED_BYTECODE_DUMP
+#undef DEFINE_LOAD_UNCHECKED_BYTECODE
+#undef DEFINE_STORE_UNCHECKED_BYTECODE_DUMP
+#undef DEFINE_STORE_UNCHECKED_BYTECODE
+
 class TableGet : public ByteCode {
 public:
     TableGet(uint32_t index, ByteCodeStackOffset srcOffset, ByteCodeStackOffset dstOffset)
@@ -1138,7 +1973,9 @@ public:
 
     uint32_t tableIndex() const { return m_tableIndex; }
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1167,7 +2004,9 @@ public:
     }
 
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
     uint32_t tableIndex() const { return m_tableIndex; }
 
 #if !defined(NDEBUG)
@@ -1199,8 +2038,11 @@ public:
 
     uint32_t tableIndex() const { return m_tableIndex; }
     ByteCodeStackOffset src0Offset() const { return m_src0Offset; }
+    void setSrc0Offset(ByteCodeStackOffset o) { m_src0Offset = o; }
     ByteCodeStackOffset src1Offset() const { return m_src1Offset; }
+    void setSrc1Offset(ByteCodeStackOffset o) { m_src1Offset = o; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1231,6 +2073,7 @@ public:
 
     uint32_t tableIndex() const { return m_tableIndex; }
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1262,6 +2105,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 
 #if !defined(NDEBUG)
     void dump(size_t pos)
@@ -1294,6 +2138,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 #if !defined(NDEBUG)
     void dump(size_t pos)
     {
@@ -1326,6 +2171,7 @@ public:
     {
         return m_srcOffsets;
     }
+    void setSrcOffset(size_t idx, ByteCodeStackOffset o) { m_srcOffsets[idx] = o; }
 #if !defined(NDEBUG)
     void dump(size_t pos)
     {
@@ -1377,6 +2223,7 @@ public:
     }
 
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
     uint32_t funcIndex() const { return m_funcIndex; }
 
 #if !defined(NDEBUG)
@@ -1403,6 +2250,7 @@ public:
     }
 
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
     uint32_t index() const { return m_index; }
 
 #if !defined(NDEBUG)
@@ -1429,6 +2277,7 @@ public:
     }
 
     ByteCodeStackOffset dstOffset() const { return m_dstOffset; }
+    void setDstOffset(ByteCodeStackOffset o) { m_dstOffset = o; }
     uint32_t index() const { return m_index; }
 
 #if !defined(NDEBUG)
@@ -1455,6 +2304,7 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     uint32_t index() const { return m_index; }
 
 #if !defined(NDEBUG)
@@ -1481,6 +2331,7 @@ public:
     }
 
     ByteCodeStackOffset srcOffset() const { return m_srcOffset; }
+    void setSrcOffset(ByteCodeStackOffset o) { m_srcOffset = o; }
     uint32_t index() const { return m_index; }
 
 #if !defined(NDEBUG)
@@ -26,6 +26,7 @@
 #include "runtime/Module.h"
 #include "runtime/Trap.h"
 #include "runtime/Tag.h"
+#include "runtime/ValueStack.h"
 #include "util/MathOperation.h"
 
 #if defined(WALRUS_ENABLE_COMPUTED_GOTO)
@@ -37,6 +38,35 @@ namespace Walrus {
 
 ByteCodeTable g_byteCodeTable;
 
+#if defined(WALRUS_BYTECODE_STATS)
+uint64_t Interpreter::s_dispatchCount;
+#define COUNT_DISPATCH() s_dispatchCount++;
+#else
+#define COUNT_DISPATCH()
+#endif
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+MAY_THREAD_LOCAL ExecutionState* Interpreter::s_currentState;
+
+// sets the state reported by the guard page handler while the loop runs
+class CurrentStateScope {
+public:
+    CurrentStateScope(ExecutionState& state)
+        : m_previous(Interpreter::s_currentState)
+    {
+        Interpreter::s_currentState = &state;
+    }
+
+    ~CurrentStateScope()
+    {
+        Interpreter::s_currentState = m_previous;
+    }
+
+private:
+    ExecutionState* m_previous;
+};
+#endif
+
 ByteCodeTable::ByteCodeTable()
 {
 #if defined(WALRUS_ENABLE_COMPUTED_GOTO)
@@ -56,12 +86,15 @@ ByteCodeTable::ByteCodeTable()
 ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
                                             uint8_t* bp)
 {
+    uint8_t* entryBp = bp;
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    CurrentStateScope currentStateScope(state);
+#endif
     DefinedFunction* df = state.currentFunction()->asDefinedFunction();
-    ModuleFunction* mf = df->moduleFunction();
-    size_t programCounter = reinterpret_cast<size_t>(mf->byteCode());
-    Instance* instance = df->instance();
+    size_t programCounter = reinterpret_cast<size_t>(df->moduleFunction()->byteCode());
     while (true) {
         try {
+            Instance* instance = df->instance();
             return interpret(state, programCounter, bp, instance, instance->m_memories, instance->m_tables, instance->m_globals);
         } catch (std::unique_ptr<Exception>& e) {
             for (size_t i = e->m_programCounterInfo.size(); i > 0; i--) {
@@ -70,26 +103,43 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
                     break;
                 }
             }
-            if (e->isUserException()) {
-                bool isCatchSucessful = false;
-                Tag* tag = e->tag().value();
-                size_t offset = programCounter - reinterpret_cast<size_t>(mf->byteCode());
-                for (const auto& item : mf->catchInfo()) {
-                    if (item.m_tryStart <= offset && offset < item.m_tryEnd) {
-                        if (item.m_tagIndex == std::numeric_limits<uint32_t>::max() || state.currentFunction()->asDefinedFunction()->instance()->tag(item.m_tagIndex) == tag) {
-                            programCounter = item.m_catchStartPosition + reinterpret_cast<size_t>(mf->byteCode());
-                            uint8_t* sp = bp + item.m_stackSizeToBe;
-                            if (item.m_tagIndex != std::numeric_limits<uint32_t>::max() && tag->functionType()->paramStackSize()) {
-                                memcpy(sp, e->userExceptionData().data(), tag->functionType()->paramStackSize());
+
+            // unwind the frames called by the interpreter loop until the exception is caught
+            bool isCatchSucessful = false;
+            while (true) {
+                df = state.currentFunction()->asDefinedFunction();
+                bp = state.m_interpreterFrame ? reinterpret_cast<uint8_t*>(state.m_interpreterFrame.value() + 1) : entryBp;
+                if (e->isUserException()) {
+                    ModuleFunction* mf = df->moduleFunction();
+                    Tag* tag = e->tag().value();
+                    size_t offset = programCounter - reinterpret_cast<size_t>(mf->byteCode());
+                    for (const auto& item : mf->catchInfo()) {
+                        if (item.m_tryStart <= offset && offset < item.m_tryEnd) {
+                            if (item.m_tagIndex == std::numeric_limits<uint32_t>::max() || df->instance()->tag(item.m_tagIndex) == tag) {
+                                programCounter = item.m_catchStartPosition + reinterpret_cast<size_t>(mf->byteCode());
+                                uint8_t* sp = bp + item.m_stackSizeToBe;
+                                if (item.m_tagIndex != std::numeric_limits<uint32_t>::max() && tag->functionType()->paramStackSize()) {
+                                    memcpy(sp, e->userExceptionData().data(), tag->functionType()->paramStackSize());
+                                }
+                                isCatchSucessful = true;
+                                break;
                             }
-                            isCatchSucessful = true;
-                            break;
                         }
                     }
                 }
-                if (isCatchSucessful) {
-                    continue;
+                if (isCatchSucessful || !state.m_interpreterFrame) {
+                    break;
                 }
+
+                InterpreterFrame* frame = state.m_interpreterFrame.value();
+                // any position inside the call bytecode
+                programCounter = frame->m_returnProgramCounter - 1;
+                state.m_interpreterFrame = frame->m_parent;
+                state.m_currentFunction = frame->m_caller;
+                ValueStack::release(reinterpret_cast<uint8_t*>(frame));
+            }
+            if (isCatchSucessful) {
+                continue;
             }
             throw std::unique_ptr<Exception>(std::move(e));
         }
@@ -219,6 +269,37 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
 
 #define ADD_PROGRAM_COUNTER(codeName) programCounter += sizeof(codeName);
 
+    // The buffer and size of the default memory are pinned in locals. Only
+    // memory.grow can change them in the current function, and a called
+    // function or host function can grow the memory before returning.
+    Memory* memory = nullptr;
+    uint8_t* memoryBuffer = nullptr;
+    uint32_t memorySize = 0;
+
+#define MEMORY_BUFFER memoryBuffer
+#define MEMORY_SIZE memorySize
+#define LOAD_MEMORY()                      \
+    if (memory) {                          \
+        memoryBuffer = memory->buffer();   \
+        memorySize = memory->sizeInByte(); \
+    }
+
+#define LOAD_INSTANCE(newInstance)                                                  \
+    if (instance != newInstance) {                                                  \
+        instance = newInstance;                                                     \
+        memories = instance->m_memories;                                            \
+        tables = instance->m_tables;                                                \
+        globals = instance->m_globals;                                              \
+        memory = instance->module()->numberOfMemoryTypes() ? memories[0] : nullptr; \
+        LOAD_MEMORY();                                                              \
+    }
+
+    // the opcode table is filled without an instance
+    if (LIKELY(instance != nullptr)) {
+        memory = instance->module()->numberOfMemoryTypes() ? memories[0] : nullptr;
+        LOAD_MEMORY();
+    }
+
 #define BINARY_OPERATION(name, op, paramType, returnType)                   \
     DEFINE_OPCODE(name)                                                     \
         :                                                                   \
@@ -231,6 +312,17 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         NEXT_INSTRUCTION();                                                 \
     }
 
+#define BINARY_IMM_OPERATION(name, baseName, op, paramType, returnType)                                       \
+    DEFINE_OPCODE(name)                                                                                       \
+        :                                                                                                     \
+    {                                                                                                         \
+        name* code = (name*)programCounter;                                                                   \
+        auto lhs = readValue<paramType>(bp, code->srcOffset());                                               \
+        writeValue<returnType>(bp, code->dstOffset(), op(state, lhs, static_cast<paramType>(code->value()))); \
+        ADD_PROGRAM_COUNTER(name);                                                                            \
+        NEXT_INSTRUCTION();                                                                                   \
+    }
+
 #define UNARY_OPERATION(name, op, type)                                                      \
     DEFINE_OPCODE(name)                                                                      \
         :                                                                                    \
@@ -251,32 +343,136 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
         NEXT_INSTRUCTION();                                                                                            \
     }
 
-#define MEMORY_LOAD_OPERATION(opcodeName, readType, writeType)        \
-    DEFINE_OPCODE(opcodeName)                                         \
-        :                                                             \
-    {                                                                 \
-        MemoryLoad* code = (MemoryLoad*)programCounter;               \
-        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset()); \
-        readType value;                                               \
-        memories[0]->load(state, offset, code->offset(), &value);     \
-        writeValue<writeType>(bp, code->dstOffset(), value);          \
-        ADD_PROGRAM_COUNTER(MemoryLoad);                              \
-        NEXT_INSTRUCTION();                                           \
+#define BINARY_COMPARE_JUMP_OPERATION(name, op, paramType, jumpIf) \
+    DEFINE_OPCODE(name)                                            \
+        :                                                          \
+    {                                                              \
+        name* code = (name*)programCounter;                        \
+        auto lhs = readValue<paramType>(bp, code->srcOffset()[0]); \
+        auto rhs = readValue<paramType>(bp, code->srcOffset()[1]); \
+        if (op(state, lhs, rhs) == jumpIf) {                       \
+            programCounter += code->offset();                      \
+        } else {                                                   \
+            ADD_PROGRAM_COUNTER(name);                             \
+        }                                                          \
+        NEXT_INSTRUCTION();                                        \
+    }
+
+#define UNARY_COMPARE_JUMP_OPERATION(name, op, type, jumpIf)        \
+    DEFINE_OPCODE(name)                                             \
+        :                                                           \
+    {                                                               \
+        name* code = (name*)programCounter;                         \
+        if (op(readValue<type>(bp, code->srcOffset())) == jumpIf) { \
+            programCounter += code->offset();                       \
+        } else {                                                    \
+            ADD_PROGRAM_COUNTER(name);                              \
+        }                                                           \
+        NEXT_INSTRUCTION();                                         \
     }
 
-#define MEMORY_STORE_OPERATION(opcodeName, readType, writeType)        \
-    DEFINE_OPCODE(opcodeName)                                          \
-        :                                                              \
-    {                                                                  \
-        MemoryStore* code = (MemoryStore*)programCounter;              \
-        writeType value = readValue<readType>(bp, code->src1Offset()); \
-        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset()); \
-        memories[0]->store(state, offset, code->offset(), value);      \
-        ADD_PROGRAM_COUNTER(MemoryStore);                              \
-        NEXT_INSTRUCTION();                                            \
+#define MEMORY_LOAD_OPERATION(opcodeName, readType, writeType)                           \
+    DEFINE_OPCODE(opcodeName)                                                            \
+        :                                                                                \
+    {                                                                                    \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                                  \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                    \
+        readType value;                                                                  \
+        Memory::load(state, MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), &value); \
+        writeValue<writeType>(bp, code->dstOffset(), value);                             \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                                 \
+        NEXT_INSTRUCTION();                                                              \
+    }
+
+#define MEMORY_STORE_OPERATION(opcodeName, readType, writeType)                          \
+    DEFINE_OPCODE(opcodeName)                                                            \
+        :                                                                                \
+    {                                                                                    \
+        MemoryStore* code = (MemoryStore*)programCounter;                                \
+        writeType value = readValue<readType>(bp, code->src1Offset());                   \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                   \
+        Memory::store(state, MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), value); \
+        ADD_PROGRAM_COUNTER(MemoryStore);                                                \
+        NEXT_INSTRUCTION();                                                              \
     }
 
 
+#define MEMORY_LOAD_NO_OFFSET_OPERATION(opcodeName, baseName, readType, writeType) \
+    DEFINE_OPCODE(opcodeName)                                                      \
+        :                                                                          \
+    {                                                                              \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                            \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());              \
+        readType value;                                                            \
+        Memory::load(state, MEMORY_BUFFER, MEMORY_SIZE, offset, &value);           \
+        writeValue<writeType>(bp, code->dstOffset(), value);                       \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                           \
+        NEXT_INSTRUCTION();                                                        \
+    }
+
+#define MEMORY_STORE_NO_OFFSET_OPERATION(opcodeName, baseName, readType, writeType) \
+    DEFINE_OPCODE(opcodeName)                                                       \
+        :                                                                           \
+    {                                                                               \
+        MemoryStore* code = (MemoryStore*)programCounter;                           \
+        writeType value = readValue<readType>(bp, code->src1Offset());              \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());              \
+        Memory::store(state, MEMORY_BUFFER, MEMORY_SIZE, offset, value);            \
+        ADD_PROGRAM_COUNTER(MemoryStore);                                           \
+        NEXT_INSTRUCTION();                                                         \
+    }
+
+// the 32-bit addition of the fused i32.add wraps around before the static offset is applied
+#define MEMORY_LOAD_ADD_IMM_OPERATION(opcodeName, baseName, readType, writeType)         \
+    DEFINE_OPCODE(opcodeName)                                                            \
+        :                                                                                \
+    {                                                                                    \
+        MemoryLoadAddImm* code = (MemoryLoadAddImm*)programCounter;                      \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset()) + code->value();    \
+        readType value;                                                                  \
+        Memory::load(state, MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), &value); \
+        writeValue<writeType>(bp, code->dstOffset(), value);                             \
+        ADD_PROGRAM_COUNTER(MemoryLoadAddImm);                                           \
+        NEXT_INSTRUCTION();                                                              \
+    }
+
+#define MEMORY_STORE_ADD_IMM_OPERATION(opcodeName, baseName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                            \
+        :                                                                                \
+    {                                                                                    \
+        MemoryStoreAddImm* code = (MemoryStoreAddImm*)programCounter;                    \
+        writeType value = readValue<readType>(bp, code->src1Offset());                   \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset()) + code->value();   \
+        Memory::store(state, MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), value); \
+        ADD_PROGRAM_COUNTER(MemoryStoreAddImm);                                          \
+        NEXT_INSTRUCTION();                                                              \
+    }
+
+#define MEMORY_LOAD_UNCHECKED_OPERATION(opcodeName, baseName, readType, writeType)         \
+    DEFINE_OPCODE(opcodeName)                                                              \
+        :                                                                                  \
+    {                                                                                      \
+        MemoryLoad* code = (MemoryLoad*)programCounter;                                    \
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());                      \
+        readType value;                                                                    \
+        Memory::uncheckedLoad(MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), &value); \
+        writeValue<writeType>(bp, code->dstOffset(), value);                               \
+        ADD_PROGRAM_COUNTER(MemoryLoad);                                                   \
+        NEXT_INSTRUCTION();                                                                \
+    }
+
+#define MEMORY_STORE_UNCHECKED_OPERATION(opcodeName, baseName, readType, writeType)        \
+    DEFINE_OPCODE(opcodeName)                                                              \
+        :                                                                                  \
+    {                                                                                      \
+        MemoryStore* code = (MemoryStore*)programCounter;                                  \
+        writeType value = readValue<readType>(bp, code->src1Offset());                     \
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());                     \
+        Memory::uncheckedStore(MEMORY_BUFFER, MEMORY_SIZE, offset, code->offset(), value); \
+        ADD_PROGRAM_COUNTER(MemoryStore);                                                  \
+        NEXT_INSTRUCTION();                                                                \
+    }
+
 #if defined(WALRUS_ENABLE_COMPUTED_GOTO)
 #if defined(WALRUS_COMPUTED_GOTO_INTERPRETER_INIT_WITH_NULL)
     if (UNLIKELY((((ByteCode*)programCounter)->m_opcodeInAddress) == NULL)) {
@@ -289,11 +485,12 @@ ByteCodeStackOffset* Interpreter::interpret(ExecutionState& state,
 #define NEXT_INSTRUCTION() goto NextInstruction;
 
 NextInstruction:
+    COUNT_DISPATCH();
     /* Execute first instruction. */
     goto*(((ByteCode*)programCounter)->m_opcodeInAddress);
 #else
 
-#define DEFINE_OPCODE(codeName) case codeName##Opcode
+#define DEFINE_OPCODE(codeName) case ByteCode::codeName##Opcode
 #define DEFINE_DEFAULT                \
     default:                          \
         RELEASE_ASSERT_NOT_REACHED(); \
@@ -301,6 +498,7 @@ NextInstruction:
 #define NEXT_INSTRUCTION() \
     goto NextInstruction;
 NextInstruction:
+    COUNT_DISPATCH();
     auto currentOpcode = ((ByteCode*)programCounter)->m_opcode;
 
     switch (currentOpcode) {
@@ -347,7 +545,7 @@ NextInstruction:
     {
         Load32* code = (Load32*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
-        memories[0]->load(state, offset, reinterpret_cast<uint32_t*>(bp + code->dstOffset()));
+        Memory::load(state, MEMORY_BUFFER, MEMORY_SIZE, offset, reinterpret_cast<uint32_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load32);
         NEXT_INSTRUCTION();
     }
@@ -357,7 +555,7 @@ NextInstruction:
     {
         Load64* code = (Load64*)programCounter;
         uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
-        memories[0]->load(state, offset, reinterpret_cast<uint64_t*>(bp + code->dstOffset()));
+        Memory::load(state, MEMORY_BUFFER, MEMORY_SIZE, offset, reinterpret_cast<uint64_t*>(bp + code->dstOffset()));
         ADD_PROGRAM_COUNTER(Load64);
         NEXT_INSTRUCTION();
     }
@@ -368,7 +566,7 @@ NextInstruction:
         Store32* code = (Store32*)programCounter;
         uint32_t value = readValue<uint32_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
-        memories[0]->store(state, offset, value);
+        Memory::store(state, MEMORY_BUFFER, MEMORY_SIZE, offset, value);
         ADD_PROGRAM_COUNTER(Store32);
         NEXT_INSTRUCTION();
     }
@@ -379,12 +577,70 @@ NextInstruction:
         Store64* code = (Store64*)programCounter;
         uint64_t value = readValue<uint64_t>(bp, code->src1Offset());
         uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
-        memories[0]->store(state, offset, value);
+        Memory::store(state, MEMORY_BUFFER, MEMORY_SIZE, offset, value);
         ADD_PROGRAM_COUNTER(Store64);
         NEXT_INSTRUCTION();
     }
 
+    DEFINE_OPCODE(Load32Unchecked)
+        :
+    {
+        Load32Unchecked* code = (Load32Unchecked*)programCounter;
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        Memory::uncheckedLoad(MEMORY_BUFFER, MEMORY_SIZE, offset, 0, reinterpret_cast<uint32_t*>(bp + code->dstOffset()));
+        ADD_PROGRAM_COUNTER(Load32Unchecked);
+        NEXT_INSTRUCTION();
+    }
+
+    DEFINE_OPCODE(Load64Unchecked)
+        :
+    {
+        Load64Unchecked* code = (Load64Unchecked*)programCounter;
+        uint32_t offset = readValue<uint32_t>(bp, code->srcOffset());
+        Memory::uncheckedLoad(MEMORY_BUFFER, MEMORY_SIZE, offset, 0, reinterpret_cast<uint64_t*>(bp + code->dstOffset()));
+        ADD_PROGRAM_COUNTER(Load64Unchecked);
+        NEXT_INSTRUCTION();
+    }
+
+    DEFINE_OPCODE(Store32Unchecked)
+        :
+    {
+        Store32Unchecked* code = (Store32Unchecked*)programCounter;
+        uint32_t value = readValue<uint32_t>(bp, code->src1Offset());
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
+        Memory::uncheckedStore(MEMORY_BUFFER, MEMORY_SIZE, offset, 0, value);
+        ADD_PROGRAM_COUNTER(Store32Unchecked);
+        NEXT_INSTRUCTION();
+    }
+
+    DEFINE_OPCODE(Store64Unchecked)
+        :
+    {
+        Store64Unchecked* code = (Store64Unchecked*)programCounter;
+        uint64_t value = readValue<uint64_t>(bp, code->src1Offset());
+        uint32_t offset = readValue<uint32_t>(bp, code->src0Offset());
+        Memory::uncheckedStore(MEMORY_BUFFER, MEMORY_SIZE, offset, 0, value);
+        ADD_PROGRAM_COUNTER(Store64Unchecked);
+        NEXT_INSTRUCTION();
+    }
+
+    DEFINE_OPCODE(LoopBoundsCheck)
+        :
+    {
+        LoopBoundsCheck* code = (LoopBoundsCheck*)programCounter;
+        uint32_t base = readValue<uint32_t>(bp, code->baseOffset());
+        uint32_t bound = readValue<uint32_t>(bp, code->boundOffset());
+        if (LIKELY(code->isInBounds(base, bound, MEMORY_SIZE))) {
+            ADD_PROGRAM_COUNTER(LoopBoundsCheck);
+        } else {
+            programCounter += code->offset();
+        }
+        NEXT_INSTRUCTION();
+    }
+
     FOR_EACH_BYTECODE_BINARY_OP(BINARY_OPERATION)
+    FOR_EACH_BYTECODE_BINARY_IMM32_OP(BINARY_IMM_OPERATION)
+    FOR_EACH_BYTECODE_BINARY_IMM64_OP(BINARY_IMM_OPERATION)
     FOR_EACH_BYTECODE_UNARY_OP(UNARY_OPERATION)
     FOR_EACH_BYTECODE_UNARY_OP_2(UNARY_OPERATION_2)
 
@@ -420,17 +676,45 @@ NextInstruction:
         NEXT_INSTRUCTION();
     }
 
+    FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(BINARY_COMPARE_JUMP_OPERATION)
+    FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(UNARY_COMPARE_JUMP_OPERATION)
+
     DEFINE_OPCODE(Call)
         :
     {
-        callOperation(state, programCounter, bp, instance);
+        Call* code = (Call*)programCounter;
+        Function* target = instance->function(code->index());
+        size_t nextProgramCounter = programCounter + sizeof(Call) + sizeof(ByteCodeStackOffset) * code->offsetsSize();
+        if (LIKELY(target->isDefinedFunction())) {
+            DefinedFunction* callee = target->asDefinedFunction();
+            bp = callDefinedFunction(state, nextProgramCounter, bp, callee, code->stackOffsets());
+            LOAD_INSTANCE(callee->instance());
+            programCounter = reinterpret_cast<size_t>(callee->moduleFunction()->byteCode());
+        } else {
+            callOperation(state, bp, target, code->stackOffsets());
+            LOAD_MEMORY();
+            programCounter = nextProgramCounter;
+        }
         NEXT_INSTRUCTION();
     }
 
     DEFINE_OPCODE(CallIndirect)
         :
     {
-        callIndirectOperation(state, programCounter, bp, instance);
+        CallIndirect* code = (CallIndirect*)programCounter;
+        Function* target = callIndirectTarget(state, bp, instance, code);
+        const FunctionType* ft = code->functionType();
+        size_t nextProgramCounter = programCounter + sizeof(CallIndirect) + sizeof(ByteCodeStackOffset) * (ft->param().size() + ft->result().size());
+        if (LIKELY(target->isDefinedFunction())) {
+            DefinedFunction* callee = target->asDefinedFunction();
+            bp = callDefinedFunction(state, nextProgramCounter, bp, callee, code->stackOffsets());
+            LOAD_INSTANCE(callee->instance());
+            programCounter = reinterpret_cast<size_t>(callee->moduleFunction()->byteCode());
+        } else {
+            callOperation(state, bp, target, code->stackOffsets());
+            LOAD_MEMORY();
+            programCounter = nextProgramCounter;
+        }
         NEXT_INSTRUCTION();
     }
 
@@ -508,6 +792,12 @@ NextInstruction:
 
     FOR_EACH_BYTECODE_LOAD_OP(MEMORY_LOAD_OPERATION)
     FOR_EACH_BYTECODE_STORE_OP(MEMORY_STORE_OPERATION)
+    FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(MEMORY_LOAD_NO_OFFSET_OPERATION)
+    FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(MEMORY_STORE_NO_OFFSET_OPERATION)
+    FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(MEMORY_LOAD_ADD_IMM_OPERATION)
+    FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(MEMORY_STORE_ADD_IMM_OPERATION)
+    FOR_EACH_BYTECODE_LOAD_UNCHECKED_OP(MEMORY_LOAD_UNCHECKED_OPERATION)
+    FOR_EACH_BYTECODE_STORE_UNCHECKED_OP(MEMORY_STORE_UNCHECKED_OPERATION)
 
     DEFINE_OPCODE(MemorySize)
         :
@@ -526,6 +816,7 @@ NextInstruction:
         auto oldSize = m->sizeInPageSize();
         if (m->grow(readValue<int32_t>(bp, code->srcOffset()) * (uint64_t)Memory::s_memoryPageSize)) {
             writeValue<int32_t>(bp, code->dstOffset(), oldSize);
+            LOAD_MEMORY();
         } else {
             writeValue<int32_t>(bp, code->dstOffset(), -1);
         }
@@ -621,8 +912,7 @@ NextInstruction:
         // FIXME read reference
         void* ptr = readValue<void*>(bp, code->src0Offset());
 
-        if (newSize <= table->maximumSize()) {
-            table->grow(newSize, ptr);
+        if (newSize <= table->maximumSize() && table->grow(newSize, ptr)) {
             writeValue<uint32_t>(bp, code->dstOffset(), size);
         } else {
             writeValue<uint32_t>(bp, code->dstOffset(), -1);
@@ -749,6 +1039,15 @@ NextInstruction:
         :
     {
         End* code = (End*)programCounter;
+        if (state.m_interpreterFrame) {
+            InterpreterFrame* frame = state.m_interpreterFrame.value();
+            returnToCaller(state, frame, bp, code->resultOffsets());
+            bp = frame->m_callerBp;
+            LOAD_INSTANCE(frame->m_caller->instance());
+            LOAD_MEMORY();
+            programCounter = frame->m_returnProgramCounter;
+            NEXT_INSTRUCTION();
+        }
         return code->resultOffsets();
     }
 
@@ -765,8 +1064,8 @@ NextInstruction:
     g_byteCodeTable.m_addressTable[ByteCode::name##Opcode] = &&name##OpcodeLbl;
         FOR_EACH_BYTECODE(REGISTER_TABLE)
 #undef REGISTER_TABLE
-#endif
         initAddressToOpcodeTable();
+#endif
         return nullptr;
     }
 
@@ -775,82 +1074,103 @@ NextInstruction:
     return nullptr;
 }
 
-NEVER_INLINE void Interpreter::callOperation(
+static ALWAYS_INLINE void copyStackValue(uint8_t* dst, uint8_t* src, size_t size)
+{
+    if (size == 4) {
+        *reinterpret_cast<uint32_t*>(dst) = *reinterpret_cast<uint32_t*>(src);
+    } else if (size == 8) {
+        *reinterpret_cast<uint64_t*>(dst) = *reinterpret_cast<uint64_t*>(src);
+    } else {
+        memcpy(dst, src, size);
+    }
+}
+
+NEVER_INLINE void Interpreter::compileFunction(ExecutionState& state, ModuleFunction* function)
+{
+    std::string error = function->compile();
+    if (UNLIKELY(error.length())) {
+        Trap::throwException(state, error);
+    }
+}
+
+uint8_t* Interpreter::callDefinedFunction(
     ExecutionState& state,
-    size_t& programCounter,
+    size_t returnProgramCounter,
     uint8_t* bp,
-    Instance* instance)
+    DefinedFunction* callee,
+    ByteCodeStackOffset* stackOffsets)
 {
-    Call* code = (Call*)programCounter;
+    ModuleFunction* mf = callee->moduleFunction();
+    if (UNLIKELY(!mf->isCompiled())) {
+        compileFunction(state, mf);
+    }
+    InterpreterFrame* frame = reinterpret_cast<InterpreterFrame*>(ValueStack::allocate(sizeof(InterpreterFrame) + mf->requiredStackSize()));
+    if (UNLIKELY(!frame)) {
+        Trap::throwException(state, "call stack exhausted");
+    }
 
-    Function* target = instance->function(code->index());
-    const FunctionType* ft = target->functionType();
-    const ValueTypeVector& param = ft->param();
-    ALLOCA(Value, paramVector, sizeof(Value) * param.size(), isAllocaParam);
+    const ValueTypeVector& param = callee->functionType()->param();
+    frame->m_parent = state.m_interpreterFrame;
+    frame->m_caller = state.m_currentFunction->asDefinedFunction();
+    frame->m_callerBp = bp;
+    frame->m_returnProgramCounter = returnProgramCounter;
+    frame->m_resultOffsets = stackOffsets + param.size();
 
-    size_t c = 0;
+    // init parameter space
+    uint8_t* calleeBp = reinterpret_cast<uint8_t*>(frame + 1);
+    uint8_t* calleeSp = calleeBp;
     for (size_t i = 0; i < param.size(); i++) {
-        paramVector[i] = Value(param[i], bp + code->stackOffsets()[c++]);
+        size_t size = valueSizeInStack(param[i]);
+        copyStackValue(calleeSp, bp + stackOffsets[i], size);
+        calleeSp += size;
     }
 
-    const ValueTypeVector& result = ft->result();
-    ALLOCA(Value, resultVector, sizeof(Value) * result.size(), isAllocaResult);
-    size_t codeExtraOffsetsSize = sizeof(ByteCodeStackOffset) * ft->param().size() + sizeof(ByteCodeStackOffset) * ft->result().size();
+    // init local space
+    memset(calleeSp, 0, mf->requiredStackSizeDueToLocal());
 
-    target->call(state, param.size(), paramVector, resultVector);
+    state.m_interpreterFrame = frame;
+    state.m_currentFunction = callee;
+    return calleeBp;
+}
 
+void Interpreter::returnToCaller(
+    ExecutionState& state,
+    InterpreterFrame* frame,
+    uint8_t* bp,
+    ByteCodeStackOffset* resultOffsets)
+{
+    const ValueTypeVector& result = state.m_currentFunction->functionType()->result();
     for (size_t i = 0; i < result.size(); i++) {
-        uint8_t* resultStackPointer = bp + code->stackOffsets()[c++];
-        resultVector[i].writeToMemory(resultStackPointer);
+        copyStackValue(frame->m_callerBp + frame->m_resultOffsets[i], bp + resultOffsets[i], valueSizeInStack(result[i]));
     }
 
-    if (UNLIKELY(!isAllocaParam)) {
-        delete[] paramVector;
-    }
-    if (UNLIKELY(!isAllocaResult)) {
-        delete[] resultVector;
-    }
-
-    programCounter += sizeof(Call) + codeExtraOffsetsSize;
+    state.m_interpreterFrame = frame->m_parent;
+    state.m_currentFunction = frame->m_caller;
+    ValueStack::release(reinterpret_cast<uint8_t*>(frame));
 }
 
-NEVER_INLINE void Interpreter::callIndirectOperation(
+NEVER_INLINE void Interpreter::callOperation(
     ExecutionState& state,
-    size_t& programCounter,
     uint8_t* bp,
-    Instance* instance)
+    Function* target,
+    ByteCodeStackOffset* stackOffsets)
 {
-    CallIndirect* code = (CallIndirect*)programCounter;
-    Table* table = instance->table(code->tableIndex());
-
-    uint32_t idx = readValue<uint32_t>(bp, code->calleeOffset());
-    if (idx >= table->size()) {
-        Trap::throwException(state, "undefined element");
-    }
-    auto target = reinterpret_cast<Function*>(table->uncheckedGetElement(idx));
-    if (UNLIKELY(Value::isNull(target))) {
-        Trap::throwException(state, "uninitialized element " + std::to_string(idx));
-    }
     const FunctionType* ft = target->functionType();
-    if (!ft->equals(code->functionType())) {
-        Trap::throwException(state, "indirect call type mismatch");
-    }
     const ValueTypeVector& param = ft->param();
     ALLOCA(Value, paramVector, sizeof(Value) * param.size(), isAllocaParam);
 
     size_t c = 0;
     for (size_t i = 0; i < param.size(); i++) {
-        paramVector[i] = Value(param[i], bp + code->stackOffsets()[c++]);
+        paramVector[i] = Value(param[i], bp + stackOffsets[c++]);
     }
 
     const ValueTypeVector& result = ft->result();
     ALLOCA(Value, resultVector, sizeof(Value) * result.size(), isAllocaResult);
-    size_t codeExtraOffsetsSize = sizeof(ByteCodeStackOffset) * ft->param().size() + sizeof(ByteCodeStackOffset) * ft->result().size();
 
     target->call(state, param.size(), paramVector, resultVector);
 
     for (size_t i = 0; i < result.size(); i++) {
-        uint8_t* resultStackPointer = bp + code->stackOffsets()[c++];
+        uint8_t* resultStackPointer = bp + stackOffsets[c++];
         resultVector[i].writeToMemory(resultStackPointer);
     }
 
@@ -860,8 +1180,43 @@ NEVER_INLINE void Interpreter::callIndirectOperation(
     if (UNLIKELY(!isAllocaResult)) {
         delete[] resultVector;
     }
+}
 
-    programCounter += sizeof(CallIndirect) + codeExtraOffsetsSize;
+Function* Interpreter::callIndirectTarget(
+    ExecutionState& state,
+    uint8_t* bp,
+    Instance* instance,
+    CallIndirect* code)
+{
+    Table* table = instance->table(code->tableIndex());
+
+    uint32_t idx = readValue<uint32_t>(bp, code->calleeOffset());
+    Function* target = code->lookupCache(table, table->version(), idx);
+    // the target of a hit is checked again, the cache must not bypass the type check
+    if (target && LIKELY(target->functionType()->signatureId() == code->signatureId())) {
+#if defined(WALRUS_BYTECODE_STATS)
+        code->countCacheHit();
+#endif
+        return target;
+    }
+#if defined(WALRUS_BYTECODE_STATS)
+    code->countCacheMiss();
+#endif
+
+    if (idx >= table->size()) {
+        Trap::throwException(state, "undefined element");
+    }
+    const Table::Entry& entry = table->uncheckedGetEntry(idx);
+    // null entries have no signature id, so a single compare covers both checks
+    if (UNLIKELY(entry.m_signatureId != code->signatureId())) {
+        if (Value::isNull(entry.m_value)) {
+            Trap::throwException(state, "uninitialized element " + std::to_string(idx));
+        }
+        Trap::throwException(state, "indirect call type mismatch");
+    }
+    target = reinterpret_cast<Function*>(entry.m_value);
+    code->updateCache(table, table->version(), idx, target);
+    return target;
 }
 
 } // namespace Walrus
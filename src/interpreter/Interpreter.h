@@ -26,13 +26,49 @@ class Instance;
 class Memory;
 class Table;
 class Global;
+class Function;
+class DefinedFunction;
+class ModuleFunction;
+
+// Frame of a wasm function called by the interpreter loop. It is stored in
+// the ValueStack right before the stack of the callee.
+struct InterpreterFrame {
+    Optional<InterpreterFrame*> m_parent;
+    DefinedFunction* m_caller;
+    uint8_t* m_callerBp;
+    size_t m_returnProgramCounter;
+    // result offsets of the call bytecode in the caller
+    ByteCodeStackOffset* m_resultOffsets;
+};
 
 class Interpreter {
 public:
     static ByteCodeStackOffset* interpret(ExecutionState& state,
                                           uint8_t* bp);
 
+    // generates the bytecode of a function of a lazily compiled module,
+    // throws a trap when it fails
+    static void compileFunction(ExecutionState& state, ModuleFunction* function);
+
+#if defined(WALRUS_BYTECODE_STATS)
+    // number of executed bytecodes
+    static uint64_t s_dispatchCount;
+#endif
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    // innermost state running the interpreter loop on this thread
+    static ExecutionState* currentState()
+    {
+        return s_currentState;
+    }
+#endif
+
 private:
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    friend class CurrentStateScope;
+    static MAY_THREAD_LOCAL ExecutionState* s_currentState;
+#endif
+
     friend class ByteCodeTable;
     static ByteCodeStackOffset* interpret(ExecutionState& state,
                                           size_t programCounter,
@@ -42,15 +78,28 @@ private:
                                           Table** tables,
                                           Global** globals);
 
+    // pushes the frame of the callee and returns its bp
+    static uint8_t* callDefinedFunction(ExecutionState& state,
+                                        size_t returnProgramCounter,
+                                        uint8_t* bp,
+                                        DefinedFunction* callee,
+                                        ByteCodeStackOffset* stackOffsets);
+
+    // copies the results to the frame of the caller and pops the frame of the callee
+    static void returnToCaller(ExecutionState& state,
+                               InterpreterFrame* frame,
+                               uint8_t* bp,
+                               ByteCodeStackOffset* resultOffsets);
+
     static void callOperation(ExecutionState& state,
-                              size_t& programCounter,
                               uint8_t* bp,
-                              Instance* instance);
+                              Function* target,
+                              ByteCodeStackOffset* stackOffsets);
 
-    static void callIndirectOperation(ExecutionState& state,
-                                      size_t& programCounter,
-                                      uint8_t* bp,
-                                      Instance* instance);
+    static Function* callIndirectTarget(ExecutionState& state,
+                                        uint8_t* bp,
+                                        Instance* instance,
+                                        CallIndirect* code);
 };
 
 } // namespace Walrus
@@ -0,0 +1,641 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "parser/BoundsCheckEliminator.h"
+#include "parser/ByteCodeVisitor.h"
+#include "runtime/Memory.h"
+
+namespace Walrus {
+
+// checked memory access which has an unchecked form
+struct MemoryAccess {
+    ByteCodeStackOffset m_address;
+    uint32_t m_offset;
+    uint32_t m_size;
+};
+
+static bool setAccess(MemoryAccess& access, ByteCodeStackOffset address, uint32_t offset, uint32_t size)
+{
+    access.m_address = address;
+    access.m_offset = offset;
+    access.m_size = size;
+    return true;
+}
+
+static bool decodeMemoryAccess(ByteCode* code, MemoryAccess& access)
+{
+    switch (code->opcode()) {
+    case ByteCode::Load32Opcode:
+        return setAccess(access, static_cast<Load32*>(code)->srcOffset(), 0, 4);
+    case ByteCode::Load64Opcode:
+        return setAccess(access, static_cast<Load64*>(code)->srcOffset(), 0, 8);
+    case ByteCode::Store32Opcode:
+        return setAccess(access, static_cast<Store32*>(code)->src0Offset(), 0, 4);
+    case ByteCode::Store64Opcode:
+        return setAccess(access, static_cast<Store64*>(code)->src0Offset(), 0, 8);
+#define CASE_LOAD(name, readType, writeType) \
+    case ByteCode::name##Opcode:             \
+        return setAccess(access, static_cast<MemoryLoad*>(code)->srcOffset(), static_cast<MemoryLoad*>(code)->offset(), sizeof(readType));
+        FOR_EACH_BYTECODE_LOAD_OP(CASE_LOAD)
+#undef CASE_LOAD
+#define CASE_LOAD_NO_OFFSET(name, baseName, readType, writeType) \
+    case ByteCode::name##Opcode:                                 \
+        return setAccess(access, static_cast<MemoryLoad*>(code)->srcOffset(), 0, sizeof(readType));
+        FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(CASE_LOAD_NO_OFFSET)
+#undef CASE_LOAD_NO_OFFSET
+#define CASE_STORE(name, readType, writeType) \
+    case ByteCode::name##Opcode:              \
+        return setAccess(access, static_cast<MemoryStore*>(code)->src0Offset(), static_cast<MemoryStore*>(code)->offset(), sizeof(writeType));
+        FOR_EACH_BYTECODE_STORE_OP(CASE_STORE)
+#undef CASE_STORE
+#define CASE_STORE_NO_OFFSET(name, baseName, readType, writeType) \
+    case ByteCode::name##Opcode:                                  \
+        return setAccess(access, static_cast<MemoryStore*>(code)->src0Offset(), 0, sizeof(writeType));
+        FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(CASE_STORE_NO_OFFSET)
+#undef CASE_STORE_NO_OFFSET
+    default:
+        return false;
+    }
+}
+
+// the unchecked forms have the same layout, so the access is rewritten in place
+static void makeUnchecked(ByteCode* code)
+{
+    switch (code->opcode()) {
+    case ByteCode::Load32Opcode: {
+        Load32* load = static_cast<Load32*>(code);
+        ByteCodeStackOffset src = load->srcOffset();
+        ByteCodeStackOffset dst = load->dstOffset();
+        new (code) Load32Unchecked(src, dst);
+        break;
+    }
+    case ByteCode::Load64Opcode: {
+        Load64* load = static_cast<Load64*>(code);
+        ByteCodeStackOffset src = load->srcOffset();
+        ByteCodeStackOffset dst = load->dstOffset();
+        new (code) Load64Unchecked(src, dst);
+        break;
+    }
+    case ByteCode::Store32Opcode: {
+        Store32* store = static_cast<Store32*>(code);
+        ByteCodeStackOffset src0 = store->src0Offset();
+        ByteCodeStackOffset src1 = store->src1Offset();
+        new (code) Store32Unchecked(src0, src1);
+        break;
+    }
+    case ByteCode::Store64Opcode: {
+        Store64* store = static_cast<Store64*>(code);
+        ByteCodeStackOffset src0 = store->src0Offset();
+        ByteCodeStackOffset src1 = store->src1Offset();
+        new (code) Store64Unchecked(src0, src1);
+        break;
+    }
+#define CASE_LOAD(name, uncheckedName)                                                                    \
+    case ByteCode::name##Opcode: {                                                                        \
+        static_assert(sizeof(name) == sizeof(uncheckedName), "unchecked load must have the same layout"); \
+        MemoryLoad* load = static_cast<MemoryLoad*>(code);                                                \
+        uint32_t offset = load->offset();                                                                 \
+        ByteCodeStackOffset src = load->srcOffset();                                                      \
+        ByteCodeStackOffset dst = load->dstOffset();                                                      \
+        new (code) uncheckedName(offset, src, dst);                                                       \
+        break;                                                                                            \
+    }
+#define CASE_STORE(name, uncheckedName)                                                                    \
+    case ByteCode::name##Opcode: {                                                                         \
+        static_assert(sizeof(name) == sizeof(uncheckedName), "unchecked store must have the same layout"); \
+        MemoryStore* store = static_cast<MemoryStore*>(code);                                              \
+        uint32_t offset = store->offset();                                                                 \
+        ByteCodeStackOffset src0 = store->src0Offset();                                                    \
+        ByteCodeStackOffset src1 = store->src1Offset();                                                    \
+        new (code) uncheckedName(offset, src0, src1);                                                      \
+        break;                                                                                             \
+    }
+#define CASE_LOAD_OP(name, readType, writeType) CASE_LOAD(name, name##Unchecked)
+#define CASE_STORE_OP(name, readType, writeType) CASE_STORE(name, name##Unchecked)
+#define CASE_LOAD_NO_OFFSET_OP(name, baseName, readType, writeType) CASE_LOAD(name, baseName##Unchecked)
+#define CASE_STORE_NO_OFFSET_OP(name, baseName, readType, writeType) CASE_STORE(name, baseName##Unchecked)
+        FOR_EACH_BYTECODE_LOAD_OP(CASE_LOAD_OP)
+        FOR_EACH_BYTECODE_STORE_OP(CASE_STORE_OP)
+        FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(CASE_LOAD_NO_OFFSET_OP)
+        FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(CASE_STORE_NO_OFFSET_OP)
+#undef CASE_LOAD_OP
+#undef CASE_STORE_OP
+#undef CASE_LOAD_NO_OFFSET_OP
+#undef CASE_STORE_NO_OFFSET_OP
+#undef CASE_LOAD
+#undef CASE_STORE
+    default:
+        RELEASE_ASSERT_NOT_REACHED();
+    }
+}
+
+class FunctionBoundsCheckEliminator {
+public:
+    // keeps the pass linear for large blocks
+    static const size_t s_maxFactCount = 16;
+
+    FunctionBoundsCheckEliminator(ModuleFunction* function, const WASMParsingResult& result, BoundsCheckEliminator::Statistics& stats)
+        : m_function(function)
+        , m_result(result)
+        , m_stats(stats)
+        , m_minimumMemorySize(static_cast<uint64_t>(result.m_memoryTypes[0]->initialSize()) * Memory::s_memoryPageSize)
+        , m_provenMemorySize(m_minimumMemorySize)
+    {
+    }
+
+    void run()
+    {
+        size_t byteCodeSize = m_function->currentByteCodeSize();
+        std::vector<bool> isTarget(byteCodeSize + 1, false);
+
+        size_t position = 0;
+        while (position < byteCodeSize) {
+            ByteCode* code = codeAt(position);
+            visitJumpOffsets(code, [&](int32_t offset) -> int32_t {
+                size_t target = position + offset;
+                if (target <= byteCodeSize) {
+                    isTarget[target] = true;
+                }
+                return offset;
+            });
+            position += code->getSize();
+        }
+        for (auto& info : m_function->catchInfo()) {
+            isTarget[info.m_catchStartPosition] = true;
+        }
+
+        position = 0;
+        while (position < byteCodeSize) {
+            ByteCode* code = codeAt(position);
+            size_t size = code->getSize();
+
+            if (isTarget[position]) {
+                reset();
+            }
+
+            MemoryAccess access;
+            if (decodeMemoryAccess(code, access)) {
+                uint64_t end = static_cast<uint64_t>(access.m_offset) + access.m_size;
+                m_stats.m_accessCount++;
+                if (isProven(access.m_address, end)) {
+                    makeUnchecked(code);
+                    m_stats.m_uncheckedCount++;
+                } else {
+                    addCheck(access.m_address, end);
+                }
+            }
+
+            auto invalidate = [&](ByteCodeStackOffset offset, bool isDef) -> ByteCodeStackOffset {
+                if (isDef) {
+                    kill(offset);
+                }
+                return offset;
+            };
+            if (!visitStackOffsets(code, m_result, invalidate)) {
+                reset();
+            }
+
+            if (code->opcode() == ByteCode::Const32Opcode) {
+                Const32* constant = static_cast<Const32*>(code);
+                addFact(m_constants, constant->dstOffset(), constant->value());
+            }
+
+            if (!visitJumpOffsets(code, [](int32_t offset) { return offset; })) {
+                reset();
+            }
+            position += size;
+        }
+    }
+
+private:
+    typedef std::vector<std::pair<ByteCodeStackOffset, uint64_t>> FactVector;
+
+    ByteCode* codeAt(size_t position)
+    {
+        return reinterpret_cast<ByteCode*>(m_function->byteCode() + position);
+    }
+
+    static FactVector::iterator findFact(FactVector& facts, ByteCodeStackOffset offset)
+    {
+        for (auto iter = facts.begin(); iter != facts.end(); iter++) {
+            if (iter->first == offset) {
+                return iter;
+            }
+        }
+        return facts.end();
+    }
+
+    static void addFact(FactVector& facts, ByteCodeStackOffset offset, uint64_t value)
+    {
+        auto iter = findFact(facts, offset);
+        if (iter != facts.end()) {
+            iter->second = value;
+        } else if (facts.size() < s_maxFactCount) {
+            facts.push_back(std::make_pair(offset, value));
+        }
+    }
+
+    bool isProven(ByteCodeStackOffset address, uint64_t end)
+    {
+        auto constant = findFact(m_constants, address);
+        if (constant != m_constants.end() && constant->second + end <= m_provenMemorySize) {
+            return true;
+        }
+        auto checked = findFact(m_checkedEnds, address);
+        return checked != m_checkedEnds.end() && end <= checked->second;
+    }
+
+    void addCheck(ByteCodeStackOffset address, uint64_t end)
+    {
+        auto constant = findFact(m_constants, address);
+        if (constant != m_constants.end()) {
+            m_provenMemorySize = std::max(m_provenMemorySize, constant->second + end);
+        }
+        auto checked = findFact(m_checkedEnds, address);
+        if (checked != m_checkedEnds.end()) {
+            checked->second = std::max(checked->second, end);
+        } else {
+            addFact(m_checkedEnds, address, end);
+        }
+    }
+
+    // an address is an i32 and a def writes at most 8 bytes
+    static void kill(FactVector& facts, ByteCodeStackOffset offset)
+    {
+        for (size_t i = 0; i < facts.size();) {
+            if (facts[i].first < offset + 8 && offset < facts[i].first + 4) {
+                facts[i] = facts.back();
+                facts.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    void kill(ByteCodeStackOffset offset)
+    {
+        kill(m_constants, offset);
+        kill(m_checkedEnds, offset);
+    }
+
+    void reset()
+    {
+        m_constants.clear();
+        m_checkedEnds.clear();
+        m_provenMemorySize = m_minimumMemorySize;
+    }
+
+    ModuleFunction* m_function;
+    const WASMParsingResult& m_result;
+    BoundsCheckEliminator::Statistics& m_stats;
+    uint64_t m_minimumMemorySize;
+    // the memory is at least this large after the checks of the block
+    uint64_t m_provenMemorySize;
+    // values of slots written by const32
+    FactVector m_constants;
+    // end of the range checked above the address stored in a slot
+    FactVector m_checkedEnds;
+};
+
+class FunctionLoopCheckHoister {
+public:
+    typedef Vector<ModuleFunction::LoopInfo, std::allocator<ModuleFunction::LoopInfo>> LoopInfoVector;
+
+    FunctionLoopCheckHoister(ModuleFunction* function, const LoopInfoVector& loops, const WASMParsingResult& result, BoundsCheckEliminator::Statistics& stats)
+        : m_function(function)
+        , m_loops(loops)
+        , m_result(result)
+        , m_stats(stats)
+    {
+    }
+
+    const std::vector<uint8_t>& byteCode() const { return m_byteCode; }
+
+    // returns true if the relocated bytecode is available by byteCode()
+    bool run()
+    {
+        size_t byteCodeSize = m_function->currentByteCodeSize();
+        m_isBoundary.resize(byteCodeSize + 1, false);
+
+        size_t position = 0;
+        bool fallThrough = true;
+        while (position < byteCodeSize) {
+            m_isBoundary[position] = true;
+            ByteCode* code = codeAt(position);
+            fallThrough = visitJumpOffsets(code, [](int32_t offset) { return offset; });
+            position += code->getSize();
+        }
+        m_isBoundary[byteCodeSize] = true;
+
+        // the checked copies are appended after the last code
+        if (fallThrough) {
+            return false;
+        }
+
+        for (size_t i = 0; i < m_loops.size(); i++) {
+            m_stats.m_loopCount++;
+            if (isInnermost(i)) {
+                analyze(m_loops[i].m_start, m_loops[i].m_end);
+            }
+        }
+
+        if (m_hoistedLoops.empty()) {
+            return false;
+        }
+
+        std::sort(m_hoistedLoops.begin(), m_hoistedLoops.end(), [](const HoistedLoop& a, const HoistedLoop& b) {
+            return a.m_start < b.m_start;
+        });
+        relayout();
+        m_stats.m_hoistedLoopCount += m_hoistedLoops.size();
+        return true;
+    }
+
+private:
+    struct HoistedLoop {
+        size_t m_start;
+        size_t m_end;
+        LoopBoundsCheck::Kind m_kind;
+        ByteCodeStackOffset m_base;
+        ByteCodeStackOffset m_bound;
+        uint32_t m_stride;
+        uint32_t m_accessEnd;
+        std::vector<size_t> m_accesses;
+        size_t m_checkPosition;
+    };
+
+    ByteCode* codeAt(size_t position)
+    {
+        return reinterpret_cast<ByteCode*>(m_function->byteCode() + position);
+    }
+
+    static bool overlaps(ByteCodeStackOffset def, ByteCodeStackOffset offset)
+    {
+        // an induction variable is an i32 and a def writes at most 8 bytes
+        return offset < def + 8 && def < offset + 4;
+    }
+
+    bool isInnermost(size_t index)
+    {
+        for (size_t i = 0; i < m_loops.size(); i++) {
+            if (i != index && m_loops[index].m_start <= m_loops[i].m_start && m_loops[i].m_end <= m_loops[index].m_end) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool matchCompare(BinaryCompareJump* code, ByteCode::Opcode lessOpcode, ByteCode::Opcode greaterOpcode, ByteCodeStackOffset base, ByteCodeStackOffset& bound)
+    {
+        if (code->opcode() == lessOpcode && code->srcOffset()[0] == base) {
+            bound = code->srcOffset()[1];
+            return true;
+        }
+        if (code->opcode() == greaterOpcode && code->srcOffset()[1] == base) {
+            bound = code->srcOffset()[0];
+            return true;
+        }
+        return false;
+    }
+
+    void analyze(size_t start, size_t end)
+    {
+        if (start >= end || end >= m_isBoundary.size() || !m_isBoundary[start] || !m_isBoundary[end]) {
+            return;
+        }
+
+        std::vector<size_t> positions;
+        for (size_t position = start; position < end; position += codeAt(position)->getSize()) {
+            positions.push_back(position);
+        }
+        if (positions.size() < 3) {
+            return;
+        }
+
+        // the induction variable is stepped right before the jump back
+        size_t stepPosition = positions[positions.size() - 2];
+        ByteCode* step = codeAt(stepPosition);
+        if (step->opcode() != ByteCode::I32AddImmOpcode) {
+            return;
+        }
+        BinaryImm32Operation* add = static_cast<BinaryImm32Operation*>(step);
+        if (add->srcOffset() != add->dstOffset() || add->value() == 0) {
+            return;
+        }
+
+        HoistedLoop loop;
+        loop.m_start = start;
+        loop.m_end = end;
+        loop.m_base = add->srcOffset();
+        loop.m_stride = add->value();
+        loop.m_accessEnd = 0;
+
+        size_t lastPosition = positions.back();
+        ByteCode* last = codeAt(lastPosition);
+        size_t firstAccess = 0;
+        if (last->opcode() == ByteCode::JumpOpcode) {
+            if (lastPosition + static_cast<Jump*>(last)->offset() != start) {
+                return;
+            }
+            // every iteration starts with leaving the loop unless base < bound
+            ByteCode* first = codeAt(start);
+            bool isExit = false;
+            visitJumpOffsets(first, [&](int32_t offset) {
+                size_t target = start + offset;
+                isExit = target < start || target >= end;
+                return offset;
+            });
+            if (!isExit || !isCompareJump(first)) {
+                return;
+            }
+            BinaryCompareJump* exit = static_cast<BinaryCompareJump*>(first);
+            if (!matchCompare(exit, ByteCode::I32GeUJumpIfTrueOpcode, ByteCode::I32LeUJumpIfTrueOpcode, loop.m_base, loop.m_bound)
+                && !matchCompare(exit, ByteCode::I32LtUJumpIfFalseOpcode, ByteCode::I32GtUJumpIfFalseOpcode, loop.m_base, loop.m_bound)) {
+                return;
+            }
+            loop.m_kind = LoopBoundsCheck::Below;
+            firstAccess = 1;
+        } else {
+            if (!isCompareJump(last) || lastPosition + static_cast<BinaryCompareJump*>(last)->offset() != start) {
+                return;
+            }
+            BinaryCompareJump* back = static_cast<BinaryCompareJump*>(last);
+            if (matchCompare(back, ByteCode::I32LtUJumpIfTrueOpcode, ByteCode::I32GtUJumpIfTrueOpcode, loop.m_base, loop.m_bound)) {
+                loop.m_kind = LoopBoundsCheck::LessThan;
+            } else if (matchCompare(back, ByteCode::I32LeUJumpIfTrueOpcode, ByteCode::I32GeUJumpIfTrueOpcode, loop.m_base, loop.m_bound)) {
+                loop.m_kind = LoopBoundsCheck::LessOrEqual;
+            } else if (matchCompare(back, ByteCode::I32NeJumpIfTrueOpcode, ByteCode::I32NeJumpIfTrueOpcode, loop.m_base, loop.m_bound)) {
+                loop.m_kind = LoopBoundsCheck::NotEqual;
+            } else {
+                return;
+            }
+        }
+
+        if (overlaps(loop.m_base, loop.m_bound)) {
+            return;
+        }
+
+        // the base only changes by the step and the bound never changes,
+        // so the accesses before the step see the checked values
+        for (size_t i = 0; i < positions.size(); i++) {
+            ByteCode* code = codeAt(positions[i]);
+            bool isInvariant = true;
+            auto checkDef = [&](ByteCodeStackOffset offset, bool isDef) -> ByteCodeStackOffset {
+                if (isDef && ((overlaps(offset, loop.m_base) && positions[i] != stepPosition) || overlaps(offset, loop.m_bound))) {
+                    isInvariant = false;
+                }
+                return offset;
+            };
+            if (!visitStackOffsets(code, m_result, checkDef) || !isInvariant) {
+                return;
+            }
+
+            MemoryAccess access;
+            if (i >= firstAccess && i < positions.size() - 2 && decodeMemoryAccess(code, access) && access.m_address == loop.m_base) {
+                uint64_t accessEnd = static_cast<uint64_t>(access.m_offset) + access.m_size;
+                if (accessEnd > std::numeric_limits<uint32_t>::max()) {
+                    return;
+                }
+                loop.m_accessEnd = std::max(loop.m_accessEnd, static_cast<uint32_t>(accessEnd));
+                loop.m_accesses.push_back(positions[i]);
+            }
+        }
+
+        if (!loop.m_accesses.empty()) {
+            m_hoistedLoops.push_back(loop);
+        }
+    }
+
+    static bool isCompareJump(ByteCode* code)
+    {
+#define CASE_OPCODE(name, ...) case ByteCode::name##Opcode:
+        switch (code->opcode()) {
+            FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(CASE_OPCODE)
+            return true;
+        default:
+            return false;
+        }
+#undef CASE_OPCODE
+    }
+
+    // a jump to the start of a hoisted loop enters its range check unless
+    // it comes from the loop itself
+    size_t mapTarget(size_t target, size_t source)
+    {
+        auto iter = std::lower_bound(m_hoistedLoops.begin(), m_hoistedLoops.end(), target, [](const HoistedLoop& loop, size_t position) {
+            return loop.m_start < position;
+        });
+        if (iter != m_hoistedLoops.end() && iter->m_start == target && (source < iter->m_start || source >= iter->m_end)) {
+            return iter->m_checkPosition;
+        }
+        return m_newPosition[target];
+    }
+
+    static void appendByteCode(std::vector<uint8_t>& byteCode, const void* code, size_t size)
+    {
+        const uint8_t* first = reinterpret_cast<const uint8_t*>(code);
+        byteCode.insert(byteCode.end(), first, first + size);
+    }
+
+    void relayout()
+    {
+        size_t byteCodeSize = m_function->currentByteCodeSize();
+        std::vector<uint8_t>& byteCode = m_byteCode;
+        byteCode.reserve(byteCodeSize * 2);
+        m_newPosition.resize(byteCodeSize + 1, 0);
+
+        std::vector<size_t> positions;
+        size_t nextLoop = 0;
+        for (size_t position = 0; position < byteCodeSize; position += codeAt(position)->getSize()) {
+            if (nextLoop < m_hoistedLoops.size() && m_hoistedLoops[nextLoop].m_start == position) {
+                HoistedLoop& loop = m_hoistedLoops[nextLoop++];
+                loop.m_checkPosition = byteCode.size();
+                LoopBoundsCheck check(loop.m_kind, loop.m_base, loop.m_bound, loop.m_stride, loop.m_accessEnd);
+                appendByteCode(byteCode, &check, sizeof(LoopBoundsCheck));
+            }
+            m_newPosition[position] = byteCode.size();
+            appendByteCode(byteCode, codeAt(position), codeAt(position)->getSize());
+            positions.push_back(position);
+        }
+        m_newPosition[byteCodeSize] = byteCode.size();
+
+        for (size_t position : positions) {
+            size_t newPosition = m_newPosition[position];
+            visitJumpOffsets(reinterpret_cast<ByteCode*>(byteCode.data() + newPosition), [&](int32_t offset) {
+                return static_cast<int32_t>(mapTarget(position + offset, position) - newPosition);
+            });
+        }
+
+        for (auto& loop : m_hoistedLoops) {
+            size_t copyPosition = byteCode.size();
+            appendByteCode(byteCode, codeAt(loop.m_start), loop.m_end - loop.m_start);
+            for (size_t position = loop.m_start; position < loop.m_end; position += codeAt(position)->getSize()) {
+                size_t newPosition = copyPosition + position - loop.m_start;
+                visitJumpOffsets(reinterpret_cast<ByteCode*>(byteCode.data() + newPosition), [&](int32_t offset) {
+                    size_t target = position + offset;
+                    if (target >= loop.m_start && target < loop.m_end) {
+                        return offset;
+                    }
+                    return static_cast<int32_t>(mapTarget(target, position) - newPosition);
+                });
+            }
+            Jump exit(static_cast<int32_t>(mapTarget(loop.m_end, loop.m_end) - byteCode.size()));
+            appendByteCode(byteCode, &exit, sizeof(Jump));
+
+            reinterpret_cast<LoopBoundsCheck*>(byteCode.data() + loop.m_checkPosition)->setOffset(copyPosition - loop.m_checkPosition);
+            for (size_t position : loop.m_accesses) {
+                makeUnchecked(reinterpret_cast<ByteCode*>(byteCode.data() + m_newPosition[position]));
+            }
+        }
+    }
+
+    ModuleFunction* m_function;
+    const LoopInfoVector& m_loops;
+    const WASMParsingResult& m_result;
+    BoundsCheckEliminator::Statistics& m_stats;
+    std::vector<bool> m_isBoundary;
+    std::vector<HoistedLoop> m_hoistedLoops;
+    std::vector<size_t> m_newPosition;
+    std::vector<uint8_t> m_byteCode;
+};
+
+void BoundsCheckEliminator::hoistLoopChecks(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats)
+{
+    // the checked copy of a loop would be outside of its try range
+    if (!result.m_memoryTypes.empty() && function->currentByteCodeSize() && function->m_catchInfo.empty()) {
+        FunctionLoopCheckHoister hoister(function, function->m_loopInfo, result, stats);
+        if (hoister.run()) {
+            const std::vector<uint8_t>& byteCode = hoister.byteCode();
+            function->m_byteCode.resizeWithUninitializedValues(byteCode.size());
+            memcpy(function->byteCode(), byteCode.data(), byteCode.size());
+        }
+    }
+    function->m_loopInfo.clear();
+}
+
+void BoundsCheckEliminator::eliminate(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats)
+{
+    if (result.m_memoryTypes.empty() || !function->currentByteCodeSize()) {
+        return;
+    }
+
+    FunctionBoundsCheckEliminator eliminator(function, result, stats);
+    eliminator.run();
+}
+
+} // namespace Walrus
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusBoundsCheckEliminator__
+#define __WalrusBoundsCheckEliminator__
+
+namespace Walrus {
+
+class ModuleFunction;
+struct WASMParsingResult;
+
+// Replaces memory accesses whose range is proven in bounds with unchecked
+// accesses. The memory never shrinks, so an access covered by a passed
+// check or by the minimum memory size cannot be out of bounds.
+class BoundsCheckEliminator {
+public:
+    struct Statistics {
+        Statistics()
+            : m_accessCount(0)
+            , m_uncheckedCount(0)
+            , m_loopCount(0)
+            , m_hoistedLoopCount(0)
+        {
+        }
+
+        void merge(const Statistics& other)
+        {
+            m_accessCount += other.m_accessCount;
+            m_uncheckedCount += other.m_uncheckedCount;
+            m_loopCount += other.m_loopCount;
+            m_hoistedLoopCount += other.m_hoistedLoopCount;
+        }
+
+        size_t m_accessCount;
+        size_t m_uncheckedCount;
+        size_t m_loopCount;
+        size_t m_hoistedLoopCount;
+    };
+
+    // Replaces the checks of innermost loops stepping an induction variable
+    // towards a loop invariant bound with one range check before the loop.
+    // The loop body is copied to the end of the function, and the range
+    // check jumps to this checked copy when it fails.
+    static void hoistLoopChecks(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats);
+
+    // Removes the checks already proven by an earlier check in the same
+    // basic block.
+    static void eliminate(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats);
+};
+
+} // namespace Walrus
+
+#endif // __WalrusBoundsCheckEliminator__
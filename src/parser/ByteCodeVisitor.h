@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusByteCodeVisitor__
+#define __WalrusByteCodeVisitor__
+
+#include "parser/WASMParser.h"
+#include "interpreter/ByteCode.h"
+#include "runtime/Module.h"
+
+// Operand and jump decoding of the generated bytecode, shared by the
+// passes which run over a function after its bytecode is generated.
+
+namespace Walrus {
+
+// every temporary slot holds one value of valueSizeInStack() bytes
+static const size_t s_slotSize = sizeof(size_t);
+
+template <typename CodeType, typename Visitor>
+static void visitDst(ByteCode* code, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    c->setDstOffset(visitor(c->dstOffset(), true));
+}
+
+template <typename CodeType, typename Visitor>
+static void visitSrc(ByteCode* code, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    c->setSrcOffset(visitor(c->srcOffset(), false));
+}
+
+template <typename CodeType, typename Visitor>
+static void visitSrcDst(ByteCode* code, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    c->setSrcOffset(visitor(c->srcOffset(), false));
+    c->setDstOffset(visitor(c->dstOffset(), true));
+}
+
+template <typename CodeType, typename Visitor>
+static void visitSrc0Src1(ByteCode* code, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    c->setSrc0Offset(visitor(c->src0Offset(), false));
+    c->setSrc1Offset(visitor(c->src1Offset(), false));
+}
+
+template <typename CodeType, typename Visitor>
+static void visitSrcArray(ByteCode* code, size_t size, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    for (size_t i = 0; i < size; i++) {
+        c->setSrcOffset(i, visitor(c->srcOffset()[i], false));
+    }
+}
+
+template <typename CodeType, typename Visitor>
+static void visitSrcOffsets(ByteCode* code, Visitor& visitor)
+{
+    CodeType* c = static_cast<CodeType*>(code);
+    for (size_t i = 0; i < 3; i++) {
+        c->setSrcOffset(i, visitor(c->srcOffsets()[i], false));
+    }
+}
+
+template <typename Visitor>
+static void visitCallOffsets(ByteCodeStackOffset* offsets, size_t paramSize, size_t resultSize, Visitor& visitor)
+{
+    for (size_t i = 0; i < paramSize; i++) {
+        offsets[i] = visitor(offsets[i], false);
+    }
+    for (size_t i = paramSize; i < paramSize + resultSize; i++) {
+        offsets[i] = visitor(offsets[i], true);
+    }
+}
+
+// Calls visitor(offset, isDef) for every stack offset operand of the code
+// and replaces the operand with the returned offset. Returns false if an
+// operand does not fit into a single slot.
+template <typename Visitor>
+static bool visitStackOffsets(ByteCode* code, const WASMParsingResult& result, Visitor& visitor)
+{
+#define CASE_OPCODE(name, ...) case ByteCode::name##Opcode:
+
+    switch (code->opcode()) {
+    case ByteCode::Const32Opcode:
+        visitDst<Const32>(code, visitor);
+        break;
+    case ByteCode::Const64Opcode:
+        visitDst<Const64>(code, visitor);
+        break;
+    case ByteCode::GlobalGet32Opcode:
+        visitDst<GlobalGet32>(code, visitor);
+        break;
+    case ByteCode::GlobalGet64Opcode:
+        visitDst<GlobalGet64>(code, visitor);
+        break;
+    case ByteCode::MemorySizeOpcode:
+        visitDst<MemorySize>(code, visitor);
+        break;
+    case ByteCode::TableSizeOpcode:
+        visitDst<TableSize>(code, visitor);
+        break;
+    case ByteCode::RefFuncOpcode:
+        visitDst<RefFunc>(code, visitor);
+        break;
+    case ByteCode::GlobalSet32Opcode:
+        visitSrc<GlobalSet32>(code, visitor);
+        break;
+    case ByteCode::GlobalSet64Opcode:
+        visitSrc<GlobalSet64>(code, visitor);
+        break;
+    case ByteCode::JumpIfTrueOpcode:
+        visitSrc<JumpIfTrue>(code, visitor);
+        break;
+    case ByteCode::JumpIfFalseOpcode:
+        visitSrc<JumpIfFalse>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(CASE_OPCODE)
+        visitSrc<UnaryCompareJump>(code, visitor);
+        break;
+    case ByteCode::Move32Opcode:
+        visitSrcDst<Move32>(code, visitor);
+        break;
+    case ByteCode::Move64Opcode:
+        visitSrcDst<Move64>(code, visitor);
+        break;
+    case ByteCode::Load32Opcode:
+        visitSrcDst<Load32>(code, visitor);
+        break;
+    case ByteCode::Load32UncheckedOpcode:
+        visitSrcDst<Load32Unchecked>(code, visitor);
+        break;
+    case ByteCode::Load64Opcode:
+        visitSrcDst<Load64>(code, visitor);
+        break;
+    case ByteCode::Load64UncheckedOpcode:
+        visitSrcDst<Load64Unchecked>(code, visitor);
+        break;
+    case ByteCode::MemoryGrowOpcode:
+        visitSrcDst<MemoryGrow>(code, visitor);
+        break;
+    case ByteCode::TableGetOpcode:
+        visitSrcDst<TableGet>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_UNARY_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_UNARY_OP_2(CASE_OPCODE)
+        visitSrcDst<UnaryOperation>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_BINARY_IMM32_OP(CASE_OPCODE)
+        visitSrcDst<BinaryImm32Operation>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_BINARY_IMM64_OP(CASE_OPCODE)
+        visitSrcDst<BinaryImm64Operation>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_LOAD_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_LOAD_UNCHECKED_OP(CASE_OPCODE)
+        visitSrcDst<MemoryLoad>(code, visitor);
+        break;
+    case ByteCode::Store32Opcode:
+        visitSrc0Src1<Store32>(code, visitor);
+        break;
+    case ByteCode::Store32UncheckedOpcode:
+        visitSrc0Src1<Store32Unchecked>(code, visitor);
+        break;
+    case ByteCode::Store64Opcode:
+        visitSrc0Src1<Store64>(code, visitor);
+        break;
+    case ByteCode::Store64UncheckedOpcode:
+        visitSrc0Src1<Store64Unchecked>(code, visitor);
+        break;
+    case ByteCode::TableSetOpcode:
+        visitSrc0Src1<TableSet>(code, visitor);
+        break;
+    case ByteCode::LoopBoundsCheckOpcode: {
+        LoopBoundsCheck* check = static_cast<LoopBoundsCheck*>(code);
+        check->setBaseOffset(visitor(check->baseOffset(), false));
+        check->setBoundOffset(visitor(check->boundOffset(), false));
+        break;
+    }
+        FOR_EACH_BYTECODE_STORE_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(CASE_OPCODE)
+        FOR_EACH_BYTECODE_STORE_UNCHECKED_OP(CASE_OPCODE)
+        visitSrc0Src1<MemoryStore>(code, visitor);
+        break;
+    case ByteCode::TableGrowOpcode:
+        visitSrc0Src1<TableGrow>(code, visitor);
+        visitDst<TableGrow>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_BINARY_OP(CASE_OPCODE)
+        visitSrcArray<BinaryOperation>(code, 2, visitor);
+        visitDst<BinaryOperation>(code, visitor);
+        break;
+        FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(CASE_OPCODE)
+        visitSrcArray<BinaryCompareJump>(code, 2, visitor);
+        break;
+    case ByteCode::MemoryInitOpcode:
+        visitSrcOffsets<MemoryInit>(code, visitor);
+        break;
+    case ByteCode::MemoryCopyOpcode:
+        visitSrcOffsets<MemoryCopy>(code, visitor);
+        break;
+    case ByteCode::MemoryFillOpcode:
+        visitSrcOffsets<MemoryFill>(code, visitor);
+        break;
+    case ByteCode::TableInitOpcode:
+        visitSrcOffsets<TableInit>(code, visitor);
+        break;
+    case ByteCode::TableCopyOpcode:
+        visitSrcOffsets<TableCopy>(code, visitor);
+        break;
+    case ByteCode::TableFillOpcode:
+        visitSrcOffsets<TableFill>(code, visitor);
+        break;
+    case ByteCode::SelectOpcode: {
+        Select* select = static_cast<Select*>(code);
+        if (select->valueSize() > s_slotSize) {
+            return false;
+        }
+        select->setCondOffset(visitor(select->condOffset(), false));
+        visitSrc0Src1<Select>(code, visitor);
+        visitDst<Select>(code, visitor);
+        break;
+    }
+    case ByteCode::BrTableOpcode: {
+        BrTable* brTable = static_cast<BrTable*>(code);
+        brTable->setCondOffset(visitor(brTable->condOffset(), false));
+        break;
+    }
+    case ByteCode::CallOpcode: {
+        Call* call = static_cast<Call*>(code);
+        size_t paramSize = result.m_functions[call->index()]->functionType()->param().size();
+        visitCallOffsets(call->stackOffsets(), paramSize, call->offsetsSize() - paramSize, visitor);
+        break;
+    }
+    case ByteCode::CallIndirectOpcode: {
+        CallIndirect* call = static_cast<CallIndirect*>(code);
+        call->setCalleeOffset(visitor(call->calleeOffset(), false));
+        visitCallOffsets(call->stackOffsets(), call->functionType()->param().size(), call->functionType()->result().size(), visitor);
+        break;
+    }
+    case ByteCode::ThrowOpcode: {
+        Throw* throwCode = static_cast<Throw*>(code);
+        visitCallOffsets(throwCode->dataOffsets(), throwCode->offsetsSize(), 0, visitor);
+        break;
+    }
+    case ByteCode::EndOpcode: {
+        End* end = static_cast<End*>(code);
+        visitCallOffsets(end->resultOffsets(), end->offsetsSize(), 0, visitor);
+        break;
+    }
+    case ByteCode::UnreachableOpcode:
+    case ByteCode::JumpOpcode:
+    case ByteCode::DataDropOpcode:
+    case ByteCode::ElemDropOpcode:
+    case ByteCode::FillOpcodeTableOpcode:
+        break;
+    default:
+        RELEASE_ASSERT_NOT_REACHED();
+        break;
+    }
+
+#undef CASE_OPCODE
+    return true;
+}
+
+// Calls visitor(offset) for every jump offset of the code and replaces
+// the offset with its result, the offsets are relative to the position
+// of the code. Returns false if the execution never continues with the
+// next code.
+template <typename Visitor>
+static bool visitJumpOffsets(ByteCode* code, Visitor visitor)
+{
+#define CASE_OPCODE(name, ...) case ByteCode::name##Opcode:
+
+    switch (code->opcode()) {
+    case ByteCode::JumpOpcode:
+        static_cast<Jump*>(code)->setOffset(visitor(static_cast<Jump*>(code)->offset()));
+        return false;
+    case ByteCode::JumpIfTrueOpcode:
+        static_cast<JumpIfTrue*>(code)->setOffset(visitor(static_cast<JumpIfTrue*>(code)->offset()));
+        return true;
+    case ByteCode::JumpIfFalseOpcode:
+        static_cast<JumpIfFalse*>(code)->setOffset(visitor(static_cast<JumpIfFalse*>(code)->offset()));
+        return true;
+    case ByteCode::LoopBoundsCheckOpcode:
+        static_cast<LoopBoundsCheck*>(code)->setOffset(visitor(static_cast<LoopBoundsCheck*>(code)->offset()));
+        return true;
+        FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(CASE_OPCODE)
+        static_cast<BinaryCompareJump*>(code)->setOffset(visitor(static_cast<BinaryCompareJump*>(code)->offset()));
+        return true;
+        FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(CASE_OPCODE)
+        static_cast<UnaryCompareJump*>(code)->setOffset(visitor(static_cast<UnaryCompareJump*>(code)->offset()));
+        return true;
+    case ByteCode::BrTableOpcode: {
+        BrTable* brTable = static_cast<BrTable*>(code);
+        brTable->setDefaultOffset(visitor(brTable->defaultOffset()));
+        for (uint32_t i = 0; i < brTable->tableSize(); i++) {
+            brTable->jumpOffsets()[i] = visitor(brTable->jumpOffsets()[i]);
+        }
+        return false;
+    }
+    case ByteCode::EndOpcode:
+    case ByteCode::ThrowOpcode:
+    case ByteCode::UnreachableOpcode:
+        return false;
+    default:
+        return true;
+    }
+
+#undef CASE_OPCODE
+}
+
+} // namespace Walrus
+
+#endif // __WalrusByteCodeVisitor__
@@ -0,0 +1,816 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "parser/DirectReferenceScanner.h"
+
+#include "wabt/walrus/binary-reader-walrus.h"
+
+namespace wabt {
+
+// The scan mirrors the value stack handling of WASMBinaryReader in
+// WASMParser.cpp. It only tracks which local a value was read from and
+// whether the value still refers to the local itself, and takes the
+// conservative side where the generator decides on stack offsets.
+class WASMDirectReferenceScanner : public WASMBinaryReaderDelegate {
+private:
+    enum class ScannedOpcode : uint32_t {
+#define WABT_OPCODE(rtype, type1, type2, type3, memSize, prefix, code, name, \
+                    text, decomp)                                            \
+    name##Opcode,
+#include "parser/opcode.def"
+#undef WABT_OPCODE
+    };
+
+    struct StackValue {
+        Index m_localIndex;
+        // the value is the local itself, not a copy of it
+        bool m_isDirect;
+
+        StackValue()
+            : m_localIndex(kInvalidIndex)
+            , m_isDirect(false)
+        {
+        }
+
+        StackValue(Index localIndex, bool isDirect)
+            : m_localIndex(localIndex)
+            , m_isDirect(isDirect)
+        {
+        }
+    };
+
+    struct BlockInfo {
+        enum BlockType {
+            IfElse,
+            Loop,
+            Block,
+            TryCatch,
+        };
+
+        BlockType m_blockType;
+        Type m_returnValueType;
+        // like BlockInfo of WASMBinaryReader, the block shares the stack below
+        // its parameters and keeps the parameters as they were. these values
+        // keep their locals referenced until the block ends
+        size_t m_stackSize;
+        std::vector<StackValue> m_parameters;
+        std::vector<StackValue> m_savedStack;
+        bool m_isStackSaved;
+        bool m_hasParameters;
+        bool m_shouldRestoreStackAtEnd;
+        bool m_byteCodeGenerationStopped;
+        bool m_hasJumpToEnd;
+
+        size_t stackBase() const
+        {
+            return m_stackSize - m_parameters.size();
+        }
+    };
+
+    struct FunctionTypeInfo {
+        Index m_paramCount;
+        Index m_resultCount;
+    };
+
+    std::vector<Walrus::DirectReferenceScanner::UpdatedLocal>& m_updatedLocals;
+
+    std::vector<FunctionTypeInfo> m_functionTypes;
+    std::vector<Index> m_functionTypeIndexes;
+    std::vector<Index> m_tagTypeIndexes;
+
+    Index m_currentFunctionIndex;
+    std::vector<StackValue> m_stack;
+    std::vector<BlockInfo> m_blockInfo;
+    size_t m_parameterBlockCount;
+    // number of stack values, saved ones included, read from each local
+    std::vector<size_t> m_localRefCount;
+    std::vector<bool> m_localUpdated;
+
+    // WASMBinaryReader::omitUpdateLocalValueIfPossible can store the
+    // result of the previous instruction into the local directly
+    bool m_lastOpcodeCanStoreToLocal;
+    bool m_nextOpcodeCanStoreToLocal;
+    bool m_lastCodeIsRefNull;
+
+    FunctionTypeInfo functionTypeInfo(Index typeIndex)
+    {
+        if (typeIndex < m_functionTypes.size()) {
+            return m_functionTypes[typeIndex];
+        }
+        return { 0, 0 };
+    }
+
+    FunctionTypeInfo blockTypeInfo(Type type)
+    {
+        if (type.IsIndex()) {
+            return functionTypeInfo(type.GetIndex());
+        }
+        return { 0, type == Type::Void ? 0u : 1u };
+    }
+
+    FunctionTypeInfo functionInfo(Index functionIndex)
+    {
+        if (functionIndex < m_functionTypeIndexes.size()) {
+            return functionTypeInfo(m_functionTypeIndexes[functionIndex]);
+        }
+        return { 0, 0 };
+    }
+
+    FunctionTypeInfo tagInfo(Index tagIndex)
+    {
+        if (tagIndex < m_tagTypeIndexes.size()) {
+            return functionTypeInfo(m_tagTypeIndexes[tagIndex]);
+        }
+        return { 0, 0 };
+    }
+
+    bool isValidLocal(Index localIndex)
+    {
+        return localIndex < m_localRefCount.size();
+    }
+
+    void reference(const StackValue& value)
+    {
+        if (isValidLocal(value.m_localIndex)) {
+            m_localRefCount[value.m_localIndex]++;
+        }
+    }
+
+    void dereference(const StackValue& value)
+    {
+        if (isValidLocal(value.m_localIndex)) {
+            m_localRefCount[value.m_localIndex]--;
+        }
+    }
+
+    void push(const StackValue& value)
+    {
+        reference(value);
+        m_stack.push_back(value);
+    }
+
+    void push(size_t count)
+    {
+        m_stack.resize(m_stack.size() + count);
+    }
+
+    void saveStackOfBlocksIfNeeds(size_t newSize)
+    {
+        for (auto iter = m_blockInfo.rbegin(); iter != m_blockInfo.rend(); iter++) {
+            if (iter->m_isStackSaved) {
+                continue;
+            }
+            if (iter->stackBase() <= newSize) {
+                break;
+            }
+            iter->m_savedStack.assign(m_stack.begin(), m_stack.begin() + iter->stackBase());
+            for (const auto& value : iter->m_savedStack) {
+                reference(value);
+            }
+            iter->m_savedStack.insert(iter->m_savedStack.end(), iter->m_parameters.begin(), iter->m_parameters.end());
+            iter->m_isStackSaved = true;
+        }
+    }
+
+    void pop(size_t count = 1)
+    {
+        while (count && !m_stack.empty()) {
+            if (m_blockInfo.size() && m_stack.size() <= m_blockInfo.back().stackBase()) {
+                saveStackOfBlocksIfNeeds(m_stack.size() - 1);
+            }
+            dereference(m_stack.back());
+            m_stack.pop_back();
+            count--;
+        }
+    }
+
+    void restoreStack(const BlockInfo& blockInfo)
+    {
+        if (blockInfo.m_isStackSaved) {
+            pop(m_stack.size());
+            for (const auto& value : blockInfo.m_savedStack) {
+                push(value);
+            }
+        } else {
+            pop(m_stack.size() - blockInfo.stackBase());
+            for (const auto& value : blockInfo.m_parameters) {
+                push(value);
+            }
+        }
+    }
+
+    void beginBlock(BlockInfo::BlockType blockType, Type returnValueType)
+    {
+        m_blockInfo.push_back(BlockInfo());
+        BlockInfo& blockInfo = m_blockInfo.back();
+        blockInfo.m_blockType = blockType;
+        blockInfo.m_returnValueType = returnValueType;
+        blockInfo.m_stackSize = m_stack.size();
+        blockInfo.m_isStackSaved = false;
+        blockInfo.m_hasParameters = false;
+        blockInfo.m_shouldRestoreStackAtEnd = false;
+        blockInfo.m_byteCodeGenerationStopped = false;
+        // the jump of if is resolved at the end of the block
+        blockInfo.m_hasJumpToEnd = blockType == BlockInfo::IfElse;
+
+        Index paramCount = blockTypeInfo(returnValueType).m_paramCount;
+        if (paramCount) {
+            // parameters are moved into general registers
+            blockInfo.m_hasParameters = true;
+            m_parameterBlockCount++;
+            blockInfo.m_parameters.assign(m_stack.end() - std::min<size_t>(paramCount, m_stack.size()), m_stack.end());
+            for (const auto& value : blockInfo.m_parameters) {
+                reference(value);
+            }
+            for (size_t i = 0; i < paramCount && i < m_stack.size(); i++) {
+                (m_stack.rbegin() + i)->m_isDirect = false;
+            }
+        }
+    }
+
+    void endBlock(BlockInfo& blockInfo)
+    {
+        for (const auto& value : blockInfo.m_isStackSaved ? blockInfo.m_savedStack : blockInfo.m_parameters) {
+            dereference(value);
+        }
+        if (blockInfo.m_hasParameters) {
+            m_parameterBlockCount--;
+        }
+    }
+
+    void markJumpToEnd(Index depth)
+    {
+        if (depth < m_blockInfo.size()) {
+            BlockInfo& blockInfo = *(m_blockInfo.rbegin() + depth);
+            if (blockInfo.m_blockType == BlockInfo::Block || blockInfo.m_blockType == BlockInfo::IfElse) {
+                blockInfo.m_hasJumpToEnd = true;
+            }
+        }
+    }
+
+    void stopToScanWhileBlockEnd()
+    {
+        if (m_resumeGenerateByteCodeAfterNBlockEnd) {
+            return;
+        }
+
+        if (m_blockInfo.size()) {
+            m_resumeGenerateByteCodeAfterNBlockEnd = 1;
+            m_blockInfo.back().m_shouldRestoreStackAtEnd = true;
+            m_blockInfo.back().m_byteCodeGenerationStopped = true;
+        }
+        m_shouldContinueToGenerateByteCode = false;
+    }
+
+    void stopToScanFunction()
+    {
+        m_shouldContinueToGenerateByteCode = false;
+        m_resumeGenerateByteCodeAfterNBlockEnd = 0;
+    }
+
+    void beginSubBlock()
+    {
+        BlockInfo& blockInfo = m_blockInfo.back();
+        if (blockInfo.m_returnValueType != Type::Void) {
+            blockInfo.m_shouldRestoreStackAtEnd = true;
+        }
+        // without results the stack is back to the state before the block
+        if (blockInfo.m_shouldRestoreStackAtEnd) {
+            restoreStack(blockInfo);
+        }
+    }
+
+    void markUpdated(Index localIndex)
+    {
+        m_localUpdated[localIndex] = true;
+        m_updatedLocals.push_back({ m_currentFunctionIndex, localIndex });
+    }
+
+    // the bytecode of these instructions always ends with a new code
+    static bool isCodeGeneratingOpcode(ScannedOpcode opcode)
+    {
+        switch (opcode) {
+        case ScannedOpcode::LocalGetOpcode:
+        case ScannedOpcode::LocalSetOpcode:
+        case ScannedOpcode::LocalTeeOpcode:
+        case ScannedOpcode::DropOpcode:
+        case ScannedOpcode::NopOpcode:
+        case ScannedOpcode::BlockOpcode:
+        case ScannedOpcode::LoopOpcode:
+        case ScannedOpcode::TryOpcode:
+        case ScannedOpcode::EndOpcode:
+        case ScannedOpcode::RefNullOpcode:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+public:
+    WASMDirectReferenceScanner(std::vector<Walrus::DirectReferenceScanner::UpdatedLocal>& updatedLocals)
+        : m_updatedLocals(updatedLocals)
+        , m_currentFunctionIndex(0)
+        , m_parameterBlockCount(0)
+        , m_lastOpcodeCanStoreToLocal(false)
+        , m_nextOpcodeCanStoreToLocal(false)
+        , m_lastCodeIsRefNull(false)
+    {
+    }
+
+    virtual void OnSetOffsetAddress(size_t* ptr) override {}
+
+    virtual void BeginModule(uint32_t version) override {}
+    virtual void EndModule() override {}
+
+    virtual void OnTypeCount(Index count) override
+    {
+        m_functionTypes.reserve(count);
+    }
+
+    virtual void OnFuncType(Index index, Index paramCount, Type* paramTypes, Index resultCount, Type* resultTypes) override
+    {
+        m_functionTypes.push_back({ paramCount, resultCount });
+    }
+
+    virtual void OnImportCount(Index count) override {}
+
+    virtual void OnImportFunc(Index importIndex, std::string moduleName, std::string fieldName, Index funcIndex, Index sigIndex) override
+    {
+        m_functionTypeIndexes.push_back(sigIndex);
+    }
+
+    virtual void OnImportGlobal(Index importIndex, std::string moduleName, std::string fieldName, Index globalIndex, Type type, bool mutable_) override {}
+    virtual void OnImportTable(Index importIndex, std::string moduleName, std::string fieldName, Index tableIndex, Type type, size_t initialSize, size_t maximumSize) override {}
+    virtual void OnImportMemory(Index importIndex, std::string moduleName, std::string fieldName, Index memoryIndex, size_t initialSize, size_t maximumSize) override {}
+
+    virtual void OnImportTag(Index importIndex, std::string moduleName, std::string fieldName, Index tagIndex, Index sigIndex) override
+    {
+        m_tagTypeIndexes.push_back(sigIndex);
+    }
+
+    virtual void OnExportCount(Index count) override {}
+    virtual void OnExport(int kind, Index exportIndex, std::string name, Index itemIndex) override {}
+
+    virtual void OnMemoryCount(Index count) override {}
+    virtual void OnMemory(Index index, size_t initialSize, size_t maximumSize) override {}
+
+    virtual void OnDataSegmentCount(Index count) override {}
+    virtual void BeginDataSegment(Index index, Index memoryIndex, uint8_t flags) override {}
+    virtual void BeginDataSegmentInitExpr(Index index) override {}
+    virtual void EndDataSegmentInitExpr(Index index) override {}
+    virtual void OnDataSegmentData(Index index, const void* data, Address size) override {}
+    virtual void EndDataSegment(Index index) override {}
+
+    virtual void OnTableCount(Index count) override {}
+    virtual void OnTable(Index index, Type type, size_t initialSize, size_t maximumSize) override {}
+
+    virtual void OnElemSegmentCount(Index count) override {}
+    virtual void BeginElemSegment(Index index, Index tableIndex, uint8_t flags) override {}
+    virtual void BeginElemSegmentInitExpr(Index index) override {}
+    virtual void EndElemSegmentInitExpr(Index index) override {}
+    virtual void OnElemSegmentElemType(Index index, Type elemType) override {}
+    virtual void OnElemSegmentElemExprCount(Index index, Index count) override {}
+    virtual void OnElemSegmentElemExpr_RefNull(Index segmentIndex, Type type) override {}
+    virtual void OnElemSegmentElemExpr_RefFunc(Index segmentIndex, Index funcIndex) override {}
+    virtual void EndElemSegment(Index index) override {}
+
+    virtual void OnFunctionCount(Index count) override
+    {
+        m_functionTypeIndexes.reserve(m_functionTypeIndexes.size() + count);
+    }
+
+    virtual void OnFunction(Index index, Index sigIndex) override
+    {
+        m_functionTypeIndexes.push_back(sigIndex);
+    }
+
+    virtual void OnGlobalCount(Index count) override {}
+    virtual void BeginGlobal(Index index, Type type, bool mutable_) override {}
+    virtual void BeginGlobalInitExpr(Index index) override {}
+    virtual void EndGlobalInitExpr(Index index) override {}
+    virtual void EndGlobal(Index index) override {}
+    virtual void EndGlobalSection() override {}
+
+    virtual void OnTagCount(Index count) override {}
+
+    virtual void OnTagType(Index index, Index sigIndex) override
+    {
+        m_tagTypeIndexes.push_back(sigIndex);
+    }
+
+    virtual void OnStartFunction(Index funcIndex) override {}
+
+    virtual void BeginFunctionBody(Index index, Offset size) override
+    {
+        m_currentFunctionIndex = index;
+        m_stack.clear();
+        m_blockInfo.clear();
+        m_parameterBlockCount = 0;
+        m_localRefCount.assign(functionInfo(index).m_paramCount, 0);
+        m_localUpdated.assign(m_localRefCount.size(), false);
+        m_lastOpcodeCanStoreToLocal = m_nextOpcodeCanStoreToLocal = m_lastCodeIsRefNull = false;
+    }
+
+    virtual void OnLocalDeclCount(Index count) override {}
+
+    virtual void OnLocalDecl(Index decl_index, Index count, Type type) override
+    {
+        m_localRefCount.resize(m_localRefCount.size() + count, 0);
+        m_localUpdated.resize(m_localRefCount.size(), false);
+    }
+
+    virtual void OnStartReadInstructions() override {}
+
+    virtual void OnOpcode(uint32_t opcode) override
+    {
+        m_lastOpcodeCanStoreToLocal = m_nextOpcodeCanStoreToLocal;
+        m_nextOpcodeCanStoreToLocal = false;
+        if (isCodeGeneratingOpcode(static_cast<ScannedOpcode>(opcode))) {
+            m_lastCodeIsRefNull = false;
+        }
+    }
+
+    virtual void OnCallExpr(Index index) override
+    {
+        FunctionTypeInfo info = functionInfo(index);
+        pop(info.m_paramCount);
+        push(info.m_resultCount);
+    }
+
+    virtual void OnCallIndirectExpr(Index sigIndex, Index tableIndex) override
+    {
+        FunctionTypeInfo info = functionTypeInfo(sigIndex);
+        pop(info.m_paramCount + 1);
+        push(info.m_resultCount);
+    }
+
+    virtual void OnI32ConstExpr(uint32_t value) override
+    {
+        push(1);
+        m_nextOpcodeCanStoreToLocal = true;
+    }
+
+    virtual void OnI64ConstExpr(uint64_t value) override
+    {
+        push(1);
+        m_nextOpcodeCanStoreToLocal = true;
+    }
+
+    virtual void OnF32ConstExpr(uint32_t value) override
+    {
+        push(1);
+        m_nextOpcodeCanStoreToLocal = true;
+    }
+
+    virtual void OnF64ConstExpr(uint64_t value) override
+    {
+        push(1);
+        m_nextOpcodeCanStoreToLocal = true;
+    }
+
+    virtual void OnLocalGetExpr(Index localIndex) override
+    {
+        if (!isValidLocal(localIndex)) {
+            push(1);
+            return;
+        }
+        // inside a block with parameters the stack offset decides, so
+        // assume a copy of the local
+        push(StackValue(localIndex, !m_localUpdated[localIndex] && !m_parameterBlockCount));
+    }
+
+    virtual void OnLocalSetExpr(Index localIndex) override
+    {
+        if (isValidLocal(localIndex) && m_localRefCount[localIndex] && !m_localUpdated[localIndex]) {
+            // (local.get 0) (local.set 0) is the only case which keeps
+            // the direct reference
+            if (m_stack.empty() || m_stack.back().m_localIndex != localIndex || !m_stack.back().m_isDirect) {
+                markUpdated(localIndex);
+            }
+        }
+        pop();
+    }
+
+    virtual void OnLocalTeeExpr(Index localIndex) override
+    {
+        if (!isValidLocal(localIndex) || m_stack.empty()) {
+            return;
+        }
+        if (m_localUpdated[localIndex]) {
+            return;
+        }
+        if (m_localRefCount[localIndex]) {
+            markUpdated(localIndex);
+            return;
+        }
+        // the result of the previous instruction may be stored into the
+        // local directly, which makes the value a direct reference
+        if (!isValidLocal(m_stack.back().m_localIndex) && (m_lastOpcodeCanStoreToLocal || m_lastCodeIsRefNull)) {
+            pop();
+            push(StackValue(localIndex, true));
+        }
+    }
+
+    virtual void OnGlobalGetExpr(Index globalIndex) override
+    {
+        push(1);
+    }
+
+    virtual void OnGlobalSetExpr(Index globalIndex) override
+    {
+        pop();
+    }
+
+    virtual void OnDropExpr() override
+    {
+        pop();
+    }
+
+    virtual void OnBinaryExpr(uint32_t opcode) override
+    {
+        pop(2);
+        push(1);
+        m_nextOpcodeCanStoreToLocal = true;
+    }
+
+    virtual void OnUnaryExpr(uint32_t opcode) override
+    {
+        pop();
+        push(1);
+    }
+
+    virtual void OnIfExpr(Type sigType) override
+    {
+        pop();
+        beginBlock(BlockInfo::IfElse, sigType);
+    }
+
+    virtual void OnElseExpr() override
+    {
+        beginSubBlock();
+    }
+
+    virtual void OnLoopExpr(Type sigType) override
+    {
+        beginBlock(BlockInfo::Loop, sigType);
+    }
+
+    virtual void OnBlockExpr(Type sigType) override
+    {
+        beginBlock(BlockInfo::Block, sigType);
+    }
+
+    virtual void OnBrExpr(Index depth) override
+    {
+        if (m_blockInfo.size() == depth) {
+            // this case acts like return, but only drops the values
+            if (m_blockInfo.size()) {
+                pop(m_stack.size() - std::min(m_stack.size(), m_blockInfo.front().m_stackSize));
+            } else {
+                stopToScanFunction();
+            }
+            return;
+        }
+        markJumpToEnd(depth);
+        stopToScanWhileBlockEnd();
+    }
+
+    virtual void OnBrIfExpr(Index depth) override
+    {
+        pop();
+        markJumpToEnd(depth);
+    }
+
+    virtual void OnBrTableExpr(Index numTargets, Index* targetDepths, Index defaultTargetDepth) override
+    {
+        pop();
+        for (Index i = 0; i < numTargets; i++) {
+            markJumpToEnd(targetDepths[i]);
+        }
+        markJumpToEnd(defaultTargetDepth);
+        stopToScanWhileBlockEnd();
+    }
+
+    virtual void OnSelectExpr(Index resultCount, Type* resultTypes) override
+    {
+        pop(3);
+        push(1);
+    }
+
+    virtual void OnThrowExpr(Index tagIndex) override
+    {
+        pop(tagInfo(tagIndex).m_paramCount);
+        stopToScanWhileBlockEnd();
+    }
+
+    virtual void OnTryExpr(Type sigType) override
+    {
+        beginBlock(BlockInfo::TryCatch, sigType);
+    }
+
+    virtual void OnCatchExpr(Index tagIndex) override
+    {
+        beginSubBlock();
+        push(tagInfo(tagIndex).m_paramCount);
+    }
+
+    virtual void OnCatchAllExpr() override
+    {
+        beginSubBlock();
+    }
+
+    virtual void OnMemoryGrowExpr(Index memidx) override
+    {
+        pop();
+        push(1);
+    }
+
+    virtual void OnMemoryInitExpr(Index segmentIndex, Index memidx) override
+    {
+        pop(3);
+    }
+
+    virtual void OnMemoryCopyExpr(Index srcMemIndex, Index dstMemIndex) override
+    {
+        pop(3);
+    }
+
+    virtual void OnMemoryFillExpr(Index memidx) override
+    {
+        pop(3);
+    }
+
+    virtual void OnDataDropExpr(Index segmentIndex) override {}
+
+    virtual void OnMemorySizeExpr(Index memidx) override
+    {
+        push(1);
+    }
+
+    virtual void OnTableGetExpr(Index tableIndex) override
+    {
+        pop();
+        push(1);
+    }
+
+    virtual void OnTableSetExpr(Index tableIndex) override
+    {
+        pop(2);
+    }
+
+    virtual void OnTableGrowExpr(Index tableIndex) override
+    {
+        pop(2);
+        push(1);
+    }
+
+    virtual void OnTableSizeExpr(Index tableIndex) override
+    {
+        push(1);
+    }
+
+    virtual void OnTableCopyExpr(Index dstIndex, Index srcIndex) override
+    {
+        pop(3);
+    }
+
+    virtual void OnTableFillExpr(Index tableIndex) override
+    {
+        pop(3);
+    }
+
+    virtual void OnElemDropExpr(Index segmentIndex) override {}
+
+    virtual void OnTableInitExpr(Index segmentIndex, Index tableIndex) override
+    {
+        pop(3);
+    }
+
+    virtual void OnLoadExpr(int opcode, Index memidx, Address alignmentLog2, Address offset) override
+    {
+        pop();
+        push(1);
+    }
+
+    virtual void OnStoreExpr(int opcode, Index memidx, Address alignmentLog2, Address offset) override
+    {
+        pop(2);
+    }
+
+    virtual void OnReturnExpr() override
+    {
+        pop(functionInfo(m_currentFunctionIndex).m_resultCount);
+        stopToScanWhileBlockEnd();
+        if (!m_blockInfo.size()) {
+            stopToScanFunction();
+        }
+    }
+
+    virtual void OnRefFuncExpr(Index funcIndex) override
+    {
+        push(1);
+    }
+
+    virtual void OnRefNullExpr(Type type) override
+    {
+        push(1);
+        m_lastCodeIsRefNull = true;
+    }
+
+    virtual void OnRefIsNullExpr() override
+    {
+        pop();
+        push(1);
+    }
+
+    virtual void OnNopExpr() override {}
+
+    virtual void OnEndExpr() override
+    {
+        if (!m_blockInfo.size()) {
+            return;
+        }
+
+        BlockInfo blockInfo = std::move(m_blockInfo.back());
+        m_blockInfo.pop_back();
+
+        if ((blockInfo.m_blockType == BlockInfo::Loop || blockInfo.m_blockType == BlockInfo::Block)
+            && blockInfo.m_byteCodeGenerationStopped && !blockInfo.m_hasJumpToEnd) {
+            endBlock(blockInfo);
+            stopToScanWhileBlockEnd();
+            return;
+        }
+
+        if (blockInfo.m_shouldRestoreStackAtEnd) {
+            FunctionTypeInfo info = blockTypeInfo(blockInfo.m_returnValueType);
+            restoreStack(blockInfo);
+            pop(info.m_paramCount);
+            push(info.m_resultCount);
+        }
+        endBlock(blockInfo);
+    }
+
+    virtual void OnUnreachableExpr() override
+    {
+        stopToScanWhileBlockEnd();
+    }
+
+    virtual void EndFunctionBody(Index index) override
+    {
+        m_blockInfo.clear();
+        pop(m_stack.size());
+        m_shouldContinueToGenerateByteCode = true;
+    }
+};
+
+} // namespace wabt
+
+namespace Walrus {
+
+std::pair<std::vector<DirectReferenceScanner::UpdatedLocal>, std::string> DirectReferenceScanner::scan(const std::string& filename, const uint8_t* data, size_t len)
+{
+    std::vector<UpdatedLocal> updatedLocals;
+    wabt::WASMDirectReferenceScanner delegate(updatedLocals);
+
+    std::string error = ReadWasmBinary(filename, data, len, &delegate);
+    return std::make_pair(std::move(updatedLocals), error);
+}
+
+DirectReferenceScanner::Stream::Stream(const std::string& filename)
+    : m_scanner(new wabt::WASMDirectReferenceScanner(m_updatedLocals))
+    , m_reader(new wabt::WASMStreamingBinaryReader(filename, m_scanner))
+{
+}
+
+DirectReferenceScanner::Stream::~Stream()
+{
+    delete m_reader;
+    delete m_scanner;
+}
+
+std::string DirectReferenceScanner::Stream::read(const uint8_t* data, size_t len)
+{
+    return m_reader->read(data, len);
+}
+
+std::string DirectReferenceScanner::Stream::finish()
+{
+    return m_reader->finish();
+}
+
+} // namespace Walrus
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusDirectReferenceScanner__
+#define __WalrusDirectReferenceScanner__
+
+namespace wabt {
+class WASMDirectReferenceScanner;
+class WASMStreamingBinaryReader;
+} // namespace wabt
+
+namespace Walrus {
+
+// Finds the locals which the bytecode of a function cannot reference
+// directly. A local.get leaves a direct reference to the local on the value
+// stack, which becomes stale when the local is updated before the value is
+// used. The scan follows the value stack of the bytecode generator, so the
+// generator knows these locals before it compiles a function.
+class DirectReferenceScanner {
+public:
+    struct UpdatedLocal {
+        uint32_t m_functionIndex;
+        uint32_t m_localIndex;
+    };
+
+    // Validates the module and returns <locals, error>, the locals are
+    // ordered by their functions.
+    static std::pair<std::vector<UpdatedLocal>, std::string> scan(const std::string& filename, const uint8_t* data, size_t len);
+
+    // Scans a module whose bytes arrive in order. The locals of a function
+    // are known once the bytes of its body were read.
+    class Stream {
+    public:
+        explicit Stream(const std::string& filename);
+        ~Stream();
+
+        // data holds every byte received so far, returns the error
+        std::string read(const uint8_t* data, size_t len);
+        std::string finish();
+
+        const std::vector<UpdatedLocal>& updatedLocals() const
+        {
+            return m_updatedLocals;
+        }
+
+    private:
+        std::vector<UpdatedLocal> m_updatedLocals;
+        wabt::WASMDirectReferenceScanner* m_scanner;
+        wabt::WASMStreamingBinaryReader* m_reader;
+    };
+};
+
+} // namespace Walrus
+
+#endif // __WalrusDirectReferenceScanner__
@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "parser/StackSlotAllocator.h"
+#include "parser/ByteCodeVisitor.h"
+
+namespace Walrus {
+
+static bool isMove(ByteCode* code)
+{
+    return code->opcode() == ByteCode::Move32Opcode || code->opcode() == ByteCode::Move64Opcode;
+}
+
+static bool isBitSet(const uint64_t* bits, size_t index)
+{
+    return bits[index / 64] & (1ULL << (index % 64));
+}
+
+static void setBit(uint64_t* bits, size_t index)
+{
+    bits[index / 64] |= (1ULL << (index % 64));
+}
+
+static void clearBit(uint64_t* bits, size_t index)
+{
+    bits[index / 64] &= ~(1ULL << (index % 64));
+}
+
+template <typename Callback>
+static void forEachBit(const uint64_t* bits, size_t wordCount, Callback callback)
+{
+    for (size_t i = 0; i < wordCount; i++) {
+        uint64_t word = bits[i];
+        while (word) {
+            callback(i * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+class FunctionSlotAllocator {
+public:
+    // the liveness sets and the interference matrix take (2 * blocks + slots) * slots bits,
+    // larger functions keep their slots
+    static constexpr size_t s_maxSlotCount = 1024;
+    static constexpr size_t s_maxBlockCount = 4096;
+
+    FunctionSlotAllocator(ModuleFunction* function, const WASMParsingResult& result)
+        : m_function(function)
+        , m_result(result)
+        , m_slotBase(function->functionType()->paramStackSize() + function->requiredStackSizeDueToLocal())
+        , m_slotCount(0)
+        , m_wordCount(0)
+    {
+        if (function->requiredStackSize() > m_slotBase) {
+            m_slotCount = (function->requiredStackSize() - m_slotBase + s_slotSize - 1) / s_slotSize;
+        }
+        m_wordCount = (m_slotCount + 63) / 64;
+    }
+
+    bool run()
+    {
+        if (m_slotCount == 0 || m_slotCount > s_maxSlotCount || m_slotBase % s_slotSize || !decode()) {
+            return false;
+        }
+
+        computeLiveness();
+        buildInterference();
+        coalesceMoves();
+        assignSlots();
+        rewrite();
+        return true;
+    }
+
+private:
+    struct Instruction {
+        size_t m_position;
+        size_t m_size;
+        // uses, then defs in m_operands
+        size_t m_operandStart;
+        size_t m_defStart;
+        size_t m_operandEnd;
+        // instruction indexes in m_targets
+        size_t m_targetStart;
+        size_t m_targetEnd;
+        bool m_fallThrough;
+    };
+
+    struct Block {
+        size_t m_start;
+        size_t m_end;
+    };
+
+    ByteCode* codeAt(size_t position)
+    {
+        return reinterpret_cast<ByteCode*>(m_function->byteCode() + position);
+    }
+
+    // returns the slot index of a temporary offset or m_slotCount
+    size_t slotIndex(ByteCodeStackOffset offset)
+    {
+        if (offset < m_slotBase) {
+            return m_slotCount;
+        }
+        ASSERT((offset - m_slotBase) / s_slotSize < m_slotCount);
+        return (offset - m_slotBase) / s_slotSize;
+    }
+
+    // returns m_instructions.size() if no instruction starts at the position
+    size_t findInstruction(size_t position)
+    {
+        auto iter = std::lower_bound(m_instructions.begin(), m_instructions.end(), position,
+                                     [](const Instruction& insn, size_t pos) { return insn.m_position < pos; });
+        if (iter == m_instructions.end() || iter->m_position != position) {
+            return m_instructions.size();
+        }
+        return iter - m_instructions.begin();
+    }
+
+    bool decode()
+    {
+        size_t byteCodeSize = m_function->currentByteCodeSize();
+        std::vector<std::pair<size_t, int32_t>> jumps;
+        bool supported = true;
+
+        size_t position = 0;
+        while (position < byteCodeSize) {
+            ByteCode* code = codeAt(position);
+            Instruction insn;
+            insn.m_position = position;
+            insn.m_size = code->getSize();
+            insn.m_operandStart = m_operands.size();
+
+            std::vector<size_t> defs;
+            auto collect = [&](ByteCodeStackOffset offset, bool isDef) -> ByteCodeStackOffset {
+                if (offset >= m_slotBase && (offset - m_slotBase) % s_slotSize) {
+                    supported = false;
+                }
+                size_t slot = slotIndex(offset);
+                if (slot != m_slotCount) {
+                    if (isDef) {
+                        defs.push_back(slot);
+                    } else {
+                        m_operands.push_back(slot);
+                    }
+                }
+                return offset;
+            };
+            if (!visitStackOffsets(code, m_result, collect) || !supported) {
+                return false;
+            }
+            insn.m_defStart = m_operands.size();
+            m_operands.insert(m_operands.end(), defs.begin(), defs.end());
+            insn.m_operandEnd = m_operands.size();
+
+            insn.m_targetStart = jumps.size();
+            insn.m_fallThrough = visitJumpOffsets(code, [&](int32_t offset) -> int32_t {
+                jumps.push_back(std::make_pair(m_instructions.size(), offset));
+                return offset;
+            });
+            insn.m_targetEnd = jumps.size();
+            if (isMove(code)) {
+                m_moves.push_back(m_instructions.size());
+            }
+
+            m_instructions.push_back(insn);
+            position += insn.m_size;
+        }
+
+        m_targets.reserve(jumps.size());
+        for (auto& jump : jumps) {
+            size_t target = findInstruction(m_instructions[jump.first].m_position + jump.second);
+            if (target == m_instructions.size()) {
+                return false;
+            }
+            m_targets.push_back(target);
+        }
+
+        // split into basic blocks
+        std::vector<bool> leaders(m_instructions.size() + 1, false);
+        leaders[0] = true;
+        for (size_t i = 0; i < m_instructions.size(); i++) {
+            const Instruction& insn = m_instructions[i];
+            if (insn.m_targetStart != insn.m_targetEnd || !insn.m_fallThrough) {
+                leaders[i + 1] = true;
+            }
+            for (size_t j = insn.m_targetStart; j < insn.m_targetEnd; j++) {
+                leaders[m_targets[j]] = true;
+            }
+        }
+
+        m_blockOfInstruction.resize(m_instructions.size());
+        for (size_t i = 0; i < m_instructions.size(); i++) {
+            if (leaders[i]) {
+                if (!m_blocks.empty()) {
+                    m_blocks.back().m_end = i;
+                }
+                if (m_blocks.size() == s_maxBlockCount) {
+                    return false;
+                }
+                m_blocks.push_back(Block{ i, i });
+            }
+            m_blockOfInstruction[i] = m_blocks.size() - 1;
+        }
+        m_blocks.back().m_end = m_instructions.size();
+        return true;
+    }
+
+    uint64_t* liveIn(size_t block) { return &m_liveIn[block * m_wordCount]; }
+    uint64_t* liveOut(size_t block) { return &m_liveOut[block * m_wordCount]; }
+    uint64_t* interference(size_t slot) { return &m_interference[slot * m_wordCount]; }
+
+    void transfer(const Instruction& insn, uint64_t* live)
+    {
+        for (size_t i = insn.m_defStart; i < insn.m_operandEnd; i++) {
+            clearBit(live, m_operands[i]);
+        }
+        for (size_t i = insn.m_operandStart; i < insn.m_defStart; i++) {
+            setBit(live, m_operands[i]);
+        }
+    }
+
+    void computeLiveness()
+    {
+        m_liveIn.assign(m_blocks.size() * m_wordCount, 0);
+        m_liveOut.assign(m_blocks.size() * m_wordCount, 0);
+        std::vector<uint64_t> live(m_wordCount);
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t b = m_blocks.size(); b-- > 0;) {
+                const Block& block = m_blocks[b];
+                const Instruction& last = m_instructions[block.m_end - 1];
+                uint64_t* out = liveOut(b);
+                if (last.m_fallThrough && block.m_end < m_instructions.size()) {
+                    uint64_t* in = liveIn(b + 1);
+                    for (size_t w = 0; w < m_wordCount; w++) {
+                        out[w] |= in[w];
+                    }
+                }
+                for (size_t j = last.m_targetStart; j < last.m_targetEnd; j++) {
+                    uint64_t* in = liveIn(m_blockOfInstruction[m_targets[j]]);
+                    for (size_t w = 0; w < m_wordCount; w++) {
+                        out[w] |= in[w];
+                    }
+                }
+
+                std::copy(out, out + m_wordCount, live.begin());
+                for (size_t i = block.m_end; i-- > block.m_start;) {
+                    transfer(m_instructions[i], live.data());
+                }
+                uint64_t* in = liveIn(b);
+                if (!std::equal(live.begin(), live.end(), in)) {
+                    std::copy(live.begin(), live.end(), in);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    void addInterference(size_t a, size_t b)
+    {
+        if (a != b) {
+            setBit(interference(a), b);
+            setBit(interference(b), a);
+        }
+    }
+
+    void buildInterference()
+    {
+        m_interference.assign(m_slotCount * m_wordCount, 0);
+        m_used.assign(m_slotCount, false);
+        std::vector<uint64_t> live(m_wordCount);
+
+        for (size_t b = 0; b < m_blocks.size(); b++) {
+            const Block& block = m_blocks[b];
+            std::copy(liveOut(b), liveOut(b) + m_wordCount, live.begin());
+            for (size_t i = block.m_end; i-- > block.m_start;) {
+                const Instruction& insn = m_instructions[i];
+                // the source of a move does not interfere with its destination
+                size_t moveSource = m_slotCount;
+                if (isMove(codeAt(insn.m_position)) && insn.m_operandStart != insn.m_defStart) {
+                    moveSource = m_operands[insn.m_operandStart];
+                }
+
+                for (size_t d = insn.m_defStart; d < insn.m_operandEnd; d++) {
+                    size_t def = m_operands[d];
+                    m_used[def] = true;
+                    forEachBit(live.data(), m_wordCount, [&](size_t slot) {
+                        if (slot != moveSource) {
+                            addInterference(def, slot);
+                        }
+                    });
+                    for (size_t other = insn.m_defStart; other < insn.m_operandEnd; other++) {
+                        addInterference(def, m_operands[other]);
+                    }
+                }
+                for (size_t u = insn.m_operandStart; u < insn.m_defStart; u++) {
+                    m_used[m_operands[u]] = true;
+                }
+                transfer(insn, live.data());
+            }
+        }
+    }
+
+    size_t find(size_t slot)
+    {
+        while (m_parent[slot] != slot) {
+            m_parent[slot] = m_parent[m_parent[slot]];
+            slot = m_parent[slot];
+        }
+        return slot;
+    }
+
+    void coalesceMoves()
+    {
+        m_parent.resize(m_slotCount);
+        for (size_t i = 0; i < m_slotCount; i++) {
+            m_parent[i] = i;
+        }
+
+        for (size_t index : m_moves) {
+            const Instruction& insn = m_instructions[index];
+            if (insn.m_operandStart == insn.m_defStart || insn.m_defStart == insn.m_operandEnd) {
+                continue;
+            }
+            size_t src = find(m_operands[insn.m_operandStart]);
+            size_t dst = find(m_operands[insn.m_defStart]);
+            if (src == dst || isBitSet(interference(src), dst)) {
+                continue;
+            }
+
+            // merge dst into src; the rows of the interference matrix only refer to representatives
+            forEachBit(interference(dst), m_wordCount, [&](size_t slot) {
+                clearBit(interference(slot), dst);
+                setBit(interference(slot), src);
+                setBit(interference(src), slot);
+            });
+            std::fill(interference(dst), interference(dst) + m_wordCount, 0);
+            m_parent[dst] = src;
+        }
+    }
+
+    void assignSlots()
+    {
+        m_assignedSlot.assign(m_slotCount, m_slotCount);
+        m_newSlotCount = 0;
+        std::vector<bool> taken;
+        for (size_t slot = 0; slot < m_slotCount; slot++) {
+            if (!m_used[slot] || find(slot) != slot) {
+                continue;
+            }
+            taken.assign(m_newSlotCount + 1, false);
+            forEachBit(interference(slot), m_wordCount, [&](size_t other) {
+                if (m_assignedSlot[other] != m_slotCount) {
+                    taken[m_assignedSlot[other]] = true;
+                }
+            });
+            size_t newSlot = 0;
+            while (taken[newSlot]) {
+                newSlot++;
+            }
+            m_assignedSlot[slot] = newSlot;
+            m_newSlotCount = std::max(m_newSlotCount, newSlot + 1);
+        }
+    }
+
+    void rewrite()
+    {
+        auto rename = [&](ByteCodeStackOffset offset, bool) -> ByteCodeStackOffset {
+            size_t slot = slotIndex(offset);
+            if (slot == m_slotCount) {
+                return offset;
+            }
+            return m_slotBase + m_assignedSlot[find(slot)] * s_slotSize;
+        };
+
+        // new position of each instruction; removed moves take the position of the next instruction
+        std::vector<size_t>& newPosition = m_newPosition;
+        newPosition.resize(m_instructions.size() + 1);
+        size_t position = 0;
+        for (size_t i = 0; i < m_instructions.size(); i++) {
+            const Instruction& insn = m_instructions[i];
+            ByteCode* code = codeAt(insn.m_position);
+            visitStackOffsets(code, m_result, rename);
+
+            newPosition[i] = position;
+            bool removed = false;
+            if (code->opcode() == ByteCode::Move32Opcode) {
+                removed = static_cast<Move32*>(code)->srcOffset() == static_cast<Move32*>(code)->dstOffset();
+            } else if (code->opcode() == ByteCode::Move64Opcode) {
+                removed = static_cast<Move64*>(code)->srcOffset() == static_cast<Move64*>(code)->dstOffset();
+            }
+            if (!removed) {
+                if (position != insn.m_position) {
+                    memmove(m_function->byteCode() + position, codeAt(insn.m_position), insn.m_size);
+                }
+                position += insn.m_size;
+            }
+        }
+        newPosition[m_instructions.size()] = position;
+
+        for (size_t i = 0; i < m_instructions.size(); i++) {
+            const Instruction& insn = m_instructions[i];
+            if (insn.m_targetStart == insn.m_targetEnd) {
+                continue;
+            }
+            size_t base = newPosition[i];
+            ByteCode* code = codeAt(base);
+            auto target = [&](size_t j) -> int32_t {
+                return static_cast<int32_t>(newPosition[m_targets[j]]) - static_cast<int32_t>(base);
+            };
+            switch (code->opcode()) {
+            case ByteCode::JumpOpcode:
+                static_cast<Jump*>(code)->setOffset(target(insn.m_targetStart));
+                break;
+            case ByteCode::JumpIfTrueOpcode:
+                static_cast<JumpIfTrue*>(code)->setOffset(target(insn.m_targetStart));
+                break;
+            case ByteCode::JumpIfFalseOpcode:
+                static_cast<JumpIfFalse*>(code)->setOffset(target(insn.m_targetStart));
+                break;
+#define CASE_OPCODE(name, ...) case ByteCode::name##Opcode:
+                FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(CASE_OPCODE)
+                static_cast<BinaryCompareJump*>(code)->setOffset(target(insn.m_targetStart));
+                break;
+                FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(CASE_OPCODE)
+                static_cast<UnaryCompareJump*>(code)->setOffset(target(insn.m_targetStart));
+                break;
+#undef CASE_OPCODE
+            case ByteCode::BrTableOpcode: {
+                BrTable* brTable = static_cast<BrTable*>(code);
+                brTable->setDefaultOffset(target(insn.m_targetStart));
+                for (uint32_t j = 0; j < brTable->tableSize(); j++) {
+                    brTable->jumpOffsets()[j] = target(insn.m_targetStart + 1 + j);
+                }
+                break;
+            }
+            default:
+                RELEASE_ASSERT_NOT_REACHED();
+                break;
+            }
+        }
+
+        m_function->shrinkByteCode(m_function->currentByteCodeSize() - position);
+    }
+
+public:
+    size_t newSlotCount() const { return m_newSlotCount; }
+    size_t slotBase() const { return m_slotBase; }
+
+    // position of the code at an instruction boundary of the original bytecode after rewrite()
+    size_t newPosition(size_t position)
+    {
+        // the end of the bytecode maps to the end of the rewritten bytecode
+        size_t index = findInstruction(position);
+        ASSERT(index != m_instructions.size() || position == m_instructions.back().m_position + m_instructions.back().m_size);
+        return m_newPosition[index];
+    }
+
+private:
+    ModuleFunction* m_function;
+    const WASMParsingResult& m_result;
+    size_t m_slotBase;
+    size_t m_slotCount;
+    size_t m_wordCount;
+    size_t m_newSlotCount;
+
+    std::vector<Instruction> m_instructions;
+    std::vector<size_t> m_operands;
+    std::vector<size_t> m_targets;
+    std::vector<size_t> m_moves;
+    std::vector<Block> m_blocks;
+    std::vector<size_t> m_blockOfInstruction;
+
+    std::vector<uint64_t> m_liveIn;
+    std::vector<uint64_t> m_liveOut;
+    std::vector<uint64_t> m_interference;
+    std::vector<bool> m_used;
+    std::vector<size_t> m_parent;
+    std::vector<size_t> m_assignedSlot;
+    std::vector<size_t> m_newPosition;
+};
+
+static size_t countMoves(ModuleFunction* function)
+{
+    size_t count = 0;
+    size_t position = 0;
+    while (position < function->currentByteCodeSize()) {
+        ByteCode* code = reinterpret_cast<ByteCode*>(function->byteCode() + position);
+        if (isMove(code)) {
+            count++;
+        }
+        position += code->getSize();
+    }
+    return count;
+}
+
+static bool hasWideValue(const ValueTypeVector& types)
+{
+    for (size_t i = 0; i < types.size(); i++) {
+        if (valueSizeInStack(types[i]) > s_slotSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StackSlotAllocator::allocate(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats)
+{
+    stats.m_frameSizeBefore += function->m_requiredStackSize;
+    stats.m_moveCountBefore += countMoves(function);
+
+    // frames with exception handlers have fixed slots for the caught values,
+    // and i32 and i64 values only share the slot size on 64-bit hosts
+    bool canAllocate = sizeof(size_t) == sizeof(uint64_t) && function->currentByteCodeSize() && function->m_catchInfo.empty()
+        && !hasWideValue(function->functionType()->param()) && !hasWideValue(function->functionType()->result())
+        && !hasWideValue(function->m_local);
+
+    if (canAllocate) {
+        FunctionSlotAllocator allocator(function, result);
+        if (allocator.run()) {
+            FunctionType* ft = function->functionType();
+            size_t requiredStackSize = allocator.slotBase() + allocator.newSlotCount() * s_slotSize;
+            requiredStackSize = std::max(requiredStackSize, std::max(ft->paramStackSize(), ft->resultStackSize()));
+            ASSERT(requiredStackSize <= function->m_requiredStackSize);
+            function->m_requiredStackSize = requiredStackSize;
+
+            // the loop ranges are hoisted later, removed moves shifted the code
+            for (size_t i = 0; i < function->m_loopInfo.size(); i++) {
+                function->m_loopInfo[i].m_start = allocator.newPosition(function->m_loopInfo[i].m_start);
+                function->m_loopInfo[i].m_end = allocator.newPosition(function->m_loopInfo[i].m_end);
+            }
+        }
+    }
+
+    stats.m_frameSizeAfter += function->m_requiredStackSize;
+    stats.m_moveCountAfter += countMoves(function);
+}
+
+} // namespace Walrus
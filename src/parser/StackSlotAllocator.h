@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusStackSlotAllocator__
+#define __WalrusStackSlotAllocator__
+
+namespace Walrus {
+
+class ModuleFunction;
+struct WASMParsingResult;
+
+// Reassigns the temporary stack slots of the generated bytecode.
+// Parameters and locals keep their offsets; every other slot is
+// renamed by liveness, so values with disjoint lifetimes share a slot
+// and moves between non-interfering slots are removed.
+// The liveness sets and the interference matrix are quadratic in the
+// number of slots, so functions with more than 1024 temporary slots or
+// 4096 basic blocks are left unchanged.
+class StackSlotAllocator {
+public:
+    struct Statistics {
+        Statistics()
+            : m_frameSizeBefore(0)
+            , m_frameSizeAfter(0)
+            , m_moveCountBefore(0)
+            , m_moveCountAfter(0)
+        {
+        }
+
+        void merge(const Statistics& other)
+        {
+            m_frameSizeBefore += other.m_frameSizeBefore;
+            m_frameSizeAfter += other.m_frameSizeAfter;
+            m_moveCountBefore += other.m_moveCountBefore;
+            m_moveCountAfter += other.m_moveCountAfter;
+        }
+
+        size_t m_frameSizeBefore;
+        size_t m_frameSizeAfter;
+        size_t m_moveCountBefore;
+        size_t m_moveCountAfter;
+    };
+
+    static void allocate(ModuleFunction* function, const WASMParsingResult& result, Statistics& stats);
+};
+
+} // namespace Walrus
+
+#endif // __WalrusStackSlotAllocator__
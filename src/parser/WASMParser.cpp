@@ -16,12 +16,20 @@
 #include "Walrus.h"
 
 #include "parser/WASMParser.h"
+#include "parser/DirectReferenceScanner.h"
+#include "parser/StackSlotAllocator.h"
+#include "parser/BoundsCheckEliminator.h"
 #include "interpreter/ByteCode.h"
 #include "runtime/Store.h"
 #include "runtime/Module.h"
+#include "runtime/Engine.h"
+#include "runtime/ThreadPool.h"
 
 #include "wabt/walrus/binary-reader-walrus.h"
 
+#include <cerrno>
+#include <unistd.h>
+
 namespace wabt {
 
 enum class WASMOpcode : size_t {
@@ -128,6 +136,14 @@ static Walrus::SegmentMode toSegmentMode(uint8_t flags)
 }
 
 class WASMBinaryReader : public wabt::WASMBinaryReaderDelegate {
+public:
+    // range of a function body in the module
+    struct FunctionBody {
+        Index m_index;
+        size_t m_offset;
+        size_t m_size;
+    };
+
 private:
     struct VMStackInfo {
         WASMBinaryReader& m_reader;
@@ -165,7 +181,8 @@ private:
         {
             decreaseRefCountIfNeeds();
 
-            m_reader = src.m_reader;
+            // the values of a function stack belong to one reader
+            ASSERT(&m_reader == &src.m_reader);
             m_size = src.m_size;
             m_position = src.m_position;
             m_nonOptimizedPosition = src.m_nonOptimizedPosition;
@@ -205,13 +222,22 @@ private:
         BlockType m_blockType;
         Type m_returnValueType;
         size_t m_position;
-        std::vector<VMStackInfo> m_vmStack;
+        // the block shares m_vmStack below its parameters with the enclosing
+        // code, only the parameters are kept as they were before they were
+        // moved into general registers. the whole stack is saved when values
+        // below the parameters are popped (see saveVMStackOfBlocksIfNeeds)
+        size_t m_vmStackSize;
+        std::vector<VMStackInfo> m_parameters;
+        std::vector<VMStackInfo> m_savedVMStack;
+        bool m_isVMStackSaved;
         std::vector<uint32_t> m_parameterPositions;
         uint32_t m_functionStackSizeSoFar;
         bool m_shouldRestoreVMStackAtEnd;
         bool m_byteCodeGenerationStopped;
 
         static_assert(sizeof(Walrus::JumpIfTrue) == sizeof(Walrus::JumpIfFalse), "");
+        static_assert(sizeof(Walrus::BinaryCompareJump) == sizeof(Walrus::JumpIfFalse), "");
+        static_assert(sizeof(Walrus::UnaryCompareJump) == sizeof(Walrus::JumpIfFalse), "");
         struct JumpToEndBrInfo {
             enum JumpToEndType {
                 IsJump,
@@ -225,11 +251,17 @@ private:
 
         std::vector<JumpToEndBrInfo> m_jumpToEndBrInfo;
 
+        size_t vmStackBase() const
+        {
+            return m_vmStackSize - m_parameters.size();
+        }
+
         BlockInfo(BlockType type, Type returnValueType, WASMBinaryReader& binaryReader)
             : m_blockType(type)
             , m_returnValueType(returnValueType)
             , m_position(0)
-            , m_vmStack(binaryReader.m_vmStack)
+            , m_vmStackSize(binaryReader.m_vmStack.size())
+            , m_isVMStackSaved(false)
             , m_functionStackSizeSoFar(binaryReader.m_functionStackSizeSoFar)
             , m_shouldRestoreVMStackAtEnd(false)
             , m_byteCodeGenerationStopped(false)
@@ -237,10 +269,12 @@ private:
             if (returnValueType.IsIndex() && binaryReader.m_result.m_functionTypes[returnValueType]->param().size()) {
                 // record parameter positions
                 auto& param = binaryReader.m_result.m_functionTypes[returnValueType]->param();
+                m_parameters.assign(binaryReader.m_vmStack.end() - param.size(), binaryReader.m_vmStack.end());
                 auto endIter = binaryReader.m_vmStack.rbegin() + param.size();
                 auto iter = binaryReader.m_vmStack.rbegin();
                 while (iter != endIter) {
                     m_parameterPositions.push_back(iter->m_nonOptimizedPosition);
+                    binaryReader.addParameterPosition(iter->m_nonOptimizedPosition);
                     iter++;
                 }
 
@@ -261,18 +295,32 @@ private:
     };
 
     size_t* m_readerOffsetPointer;
-    size_t m_codeStartOffset;
 
+    const std::vector<Walrus::DirectReferenceScanner::UpdatedLocal>* m_updatedLocals;
+
+    // index of the function whose body is read, init expressions are
+    // read without a function index
+    Index m_currentFunctionIndex;
     Walrus::ModuleFunction* m_currentFunction;
     Walrus::FunctionType* m_currentFunctionType;
     uint32_t m_initialFunctionStackSize;
     uint32_t m_functionStackSizeSoFar;
     uint32_t m_lastByteCodePosition;
     WASMOpcode m_lastPushedOpcode;
-    uint32_t m_lastOpcode[2];
+    uint32_t m_lastOpcode[3];
 
     std::vector<VMStackInfo> m_vmStack;
     std::vector<BlockInfo> m_blockInfo;
+    struct ComparisonInfo {
+        WASMOpcode m_opcode;
+        Walrus::ByteCodeStackOffset m_srcOffset[2];
+
+        ComparisonInfo()
+            : m_opcode(WASMOpcode::OpcodeKindEnd)
+            , m_srcOffset{ 0, 0 }
+        {
+        }
+    };
     struct CatchInfo {
         size_t m_tryCatchBlockDepth;
         size_t m_tryStart;
@@ -284,18 +332,19 @@ private:
     struct LocalInfo {
         size_t m_refCount;
         bool m_canUseDirectReference;
-        LocalInfo()
+        uint32_t m_position;
+        uint32_t m_size;
+        LocalInfo(uint32_t position, uint32_t size)
             : m_refCount(0)
             , m_canUseDirectReference(true)
+            , m_position(position)
+            , m_size(size)
         {
         }
-
-        void reset()
-        {
-            m_refCount = 0;
-        }
     };
     std::vector<LocalInfo> m_localInfo;
+    // number of open blocks which have a parameter at the stack position
+    std::vector<uint32_t> m_parameterPositionCount;
 
     Walrus::Vector<uint8_t, std::allocator<uint8_t>> m_memoryInitData;
 
@@ -304,7 +353,11 @@ private:
     Walrus::Vector<uint32_t, std::allocator<uint32_t>> m_elementFunctionIndex;
     Walrus::SegmentMode m_segmentMode;
 
-    Walrus::WASMParsingResult m_result;
+    // a reader which only compiles function bodies fills the result of the
+    // reader which read the module
+    Walrus::WASMParsingResult m_ownResult;
+    Walrus::WASMParsingResult& m_result;
+    std::vector<FunctionBody> m_skippedFunctionBodies;
 
     virtual void OnSetOffsetAddress(size_t* ptr) override
     {
@@ -318,28 +371,6 @@ private:
         return pos;
     }
 
-    void resetFunctionCodeDataFromHere()
-    {
-        m_skipValidationUntil = *m_readerOffsetPointer;
-        *m_readerOffsetPointer = m_codeStartOffset;
-
-        m_currentFunction->m_byteCode.clear();
-        m_currentFunction->m_catchInfo.clear();
-        m_blockInfo.clear();
-        m_catchInfo.clear();
-
-        m_functionStackSizeSoFar = m_initialFunctionStackSize;
-        m_lastByteCodePosition = 0;
-        m_lastPushedOpcode = WASMOpcode::OpcodeKindEnd;
-        m_lastOpcode[0] = m_lastOpcode[1] = 0;
-
-        m_vmStack.clear();
-
-        for (auto& info : m_localInfo) {
-            info.reset();
-        }
-    }
-
     void pushVMStack(size_t size, size_t pos, size_t localIndex = std::numeric_limits<size_t>::max())
     {
         m_vmStack.push_back(VMStackInfo(*this, size, pos, m_functionStackSizeSoFar, localIndex));
@@ -351,8 +382,28 @@ private:
             m_currentFunction->m_requiredStackSize, m_functionStackSizeSoFar);
     }
 
+    // the blocks which share the values popped from m_vmStack save their
+    // stack first, it only happens after br to the function body
+    void saveVMStackOfBlocksIfNeeds(size_t newSize)
+    {
+        for (auto iter = m_blockInfo.rbegin(); iter != m_blockInfo.rend(); iter++) {
+            if (iter->m_isVMStackSaved) {
+                continue;
+            }
+            if (iter->vmStackBase() <= newSize) {
+                break;
+            }
+            iter->m_savedVMStack.assign(m_vmStack.begin(), m_vmStack.begin() + iter->vmStackBase());
+            iter->m_savedVMStack.insert(iter->m_savedVMStack.end(), iter->m_parameters.begin(), iter->m_parameters.end());
+            iter->m_isVMStackSaved = true;
+        }
+    }
+
     VMStackInfo popVMStackInfo()
     {
+        if (UNLIKELY(m_blockInfo.size() && m_vmStack.size() <= m_blockInfo.back().vmStackBase())) {
+            saveVMStackOfBlocksIfNeeds(m_vmStack.size() - 1);
+        }
         auto info = m_vmStack.back();
         m_functionStackSizeSoFar -= info.m_size;
         m_vmStack.pop_back();
@@ -390,9 +441,13 @@ private:
         m_currentFunctionType = mf->functionType();
         m_localInfo.clear();
         m_localInfo.reserve(m_currentFunctionType->param().size());
+        uint32_t position = 0;
         for (size_t i = 0; i < m_currentFunctionType->param().size(); i++) {
-            m_localInfo.push_back(LocalInfo());
+            auto size = Walrus::valueSizeInStack(m_currentFunctionType->param()[i]);
+            m_localInfo.push_back(LocalInfo(position, size));
+            position += size;
         }
+        m_parameterPositionCount.clear();
         m_initialFunctionStackSize = m_functionStackSizeSoFar = m_currentFunctionType->paramStackSize();
         m_lastByteCodePosition = 0;
         m_lastPushedOpcode = WASMOpcode::OpcodeKindEnd;
@@ -416,41 +471,57 @@ private:
         m_currentFunction->pushByteCode(code);
     }
 
+    void addParameterPosition(uint32_t pos)
+    {
+        if (pos >= m_parameterPositionCount.size()) {
+            m_parameterPositionCount.resize(pos + 1, 0);
+        }
+        m_parameterPositionCount[pos]++;
+    }
+
+    void removeParameterPositions(const BlockInfo& blockInfo)
+    {
+        for (uint32_t p : blockInfo.m_parameterPositions) {
+            m_parameterPositionCount[p]--;
+        }
+    }
+
     bool canUseDirectReference(uint32_t localIndex, uint32_t pos)
     {
-        for (const auto& bi : m_blockInfo) {
-            for (uint32_t p : bi.m_parameterPositions) {
-                if (pos == p) {
-                    return false;
-                }
-            }
+        if (pos < m_parameterPositionCount.size() && m_parameterPositionCount[pos]) {
+            return false;
         }
         return m_localInfo[localIndex].m_canUseDirectReference;
     }
 
 public:
-    WASMBinaryReader()
+    WASMBinaryReader(const std::vector<Walrus::DirectReferenceScanner::UpdatedLocal>& updatedLocals, Walrus::WASMParsingResult* result = nullptr)
         : m_readerOffsetPointer(nullptr)
-        , m_codeStartOffset(0)
+        , m_updatedLocals(&updatedLocals)
+        , m_currentFunctionIndex(std::numeric_limits<Index>::max())
         , m_currentFunction(nullptr)
         , m_currentFunctionType(nullptr)
         , m_initialFunctionStackSize(0)
         , m_functionStackSizeSoFar(0)
         , m_lastByteCodePosition(0)
         , m_lastPushedOpcode(WASMOpcode::OpcodeKindEnd)
-        , m_lastOpcode{ 0, 0 }
+        , m_lastOpcode{ 0, 0, 0 }
         , m_elementTableIndex(0)
         , m_segmentMode(Walrus::SegmentMode::None)
+        , m_result(result ? *result : m_ownResult)
     {
+        // DirectReferenceScanner already validated the module
+        m_skipValidationUntil = std::numeric_limits<size_t>::max();
     }
 
     ~WASMBinaryReader()
     {
         // clear stack first! because vmStack refer localInfo
         m_vmStack.clear();
+        m_blockInfo.clear();
         m_localInfo.clear();
 
-        m_result.clear();
+        m_ownResult.clear();
     }
 
     // should be allocated on the stack
@@ -743,6 +814,12 @@ public:
     {
         ASSERT(m_currentFunction == nullptr);
         beginFunction(m_result.m_functions[index]);
+        m_currentFunctionIndex = index;
+    }
+
+    virtual void OnSkippedFunctionBody(Index index, size_t offset, size_t size) override
+    {
+        m_skippedFunctionBodies.push_back({ index, offset, size });
     }
 
     virtual void OnLocalDeclCount(Index count) override
@@ -756,8 +833,8 @@ public:
         while (count) {
             auto wType = toValueKind(type);
             m_currentFunction->m_local.push_back(wType);
-            m_localInfo.push_back(LocalInfo());
             auto sz = Walrus::valueSizeInStack(wType);
+            m_localInfo.push_back(LocalInfo(m_initialFunctionStackSize, sz));
             m_initialFunctionStackSize += sz;
             m_functionStackSizeSoFar += sz;
             m_currentFunction->m_requiredStackSizeDueToLocal += sz;
@@ -769,11 +846,20 @@ public:
 
     virtual void OnStartReadInstructions() override
     {
-        m_codeStartOffset = *m_readerOffsetPointer;
+        // the functions can be compiled in any order
+        auto iter = std::lower_bound(m_updatedLocals->begin(), m_updatedLocals->end(), m_currentFunctionIndex,
+                                     [](const Walrus::DirectReferenceScanner::UpdatedLocal& local, Index index) {
+                                         return local.m_functionIndex < index;
+                                     });
+        while (iter != m_updatedLocals->end() && iter->m_functionIndex == m_currentFunctionIndex) {
+            m_localInfo[iter->m_localIndex].m_canUseDirectReference = false;
+            iter++;
+        }
     }
 
     virtual void OnOpcode(uint32_t opcode) override
     {
+        m_lastOpcode[2] = m_lastOpcode[1];
         m_lastOpcode[1] = m_lastOpcode[0];
         m_lastOpcode[0] = opcode;
     }
@@ -849,46 +935,17 @@ public:
 
     std::pair<uint32_t, uint32_t> resolveLocalOffsetAndSize(Index localIndex)
     {
-        if (localIndex < m_currentFunctionType->param().size()) {
-            size_t offset = 0;
-            for (Index i = 0; i < localIndex; i++) {
-                offset += Walrus::valueSizeInStack(m_currentFunctionType->param()[i]);
-            }
-            return std::make_pair(offset, Walrus::valueSizeInStack(m_currentFunctionType->param()[localIndex]));
-        } else {
-            localIndex -= m_currentFunctionType->param().size();
-            size_t offset = m_currentFunctionType->paramStackSize();
-            for (Index i = 0; i < localIndex; i++) {
-                offset += Walrus::valueSizeInStack(m_currentFunction->m_local[i]);
-            }
-            return std::make_pair(offset, Walrus::valueSizeInStack(m_currentFunction->m_local[localIndex]));
-        }
+        const LocalInfo& info = m_localInfo[localIndex];
+        return std::make_pair(info.m_position, info.m_size);
     }
 
     Index resolveLocalIndexFromStackPosition(size_t pos)
     {
         ASSERT(pos < m_initialFunctionStackSize);
-        if (pos <= m_currentFunctionType->paramStackSize()) {
-            Index idx = 0;
-            size_t offset = 0;
-            while (true) {
-                if (offset == pos) {
-                    return idx;
-                }
-                offset += Walrus::valueSizeInStack(m_currentFunctionType->param()[idx]);
-                idx++;
-            }
-        }
-        pos -= m_currentFunctionType->paramStackSize();
-        Index idx = 0;
-        size_t offset = 0;
-        while (true) {
-            if (offset == pos) {
-                return idx + m_currentFunctionType->param().size();
-            }
-            offset += Walrus::valueSizeInStack(m_currentFunction->m_local[idx]);
-            idx++;
-        }
+        auto iter = std::lower_bound(m_localInfo.begin(), m_localInfo.end(), pos,
+                                     [](const LocalInfo& info, size_t pos) { return info.m_position < pos; });
+        ASSERT(iter != m_localInfo.end() && iter->m_position == pos);
+        return iter - m_localInfo.begin();
     }
 
     virtual void OnLocalGetExpr(Index localIndex) override
@@ -910,7 +967,13 @@ public:
             // because some opcode omitted by optimization
             // eg) (i32.add) (local.get 0) ;; local.get 0 can be omitted by direct access
             if (m_lastOpcode[1] == static_cast<uint32_t>(m_lastPushedOpcode) && isBinaryOperation(m_lastPushedOpcode)) {
-                m_currentFunction->peekByteCode<Walrus::BinaryOperation>(m_lastByteCodePosition)->setDstOffset(localOffsetAndSize.first);
+                setBinaryOperationDstOffset(m_lastByteCodePosition, localOffsetAndSize.first);
+            } else if (m_lastOpcode[1] == static_cast<uint32_t>(m_lastPushedOpcode)
+                       && (m_lastPushedOpcode == WASMOpcode::I32ConstOpcode || m_lastPushedOpcode == WASMOpcode::F32ConstOpcode)) {
+                m_currentFunction->peekByteCode<Walrus::Const32>(m_lastByteCodePosition)->setDstOffset(localOffsetAndSize.first);
+            } else if (m_lastOpcode[1] == static_cast<uint32_t>(m_lastPushedOpcode)
+                       && (m_lastPushedOpcode == WASMOpcode::I64ConstOpcode || m_lastPushedOpcode == WASMOpcode::F64ConstOpcode)) {
+                m_currentFunction->peekByteCode<Walrus::Const64>(m_lastByteCodePosition)->setDstOffset(localOffsetAndSize.first);
             } else if (m_lastPushedOpcode == WASMOpcode::Const32Opcode) {
                 m_currentFunction->peekByteCode<Walrus::Const32>(m_lastByteCodePosition)->setDstOffset(localOffsetAndSize.first);
             } else if (m_lastPushedOpcode == WASMOpcode::Const64Opcode) {
@@ -926,16 +989,11 @@ public:
     virtual void OnLocalSetExpr(Index localIndex) override
     {
         auto r = resolveLocalOffsetAndSize(localIndex);
-        if (m_localInfo[localIndex].m_refCount && m_localInfo[localIndex].m_canUseDirectReference) {
-            // src and dst are same!
-            // example) (local.get 0) (local.set 0) ;; w/direct access
-            if (peekVMStackInfo().m_position != r.first) {
-                // rewind generating bytecode
-                m_localInfo[localIndex].m_canUseDirectReference = false;
-                resetFunctionCodeDataFromHere();
-                return;
-            }
-        }
+        // DirectReferenceScanner found the locals which are updated while
+        // they are referenced, only src and dst can be the same
+        // example) (local.get 0) (local.set 0) ;; w/direct access
+        RELEASE_ASSERT(!m_localInfo[localIndex].m_refCount || !m_localInfo[localIndex].m_canUseDirectReference
+                       || peekVMStackInfo().m_position == r.first);
 
         ASSERT(r.second == peekVMStackSize());
         auto src = popVMStackInfo();
@@ -946,12 +1004,7 @@ public:
 
     virtual void OnLocalTeeExpr(Index localIndex) override
     {
-        if (m_localInfo[localIndex].m_refCount && m_localInfo[localIndex].m_canUseDirectReference) {
-            m_localInfo[localIndex].m_canUseDirectReference = false;
-            resetFunctionCodeDataFromHere();
-            return;
-        }
-
+        RELEASE_ASSERT(!m_localInfo[localIndex].m_refCount || !m_localInfo[localIndex].m_canUseDirectReference);
 
         auto r = resolveLocalOffsetAndSize(localIndex);
         ASSERT(r.second == peekVMStackSize());
@@ -1006,7 +1059,9 @@ public:
         ASSERT(WASMCodeInfo::codeTypeToMemorySize(g_wasmCodeInfo[opcode].m_paramTypes[1]) == peekVMStackSize());
         auto src0 = popVMStack();
         auto dst = pushVMStack(WASMCodeInfo::codeTypeToMemorySize(g_wasmCodeInfo[opcode].m_resultType));
-        generateBinaryCode(code, src0, src1, dst);
+        if (!generateBinaryImmCodeIfPossible(code, src0, src1, dst)) {
+            generateBinaryCode(code, src0, src1, dst);
+        }
     }
 
     virtual void OnUnaryExpr(uint32_t opcode) override
@@ -1034,17 +1089,45 @@ public:
         auto stackPos = popVMStack();
 
         BlockInfo b(BlockInfo::IfElse, sigType, *this);
+        auto comparison = takeLastComparisonIfPossible(stackPos);
+        b.m_position = m_currentFunction->currentByteCodeSize();
         b.m_jumpToEndBrInfo.push_back({ BlockInfo::JumpToEndBrInfo::IsJumpIf, b.m_position });
         m_blockInfo.push_back(b);
-        pushByteCode(Walrus::JumpIfFalse(stackPos), WASMOpcode::IfOpcode);
+        generateJumpIfCode(comparison, stackPos, false, 0, WASMOpcode::IfOpcode);
     }
 
     void restoreVMStackBy(const BlockInfo& blockInfo)
     {
-        m_vmStack = blockInfo.m_vmStack;
+        if (blockInfo.m_isVMStackSaved) {
+            m_vmStack = blockInfo.m_savedVMStack;
+        } else {
+            ASSERT(blockInfo.vmStackBase() <= m_vmStack.size());
+            m_vmStack.erase(m_vmStack.begin() + blockInfo.vmStackBase(), m_vmStack.end());
+            m_vmStack.insert(m_vmStack.end(), blockInfo.m_parameters.begin(), blockInfo.m_parameters.end());
+        }
         m_functionStackSizeSoFar = blockInfo.m_functionStackSizeSoFar;
     }
 
+    // stack size of the current values in the part of m_vmStack which
+    // the block started with
+    size_t stackSizeAtBlockStart(const BlockInfo& blockInfo)
+    {
+        size_t size = m_initialFunctionStackSize;
+        size_t start = 0;
+        if (!blockInfo.m_isVMStackSaved) {
+            size = blockInfo.m_functionStackSizeSoFar;
+            for (const auto& param : blockInfo.m_parameters) {
+                size -= param.m_size;
+            }
+            start = blockInfo.vmStackBase();
+        }
+        size_t end = std::min(blockInfo.m_vmStackSize, m_vmStack.size());
+        for (size_t i = start; i < end; i++) {
+            size += m_vmStack[i].m_size;
+        }
+        return size;
+    }
+
     void restoreVMStackRegardToPartOfBlockEnd(const BlockInfo& blockInfo)
     {
         if (blockInfo.m_shouldRestoreVMStackAtEnd) {
@@ -1088,8 +1171,7 @@ public:
         pushByteCode(Walrus::Jump(), WASMOpcode::ElseOpcode);
         ASSERT(blockInfo.m_blockType == BlockInfo::IfElse);
         restoreVMStackRegardToPartOfBlockEnd(blockInfo);
-        m_currentFunction->peekByteCode<Walrus::JumpIfFalse>(blockInfo.m_position)
-            ->setOffset(m_currentFunction->currentByteCodeSize() - blockInfo.m_position);
+        setJumpIfOffset(blockInfo.m_position, m_currentFunction->currentByteCodeSize() - blockInfo.m_position);
     }
 
     virtual void OnLoopExpr(Type sigType) override
@@ -1136,11 +1218,8 @@ public:
         size_t parameterSize = 0;
         if (depth < m_blockInfo.size()) {
             auto iter = m_blockInfo.rbegin() + depth;
-            if (iter->m_vmStack.size() < m_vmStack.size()) {
-                size_t start = iter->m_vmStack.size();
-                for (size_t i = start; i < m_vmStack.size(); i++) {
-                    dropValueSize += m_vmStack[i].m_size;
-                }
+            if (iter->m_vmStackSize < m_vmStack.size()) {
+                dropValueSize += m_functionStackSizeSoFar - stackSizeAtBlockStart(*iter);
 
                 if (iter->m_blockType == BlockInfo::Loop) {
                     if (iter->m_returnValueType.IsIndex()) {
@@ -1162,9 +1241,8 @@ public:
             }
         } else if (m_blockInfo.size()) {
             auto iter = m_blockInfo.begin();
-            size_t start = iter->m_vmStack.size();
-            for (size_t i = start; i < m_vmStack.size(); i++) {
-                dropValueSize += m_vmStack[i].m_size;
+            if (iter->m_vmStackSize < m_vmStack.size()) {
+                dropValueSize += m_functionStackSizeSoFar - stackSizeAtBlockStart(*iter);
             }
         }
 
@@ -1296,8 +1374,8 @@ public:
             // this case acts like return
             ASSERT(peekVMStackSize() == Walrus::valueSizeInStack(toValueKind(Type::I32)));
             auto stackPos = popVMStack();
-            size_t pos = m_currentFunction->currentByteCodeSize();
-            pushByteCode(Walrus::JumpIfFalse(stackPos, sizeof(Walrus::JumpIfFalse) + sizeof(Walrus::End) + sizeof(uint16_t) * m_currentFunctionType->result().size()), WASMOpcode::BrIfOpcode);
+            auto comparison = takeLastComparisonIfPossible(stackPos);
+            generateJumpIfCode(comparison, stackPos, false, sizeof(Walrus::JumpIfFalse) + sizeof(Walrus::End) + sizeof(uint16_t) * m_currentFunctionType->result().size(), WASMOpcode::BrIfOpcode);
             for (size_t i = 0; i < m_currentFunctionType->result().size(); i++) {
                 ASSERT((m_vmStack.rbegin() + i)->m_size == Walrus::valueSizeInStack(m_currentFunctionType->result()[m_currentFunctionType->result().size() - i - 1]));
             }
@@ -1307,26 +1385,26 @@ public:
 
         ASSERT(peekVMStackSize() == Walrus::valueSizeInStack(toValueKind(Type::I32)));
         auto stackPos = popVMStack();
+        auto comparison = takeLastComparisonIfPossible(stackPos);
 
         auto& blockInfo = findBlockInfoInBr(depth);
         auto dropSize = dropStackValuesBeforeBrIfNeeds(depth);
         if (dropSize.second) {
             size_t pos = m_currentFunction->currentByteCodeSize();
-            pushByteCode(Walrus::JumpIfFalse(stackPos), WASMOpcode::BrIfOpcode);
+            generateJumpIfCode(comparison, stackPos, false, 0, WASMOpcode::BrIfOpcode);
             generateMoveValuesCodeRegardToDrop(dropSize);
             auto offset = (int32_t)blockInfo.m_position - (int32_t)m_currentFunction->currentByteCodeSize();
             if (blockInfo.m_blockType == BlockInfo::Block || blockInfo.m_blockType == BlockInfo::IfElse) {
                 blockInfo.m_jumpToEndBrInfo.push_back({ BlockInfo::JumpToEndBrInfo::IsJump, m_currentFunction->currentByteCodeSize() });
             }
             pushByteCode(Walrus::Jump(offset), WASMOpcode::BrIfOpcode);
-            m_currentFunction->peekByteCode<Walrus::JumpIfFalse>(pos)
-                ->setOffset(m_currentFunction->currentByteCodeSize() - pos);
+            setJumpIfOffset(pos, m_currentFunction->currentByteCodeSize() - pos);
         } else {
             auto offset = (int32_t)blockInfo.m_position - (int32_t)m_currentFunction->currentByteCodeSize();
             if (blockInfo.m_blockType == BlockInfo::Block || blockInfo.m_blockType == BlockInfo::IfElse) {
                 blockInfo.m_jumpToEndBrInfo.push_back({ BlockInfo::JumpToEndBrInfo::IsJumpIf, m_currentFunction->currentByteCodeSize() });
             }
-            pushByteCode(Walrus::JumpIfTrue(stackPos, offset), WASMOpcode::BrIfOpcode);
+            generateJumpIfCode(comparison, stackPos, true, offset, WASMOpcode::BrIfOpcode);
         }
     }
 
@@ -1606,10 +1684,15 @@ public:
         ASSERT(WASMCodeInfo::codeTypeToMemorySize(g_wasmCodeInfo[opcode].m_paramTypes[0]) == peekVMStackSize());
         auto src = popVMStack();
         auto dst = pushVMStack(WASMCodeInfo::codeTypeToMemorySize(g_wasmCodeInfo[opcode].m_resultType));
-        if ((opcode == (int)WASMOpcode::I32LoadOpcode || opcode == (int)WASMOpcode::F32LoadOpcode) && offset == 0) {
+        uint32_t addend;
+        if (takeLastAddImmIfPossible(src, m_lastOpcode[1], addend)) {
+            generateMemoryLoadAddImmCode(code, offset, src, addend, dst);
+        } else if ((opcode == (int)WASMOpcode::I32LoadOpcode || opcode == (int)WASMOpcode::F32LoadOpcode) && offset == 0) {
             pushByteCode(Walrus::Load32(src, dst), code);
         } else if ((opcode == (int)WASMOpcode::I64LoadOpcode || opcode == (int)WASMOpcode::F64LoadOpcode) && offset == 0) {
             pushByteCode(Walrus::Load64(src, dst), code);
+        } else if (offset == 0) {
+            generateMemoryLoadNoOffsetCode(code, src, dst);
         } else {
             generateMemoryLoadCode(code, offset, src, dst);
         }
@@ -1622,10 +1705,16 @@ public:
         auto src1 = popVMStack();
         ASSERT(WASMCodeInfo::codeTypeToMemorySize(g_wasmCodeInfo[opcode].m_paramTypes[0]) == peekVMStackSize());
         auto src0 = popVMStack();
-        if ((opcode == (int)WASMOpcode::I32StoreOpcode || opcode == (int)WASMOpcode::F32StoreOpcode) && offset == 0) {
+        uint32_t addend;
+        // the stored value can be read from a local between the address and the store
+        if (m_lastOpcode[1] == static_cast<uint32_t>(WASMOpcode::LocalGetOpcode) && takeLastAddImmIfPossible(src0, m_lastOpcode[2], addend)) {
+            generateMemoryStoreAddImmCode(code, offset, src0, addend, src1);
+        } else if ((opcode == (int)WASMOpcode::I32StoreOpcode || opcode == (int)WASMOpcode::F32StoreOpcode) && offset == 0) {
             pushByteCode(Walrus::Store32(src0, src1), code);
         } else if ((opcode == (int)WASMOpcode::I64StoreOpcode || opcode == (int)WASMOpcode::F64StoreOpcode) && offset == 0) {
             pushByteCode(Walrus::Store64(src0, src1), code);
+        } else if (offset == 0) {
+            generateMemoryStoreNoOffsetCode(code, src0, src1);
         } else {
             generateMemoryStoreCode(code, offset, src0, src1);
         }
@@ -1674,8 +1763,9 @@ public:
     {
         if (m_blockInfo.size()) {
             auto dropSize = dropStackValuesBeforeBrIfNeeds(0);
-            auto blockInfo = m_blockInfo.back();
+            auto blockInfo = std::move(m_blockInfo.back());
             m_blockInfo.pop_back();
+            removeParameterPositions(blockInfo);
 
 #if !defined(NDEBUG)
             if (!blockInfo.m_shouldRestoreVMStackAtEnd) {
@@ -1693,16 +1783,17 @@ public:
                         iter++;
                         continue;
                     }
-                    size_t stackSizeToBe = m_initialFunctionStackSize;
-                    for (size_t i = 0; i < blockInfo.m_vmStack.size(); i++) {
-                        stackSizeToBe += m_vmStack[i].m_size;
-                    }
+                    size_t stackSizeToBe = stackSizeAtBlockStart(blockInfo);
                     m_currentFunction->m_catchInfo.push_back({ iter->m_tryStart, iter->m_tryEnd, iter->m_catchStart, stackSizeToBe, iter->m_tagIndex });
                     iter = m_catchInfo.erase(iter);
                 }
                 break;
             }
             case BlockInfo::Loop:
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+                m_currentFunction->m_loopInfo.push_back({ blockInfo.m_position, m_currentFunction->currentByteCodeSize() });
+#endif
+                FALLTHROUGH;
             case BlockInfo::Block: {
                 if (blockInfo.m_byteCodeGenerationStopped && blockInfo.m_jumpToEndBrInfo.size() == 0) {
                     stopToGenerateByteCodeWhileBlockEnd();
@@ -1743,8 +1834,7 @@ public:
                     m_currentFunction->peekByteCode<Walrus::Jump>(blockInfo.m_jumpToEndBrInfo[i].m_position)->setOffset(m_currentFunction->currentByteCodeSize() - blockInfo.m_jumpToEndBrInfo[i].m_position);
                     break;
                 case BlockInfo::JumpToEndBrInfo::IsJumpIf:
-                    m_currentFunction->peekByteCode<Walrus::JumpIfFalse>(blockInfo.m_jumpToEndBrInfo[i].m_position)
-                        ->setOffset(m_currentFunction->currentByteCodeSize() - blockInfo.m_jumpToEndBrInfo[i].m_position);
+                    setJumpIfOffset(blockInfo.m_jumpToEndBrInfo[i].m_position, m_currentFunction->currentByteCodeSize() - blockInfo.m_jumpToEndBrInfo[i].m_position);
                     break;
                 default:
                     ASSERT(blockInfo.m_jumpToEndBrInfo[i].m_type == BlockInfo::JumpToEndBrInfo::IsBrTable);
@@ -1781,6 +1871,7 @@ public:
 
         ASSERT(m_currentFunction == m_result.m_functions[index]);
         endFunction();
+        m_currentFunctionIndex = std::numeric_limits<Index>::max();
     }
 
     void generateBinaryCode(WASMOpcode code, size_t src0, size_t src1, size_t dst)
@@ -1799,6 +1890,72 @@ public:
         }
     }
 
+    // fold the constant rhs operand which is generated right before into the binary operation
+    bool generateBinaryImmCodeIfPossible(WASMOpcode code, size_t src0, size_t src1, size_t dst)
+    {
+        if (m_lastOpcode[1] != static_cast<uint32_t>(m_lastPushedOpcode)) {
+            return false;
+        }
+
+        if (m_lastPushedOpcode == WASMOpcode::I32ConstOpcode) {
+            if (m_lastByteCodePosition + sizeof(Walrus::Const32) != m_currentFunction->currentByteCodeSize()
+                || m_currentFunction->peekByteCode<Walrus::Const32>(m_lastByteCodePosition)->dstOffset() != src1) {
+                return false;
+            }
+            uint32_t value = m_currentFunction->peekByteCode<Walrus::Const32>(m_lastByteCodePosition)->value();
+            switch (code) {
+#define GENERATE_BINARY_IMM_CODE_CASE(name, baseName, ...)          \
+    case WASMOpcode::baseName##Opcode: {                            \
+        m_currentFunction->shrinkByteCode(sizeof(Walrus::Const32)); \
+        pushByteCode(Walrus::name(src0, value, dst), code);         \
+        return true;                                                \
+    }
+                FOR_EACH_BYTECODE_BINARY_IMM32_OP(GENERATE_BINARY_IMM_CODE_CASE)
+#undef GENERATE_BINARY_IMM_CODE_CASE
+            default:
+                return false;
+            }
+        } else if (m_lastPushedOpcode == WASMOpcode::I64ConstOpcode) {
+            if (m_lastByteCodePosition + sizeof(Walrus::Const64) != m_currentFunction->currentByteCodeSize()
+                || m_currentFunction->peekByteCode<Walrus::Const64>(m_lastByteCodePosition)->dstOffset() != src1) {
+                return false;
+            }
+            uint64_t value = m_currentFunction->peekByteCode<Walrus::Const64>(m_lastByteCodePosition)->value();
+            switch (code) {
+#define GENERATE_BINARY_IMM_CODE_CASE(name, baseName, ...)          \
+    case WASMOpcode::baseName##Opcode: {                            \
+        m_currentFunction->shrinkByteCode(sizeof(Walrus::Const64)); \
+        pushByteCode(Walrus::name(src0, value, dst), code);         \
+        return true;                                                \
+    }
+                FOR_EACH_BYTECODE_BINARY_IMM64_OP(GENERATE_BINARY_IMM_CODE_CASE)
+#undef GENERATE_BINARY_IMM_CODE_CASE
+            default:
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    void setBinaryOperationDstOffset(size_t pos, Walrus::ByteCodeStackOffset dst)
+    {
+        switch (m_currentFunction->peekByteCode<Walrus::ByteCode>(pos)->opcode()) {
+#define GENERATE_BINARY_IMM_CODE_CASE(name, ...) \
+    case Walrus::ByteCode::name##Opcode:
+            FOR_EACH_BYTECODE_BINARY_IMM32_OP(GENERATE_BINARY_IMM_CODE_CASE)
+            m_currentFunction->peekByteCode<Walrus::BinaryImm32Operation>(pos)->setDstOffset(dst);
+            break;
+            FOR_EACH_BYTECODE_BINARY_IMM64_OP(GENERATE_BINARY_IMM_CODE_CASE)
+            m_currentFunction->peekByteCode<Walrus::BinaryImm64Operation>(pos)->setDstOffset(dst);
+            break;
+#undef GENERATE_BINARY_IMM_CODE_CASE
+        default:
+            m_currentFunction->peekByteCode<Walrus::BinaryOperation>(pos)->setDstOffset(dst);
+            break;
+        }
+    }
+
     void generateUnaryCode(WASMOpcode code, size_t src, size_t dst)
     {
         switch (code) {
@@ -1848,6 +2005,91 @@ public:
         }
     }
 
+    void generateMemoryLoadNoOffsetCode(WASMOpcode code, size_t src, size_t dst)
+    {
+        switch (code) {
+#define GENERATE_LOAD_CODE_CASE(name, baseName, readType, writeType) \
+    case WASMOpcode::baseName##Opcode: {                             \
+        pushByteCode(Walrus::name(src, dst), code);                  \
+        break;                                                       \
+    }
+            FOR_EACH_BYTECODE_LOAD_NO_OFFSET_OP(GENERATE_LOAD_CODE_CASE)
+#undef GENERATE_LOAD_CODE_CASE
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+
+    void generateMemoryStoreNoOffsetCode(WASMOpcode code, size_t src0, size_t src1)
+    {
+        switch (code) {
+#define GENERATE_STORE_CODE_CASE(name, baseName, readType, writeType) \
+    case WASMOpcode::baseName##Opcode: {                              \
+        pushByteCode(Walrus::name(src0, src1), code);                 \
+        break;                                                        \
+    }
+            FOR_EACH_BYTECODE_STORE_NO_OFFSET_OP(GENERATE_STORE_CODE_CASE)
+#undef GENERATE_STORE_CODE_CASE
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+
+    void generateMemoryLoadAddImmCode(WASMOpcode code, size_t offset, size_t src, uint32_t value, size_t dst)
+    {
+        switch (code) {
+#define GENERATE_LOAD_CODE_CASE(name, baseName, readType, writeType) \
+    case WASMOpcode::baseName##Opcode: {                             \
+        pushByteCode(Walrus::name(offset, src, value, dst), code);   \
+        break;                                                       \
+    }
+            FOR_EACH_BYTECODE_LOAD_ADD_IMM_OP(GENERATE_LOAD_CODE_CASE)
+#undef GENERATE_LOAD_CODE_CASE
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+
+    void generateMemoryStoreAddImmCode(WASMOpcode code, size_t offset, size_t src0, uint32_t value, size_t src1)
+    {
+        switch (code) {
+#define GENERATE_STORE_CODE_CASE(name, baseName, readType, writeType) \
+    case WASMOpcode::baseName##Opcode: {                              \
+        pushByteCode(Walrus::name(offset, src0, value, src1), code);  \
+        break;                                                        \
+    }
+            FOR_EACH_BYTECODE_STORE_ADD_IMM_OP(GENERATE_STORE_CODE_CASE)
+#undef GENERATE_STORE_CODE_CASE
+        default:
+            ASSERT_NOT_REACHED();
+            break;
+        }
+    }
+
+    // remove the i32.add with a constant which has just computed the address
+    // of a memory access, so the access can compute it by itself
+    bool takeLastAddImmIfPossible(size_t& address, uint32_t lastOpcode, uint32_t& value)
+    {
+        if (lastOpcode != static_cast<uint32_t>(m_lastPushedOpcode) || m_lastPushedOpcode != WASMOpcode::I32AddOpcode
+            || m_lastByteCodePosition + sizeof(Walrus::BinaryImm32Operation) != m_currentFunction->currentByteCodeSize()) {
+            return false;
+        }
+
+        auto code = m_currentFunction->peekByteCode<Walrus::BinaryImm32Operation>(m_lastByteCodePosition);
+        if (code->opcode() != Walrus::ByteCode::I32AddImmOpcode || code->dstOffset() != address) {
+            return false;
+        }
+
+        address = code->srcOffset();
+        value = code->value();
+        m_currentFunction->shrinkByteCode(sizeof(Walrus::BinaryImm32Operation));
+        m_lastPushedOpcode = WASMOpcode::OpcodeKindEnd;
+        return true;
+    }
+
     bool isBinaryOperation(WASMOpcode opcode)
     {
         switch (opcode) {
@@ -1861,7 +2103,118 @@ public:
         }
     }
 
+    bool isComparisonOperation(WASMOpcode opcode)
+    {
+        switch (opcode) {
+#define GENERATE_COMPARE_CODE_CASE(name, ...) \
+    case WASMOpcode::name##Opcode:
+            FOR_EACH_BYTECODE_BINARY_COMPARE_OP(GENERATE_COMPARE_CODE_CASE)
+            FOR_EACH_BYTECODE_UNARY_COMPARE_OP(GENERATE_COMPARE_CODE_CASE)
+#undef GENERATE_COMPARE_CODE_CASE
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // remove the comparison which has just produced the condition value
+    // so the following conditional jump can evaluate it by itself
+    ComparisonInfo takeLastComparisonIfPossible(size_t condPos)
+    {
+        ComparisonInfo info;
+        // the comparison should be the last opcode and its bytecode should not be moved or omitted
+        if (m_lastOpcode[1] != static_cast<uint32_t>(m_lastPushedOpcode) || !isComparisonOperation(m_lastPushedOpcode)) {
+            return info;
+        }
+
+        if (isBinaryOperation(m_lastPushedOpcode)) {
+            if (m_lastByteCodePosition + sizeof(Walrus::BinaryOperation) != m_currentFunction->currentByteCodeSize()) {
+                return info;
+            }
+            auto code = m_currentFunction->peekByteCode<Walrus::BinaryOperation>(m_lastByteCodePosition);
+            if (code->dstOffset() != condPos) {
+                return info;
+            }
+            info.m_srcOffset[0] = code->srcOffset()[0];
+            info.m_srcOffset[1] = code->srcOffset()[1];
+            m_currentFunction->shrinkByteCode(sizeof(Walrus::BinaryOperation));
+        } else {
+            if (m_lastByteCodePosition + sizeof(Walrus::UnaryOperation) != m_currentFunction->currentByteCodeSize()) {
+                return info;
+            }
+            auto code = m_currentFunction->peekByteCode<Walrus::UnaryOperation>(m_lastByteCodePosition);
+            if (code->dstOffset() != condPos) {
+                return info;
+            }
+            info.m_srcOffset[0] = code->srcOffset();
+            m_currentFunction->shrinkByteCode(sizeof(Walrus::UnaryOperation));
+        }
+
+        info.m_opcode = m_lastPushedOpcode;
+        m_lastPushedOpcode = WASMOpcode::OpcodeKindEnd;
+        return info;
+    }
+
+    void generateJumpIfCode(const ComparisonInfo& comparison, size_t condPos, bool jumpIfTrue, int32_t offset, WASMOpcode code)
+    {
+        switch (comparison.m_opcode) {
+#define GENERATE_BINARY_COMPARE_JUMP_CODE_CASE(name, ...)                                                                \
+    case WASMOpcode::name##Opcode: {                                                                                     \
+        if (jumpIfTrue) {                                                                                                \
+            pushByteCode(Walrus::name##JumpIfTrue(comparison.m_srcOffset[0], comparison.m_srcOffset[1], offset), code);  \
+        } else {                                                                                                         \
+            pushByteCode(Walrus::name##JumpIfFalse(comparison.m_srcOffset[0], comparison.m_srcOffset[1], offset), code); \
+        }                                                                                                                \
+        break;                                                                                                           \
+    }
+#define GENERATE_UNARY_COMPARE_JUMP_CODE_CASE(name, ...)                                      \
+    case WASMOpcode::name##Opcode: {                                                          \
+        if (jumpIfTrue) {                                                                     \
+            pushByteCode(Walrus::name##JumpIfTrue(comparison.m_srcOffset[0], offset), code);  \
+        } else {                                                                              \
+            pushByteCode(Walrus::name##JumpIfFalse(comparison.m_srcOffset[0], offset), code); \
+        }                                                                                     \
+        break;                                                                                \
+    }
+            FOR_EACH_BYTECODE_BINARY_COMPARE_OP(GENERATE_BINARY_COMPARE_JUMP_CODE_CASE)
+            FOR_EACH_BYTECODE_UNARY_COMPARE_OP(GENERATE_UNARY_COMPARE_JUMP_CODE_CASE)
+#undef GENERATE_BINARY_COMPARE_JUMP_CODE_CASE
+#undef GENERATE_UNARY_COMPARE_JUMP_CODE_CASE
+        default:
+            ASSERT(comparison.m_opcode == WASMOpcode::OpcodeKindEnd);
+            if (jumpIfTrue) {
+                pushByteCode(Walrus::JumpIfTrue(condPos, offset), code);
+            } else {
+                pushByteCode(Walrus::JumpIfFalse(condPos, offset), code);
+            }
+            break;
+        }
+    }
+
+    void setJumpIfOffset(size_t pos, int32_t offset)
+    {
+        switch (m_currentFunction->peekByteCode<Walrus::ByteCode>(pos)->opcode()) {
+#define GENERATE_COMPARE_JUMP_CODE_CASE(name, ...) \
+    case Walrus::ByteCode::name##Opcode:
+            FOR_EACH_BYTECODE_BINARY_COMPARE_JUMP_OP(GENERATE_COMPARE_JUMP_CODE_CASE)
+            m_currentFunction->peekByteCode<Walrus::BinaryCompareJump>(pos)->setOffset(offset);
+            break;
+            FOR_EACH_BYTECODE_UNARY_COMPARE_JUMP_OP(GENERATE_COMPARE_JUMP_CODE_CASE)
+            m_currentFunction->peekByteCode<Walrus::UnaryCompareJump>(pos)->setOffset(offset);
+            break;
+#undef GENERATE_COMPARE_JUMP_CODE_CASE
+        case Walrus::ByteCode::JumpIfTrueOpcode:
+            m_currentFunction->peekByteCode<Walrus::JumpIfTrue>(pos)->setOffset(offset);
+            break;
+        default:
+            ASSERT(m_currentFunction->peekByteCode<Walrus::ByteCode>(pos)->opcode() == Walrus::ByteCode::JumpIfFalseOpcode);
+            m_currentFunction->peekByteCode<Walrus::JumpIfFalse>(pos)->setOffset(offset);
+            break;
+        }
+    }
+
     Walrus::WASMParsingResult& parsingResult() { return m_result; }
+    const std::vector<FunctionBody>& skippedFunctionBodies() const { return m_skippedFunctionBodies; }
 };
 
 } // namespace wabt
@@ -1918,16 +2271,325 @@ void WASMParsingResult::clear()
     }
 }
 
+LazyFunctionCompiler::LazyFunctionCompiler(const std::string& filename, const uint8_t* data, size_t len,
+                                           std::vector<DirectReferenceScanner::UpdatedLocal>&& updatedLocals, const WASMParsingResult& result)
+    : m_filename(filename)
+    , m_binary(data, data + len)
+    , m_updatedLocals(std::move(updatedLocals))
+{
+    // the bytecode refers to these, the other parts of the module are not
+    // needed to compile a function
+    m_module.m_functions = result.m_functions;
+    m_module.m_functionTypes = result.m_functionTypes;
+    m_module.m_globalTypes = result.m_globalTypes;
+    m_module.m_tableTypes = result.m_tableTypes;
+    m_module.m_memoryTypes = result.m_memoryTypes;
+    m_module.m_tagTypes = result.m_tagTypes;
+}
+
+void LazyFunctionCompiler::addFunctionBody(uint32_t functionIndex, size_t offset, size_t size)
+{
+    ModuleFunction* function = m_module.m_functions[functionIndex];
+    function->m_lazyCompiler.store(this, std::memory_order_relaxed);
+    function->m_lazyBodyIndex = m_functionBodies.size();
+    m_functionBodies.push_back({ functionIndex, offset, size });
+}
+
+std::string LazyFunctionCompiler::compile(ModuleFunction* function)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (function->isCompiled()) {
+        return std::string();
+    }
+
+    const FunctionBody& body = m_functionBodies[function->m_lazyBodyIndex];
+    wabt::WASMBinaryReader delegate(m_updatedLocals, &m_module);
+    std::string error = ReadWasmFunctionBody(m_filename, m_binary.data(), m_binary.size(), m_module.m_memoryTypes.size(),
+                                             body.m_functionIndex, body.m_offset, body.m_size, &delegate);
+    if (error.length()) {
+        // the function stays uncompiled, so every call reports the error
+        function->m_local.clear();
+        function->m_byteCode.clear();
+        function->m_catchInfo.clear();
+        function->m_loopInfo.clear();
+        function->m_requiredStackSizeDueToLocal = 0;
+        return error;
+    }
+
+    StackSlotAllocator::Statistics stats;
+    StackSlotAllocator::allocate(function, m_module, stats);
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    BoundsCheckEliminator::Statistics boundsCheckStats;
+    BoundsCheckEliminator::hoistLoopChecks(function, m_module, boundsCheckStats);
+    BoundsCheckEliminator::eliminate(function, m_module, boundsCheckStats);
+#endif
+
+    // the threads which see the function compiled see its bytecode too
+    function->m_lazyCompiler.store(nullptr, std::memory_order_release);
+    return std::string();
+}
+
+// runs the jobs on the compilation threads of the engine if there are
+static void forEachJob(ThreadPool* threadPool, size_t count, const std::function<void(size_t worker, size_t index)>& job)
+{
+    if (threadPool) {
+        threadPool->parallelFor(count, job);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        job(0, i);
+    }
+}
+
 std::pair<Optional<Module*>, std::string> WASMParser::parseBinary(Store* store, const std::string& filename, const uint8_t* data, size_t len)
 {
-    wabt::WASMBinaryReader delegate;
+    // the locals are known before the functions are compiled, so every
+    // function is compiled once
+    auto scanResult = DirectReferenceScanner::scan(filename, data, len);
+    if (scanResult.second.length()) {
+        return std::make_pair(nullptr, scanResult.second);
+    }
 
-    std::string error = ReadWasmBinary(filename, data, len, &delegate);
+    // the scan validated the function bodies, so the threads can compile
+    // them independently after the other sections are read
+    bool lazyCompilation = store->engine()->lazyCompilation();
+    ThreadPool* threadPool = lazyCompilation ? nullptr : store->engine()->compilationThreadPool();
+    size_t workerCount = threadPool ? threadPool->workerCount() : 1;
+    wabt::WASMBinaryReader delegate(scanResult.first);
+
+    std::string error = ReadWasmBinary(filename, data, len, &delegate, lazyCompilation || threadPool);
     if (error.length()) {
         return std::make_pair(nullptr, error);
     }
 
-    Module* module = new Module(store, delegate.parsingResult());
+    WASMParsingResult& result = delegate.parsingResult();
+    if (threadPool) {
+        const auto& bodies = delegate.skippedFunctionBodies();
+        std::vector<std::string> errors(bodies.size());
+        threadPool->parallelFor(bodies.size(), [&](size_t worker, size_t index) {
+            wabt::WASMBinaryReader bodyReader(scanResult.first, &result);
+            errors[index] = ReadWasmFunctionBody(filename, data, len, result.m_memoryTypes.size(), bodies[index].m_index, bodies[index].m_offset, bodies[index].m_size, &bodyReader);
+        });
+
+        // report the error of the first function like the serial compilation
+        for (size_t i = 0; i < errors.size(); i++) {
+            if (errors[i].length()) {
+                return std::make_pair(nullptr, errors[i]);
+            }
+        }
+    }
+#if defined(WALRUS_BYTECODE_STATS)
+    fprintf(stderr, "direct reference scan of %s: %zu updated locals\n",
+            filename.c_str(), scanResult.first.size());
+#endif
+
+    if (lazyCompilation) {
+        LazyFunctionCompiler* compiler = new LazyFunctionCompiler(filename, data, len, std::move(scanResult.first), result);
+        for (const auto& body : delegate.skippedFunctionBodies()) {
+            compiler->addFunctionBody(body.m_index, body.m_offset, body.m_size);
+        }
+        Module* module = new Module(store, result, compiler);
+        return std::make_pair(module, std::string());
+    }
+
+    std::vector<StackSlotAllocator::Statistics> stats(workerCount);
+    forEachJob(threadPool, result.m_functions.size(), [&](size_t worker, size_t index) {
+        StackSlotAllocator::allocate(result.m_functions[index], result, stats[worker]);
+    });
+    for (size_t i = 1; i < workerCount; i++) {
+        stats[0].merge(stats[i]);
+    }
+#if defined(WALRUS_BYTECODE_STATS)
+    fprintf(stderr, "stack slot allocation of %s: frame size %zu -> %zu bytes, moves %zu -> %zu\n",
+            filename.c_str(), stats[0].m_frameSizeBefore, stats[0].m_frameSizeAfter, stats[0].m_moveCountBefore, stats[0].m_moveCountAfter);
+#endif
+
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    // with guard pages every access is already unchecked
+    std::vector<BoundsCheckEliminator::Statistics> boundsCheckStats(workerCount);
+    forEachJob(threadPool, result.m_functions.size(), [&](size_t worker, size_t index) {
+        BoundsCheckEliminator::hoistLoopChecks(result.m_functions[index], result, boundsCheckStats[worker]);
+        BoundsCheckEliminator::eliminate(result.m_functions[index], result, boundsCheckStats[worker]);
+    });
+    for (size_t i = 1; i < workerCount; i++) {
+        boundsCheckStats[0].merge(boundsCheckStats[i]);
+    }
+#if defined(WALRUS_BYTECODE_STATS)
+    fprintf(stderr, "loop bounds check hoisting of %s: %zu of %zu loops hoisted\n",
+            filename.c_str(), boundsCheckStats[0].m_hoistedLoopCount, boundsCheckStats[0].m_loopCount);
+    fprintf(stderr, "bounds check elimination of %s: %zu of %zu memory accesses unchecked\n",
+            filename.c_str(), boundsCheckStats[0].m_uncheckedCount, boundsCheckStats[0].m_accessCount);
+#endif
+#endif
+
+    Module* module = new Module(store, result);
+    return std::make_pair(module, std::string());
+}
+
+std::pair<Optional<Module*>, std::string> WASMParser::parseFileDescriptor(Store* store, const std::string& filename, int fd, size_t chunkSize)
+{
+    WASMStreamingParser parser(store, filename);
+    std::vector<uint8_t> chunk(chunkSize);
+    while (true) {
+        ssize_t size = read(fd, chunk.data(), chunk.size());
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::make_pair(nullptr, std::string("cannot read ") + filename + ": " + strerror(errno));
+        }
+        if (size == 0) {
+            break;
+        }
+        if (parser.append(chunk.data(), size).length()) {
+            // finish reports the error
+            break;
+        }
+    }
+    return parser.finish();
+}
+
+struct WASMStreamingParser::State {
+    State(const std::string& filename, size_t workerCount)
+        : m_scanner(filename)
+        , m_reader(m_scanner.updatedLocals())
+        , m_moduleReader(filename, &m_reader, true)
+        , m_compiledBodyCount(0)
+        , m_stats(workerCount)
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+        , m_boundsCheckStats(workerCount)
+#endif
+    {
+    }
+
+    // validates the module and finds the updated locals of each body
+    DirectReferenceScanner::Stream m_scanner;
+    // reads the module with the function bodies skipped, every body is
+    // compiled by its own reader like on the compilation threads
+    wabt::WASMBinaryReader m_reader;
+    wabt::WASMStreamingBinaryReader m_moduleReader;
+    size_t m_compiledBodyCount;
+
+    // one per worker
+    std::vector<StackSlotAllocator::Statistics> m_stats;
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    std::vector<BoundsCheckEliminator::Statistics> m_boundsCheckStats;
+#endif
+};
+
+WASMStreamingParser::WASMStreamingParser(Store* store, const std::string& filename)
+    : m_store(store)
+    , m_filename(filename)
+    , m_state(nullptr)
+{
+    if (!store->engine()->lazyCompilation()) {
+        ThreadPool* threadPool = store->engine()->compilationThreadPool();
+        m_state = new State(filename, threadPool ? threadPool->workerCount() : 1);
+    }
+}
+
+WASMStreamingParser::~WASMStreamingParser()
+{
+    delete m_state;
+}
+
+std::string WASMStreamingParser::append(const uint8_t* data, size_t len)
+{
+    if (m_error.length()) {
+        return m_error;
+    }
+
+    m_binary.insert(m_binary.end(), data, data + len);
+    if (!m_state) {
+        return std::string();
+    }
+
+    // the scan validates the bodies before they are compiled, and both
+    // readers stop after the same complete bodies
+    m_error = m_state->m_scanner.read(m_binary.data(), m_binary.size());
+    if (m_error.empty()) {
+        m_error = m_state->m_moduleReader.read(m_binary.data(), m_binary.size());
+    }
+    if (m_error.empty()) {
+        m_error = compileFunctionBodies();
+    }
+    return m_error;
+}
+
+std::string WASMStreamingParser::compileFunctionBodies()
+{
+    const auto& bodies = m_state->m_reader.skippedFunctionBodies();
+    size_t first = m_state->m_compiledBodyCount;
+    WASMParsingResult& result = m_state->m_reader.parsingResult();
+    const auto& updatedLocals = m_state->m_scanner.updatedLocals();
+
+    std::vector<std::string> errors(bodies.size() - first);
+    forEachJob(m_store->engine()->compilationThreadPool(), errors.size(), [&](size_t worker, size_t index) {
+        const auto& body = bodies[first + index];
+        wabt::WASMBinaryReader bodyReader(updatedLocals, &result);
+        errors[index] = ReadWasmFunctionBody(m_filename, m_binary.data(), m_binary.size(), result.m_memoryTypes.size(), body.m_index, body.m_offset, body.m_size, &bodyReader);
+        if (errors[index].length()) {
+            return;
+        }
+
+        // the post passes only need the function and the types of the module
+        ModuleFunction* function = result.m_functions[body.m_index];
+        StackSlotAllocator::allocate(function, result, m_state->m_stats[worker]);
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+        BoundsCheckEliminator::hoistLoopChecks(function, result, m_state->m_boundsCheckStats[worker]);
+        BoundsCheckEliminator::eliminate(function, result, m_state->m_boundsCheckStats[worker]);
+#endif
+    });
+    m_state->m_compiledBodyCount = bodies.size();
+
+    // report the error of the first function like the serial compilation
+    for (size_t i = 0; i < errors.size(); i++) {
+        if (errors[i].length()) {
+            return errors[i];
+        }
+    }
+    return std::string();
+}
+
+std::pair<Optional<Module*>, std::string> WASMStreamingParser::finish()
+{
+    if (!m_state) {
+        return WASMParser::parseBinary(m_store, m_filename, m_binary.data(), m_binary.size());
+    }
+
+    if (m_error.empty()) {
+        m_error = m_state->m_scanner.finish();
+    }
+    if (m_error.empty()) {
+        m_error = m_state->m_moduleReader.finish();
+    }
+    if (m_error.length()) {
+        return std::make_pair(nullptr, m_error);
+    }
+
+#if defined(WALRUS_BYTECODE_STATS)
+    size_t workerCount = m_state->m_stats.size();
+    for (size_t i = 1; i < workerCount; i++) {
+        m_state->m_stats[0].merge(m_state->m_stats[i]);
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+        m_state->m_boundsCheckStats[0].merge(m_state->m_boundsCheckStats[i]);
+#endif
+    }
+    const auto& stats = m_state->m_stats[0];
+    fprintf(stderr, "direct reference scan of %s: %zu updated locals\n",
+            m_filename.c_str(), m_state->m_scanner.updatedLocals().size());
+    fprintf(stderr, "stack slot allocation of %s: frame size %zu -> %zu bytes, moves %zu -> %zu\n",
+            m_filename.c_str(), stats.m_frameSizeBefore, stats.m_frameSizeAfter, stats.m_moveCountBefore, stats.m_moveCountAfter);
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    const auto& boundsCheckStats = m_state->m_boundsCheckStats[0];
+    fprintf(stderr, "loop bounds check hoisting of %s: %zu of %zu loops hoisted\n",
+            m_filename.c_str(), boundsCheckStats.m_hoistedLoopCount, boundsCheckStats.m_loopCount);
+    fprintf(stderr, "bounds check elimination of %s: %zu of %zu memory accesses unchecked\n",
+            m_filename.c_str(), boundsCheckStats.m_uncheckedCount, boundsCheckStats.m_accessCount);
+#endif
+#endif
+
+    Module* module = new Module(m_store, m_state->m_reader.parsingResult());
     return std::make_pair(module, std::string());
 }
 
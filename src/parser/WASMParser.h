@@ -18,6 +18,7 @@
 #define __WalrusWASMParser__
 
 #include "runtime/Module.h"
+#include "parser/DirectReferenceScanner.h"
 
 namespace Walrus {
 
@@ -55,6 +56,68 @@ class WASMParser {
 public:
     // returns <result, error>
     static std::pair<Optional<Module*>, std::string> parseBinary(Store* store, const std::string& filename, const uint8_t* data, size_t len);
+    // reads the module from fd chunkSize bytes at a time and compiles it
+    // with a WASMStreamingParser, returns <result, error>
+    static std::pair<Optional<Module*>, std::string> parseFileDescriptor(Store* store, const std::string& filename, int fd, size_t chunkSize = 64 * 1024);
+};
+
+// Parses a module whose bytes arrive in chunks, e.g. from a pipe or a
+// socket. The module is validated as its bytes arrive, and each function is
+// compiled in the append call which completes its body, on the compilation
+// threads of the engine if there are. With lazy compilation there is
+// nothing to compile early, so the module is parsed when it is finished.
+class WASMStreamingParser {
+public:
+    WASMStreamingParser(Store* store, const std::string& filename);
+    ~WASMStreamingParser();
+
+    // returns the error, the parser stops at the first error and reports
+    // it from every later call
+    std::string append(const uint8_t* data, size_t len);
+    // returns <result, error> when no more bytes arrive
+    std::pair<Optional<Module*>, std::string> finish();
+
+private:
+    std::string compileFunctionBodies();
+
+    // the readers of the module, defined with the bytecode generator
+    struct State;
+
+    Store* m_store;
+    std::string m_filename;
+    std::vector<uint8_t> m_binary;
+    std::string m_error;
+    State* m_state;
+};
+
+// Generates the bytecode of the functions of a module on their first call.
+// The module was validated when it was loaded, and the compiler keeps a
+// copy of its binary.
+class LazyFunctionCompiler {
+public:
+    LazyFunctionCompiler(const std::string& filename, const uint8_t* data, size_t len,
+                         std::vector<DirectReferenceScanner::UpdatedLocal>&& updatedLocals, const WASMParsingResult& result);
+
+    void addFunctionBody(uint32_t functionIndex, size_t offset, size_t size);
+
+    // returns the error, only the limits of the bytecode can fail
+    std::string compile(ModuleFunction* function);
+
+private:
+    struct FunctionBody {
+        uint32_t m_functionIndex;
+        size_t m_offset;
+        size_t m_size;
+    };
+
+    // one function is compiled at a time
+    std::mutex m_mutex;
+    std::string m_filename;
+    std::vector<uint8_t> m_binary;
+    std::vector<DirectReferenceScanner::UpdatedLocal> m_updatedLocals;
+    std::vector<FunctionBody> m_functionBodies;
+    // refers to the functions and types of the module without owning them
+    WASMParsingResult m_module;
 };
 
 } // namespace Walrus
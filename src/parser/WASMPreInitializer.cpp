@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Walrus.h"
+
+#include "parser/WASMPreInitializer.h"
+#include "runtime/Instance.h"
+#include "runtime/Module.h"
+#include "runtime/Function.h"
+#include "runtime/Global.h"
+#include "runtime/Table.h"
+#include "runtime/Memory.h"
+#include "runtime/Trap.h"
+
+#include "wabt/walrus/pre-initializer-walrus.h"
+
+namespace Walrus {
+
+// collects the state of the instance which is written into the module
+class PreInitializedStateBuilder {
+public:
+    PreInitializedStateBuilder(Instance* instance)
+        : m_instance(instance)
+    {
+        for (size_t i = 0; i < instance->module()->numberOfFunctions(); i++) {
+            m_functionIndices.insert(std::make_pair(instance->function(i), i));
+        }
+    }
+
+    std::string build(wabt::PreInitializedState& state)
+    {
+        Module* module = m_instance->module();
+        size_t globalImportCount = 0;
+        for (auto import : module->imports()) {
+            if (import->importType() == ImportType::Global) {
+                globalImportCount++;
+            } else if (import->importType() == ImportType::Table || import->importType() == ImportType::Memory) {
+                return "imported memories and tables are not supported";
+            }
+        }
+
+        state.functionCount = module->numberOfFunctions();
+
+        for (size_t i = globalImportCount; i < module->numberOfGlobalTypes(); i++) {
+            Value value = m_instance->global(i)->value();
+            wabt::PreInitializedValue result;
+            switch (value.type()) {
+            case Value::I32:
+                result = { wabt::PreInitializedValue::I32, static_cast<uint32_t>(value.asI32()) };
+                break;
+            case Value::I64:
+                result = { wabt::PreInitializedValue::I64, static_cast<uint64_t>(value.asI64()) };
+                break;
+            case Value::F32:
+                result = { wabt::PreInitializedValue::F32, value.asF32Bits() };
+                break;
+            case Value::F64:
+                result = { wabt::PreInitializedValue::F64, value.asF64Bits() };
+                break;
+            case Value::FuncRef:
+            case Value::ExternRef:
+                if (!reference(value.type() == Value::FuncRef ? reinterpret_cast<void*>(value.asFunction()) : value.asExternal(), result)) {
+                    return "global " + std::to_string(i) + " refers to a host object or a foreign function";
+                }
+                break;
+            default:
+                RELEASE_ASSERT_NOT_REACHED();
+                break;
+            }
+            state.globals.push_back(result);
+        }
+
+        for (size_t i = 0; i < module->numberOfTableTypes(); i++) {
+            Table* table = m_instance->table(i);
+            wabt::PreInitializedTable result;
+            result.size = table->size();
+
+            // the elements between the first and the last non null element
+            uint32_t begin = 0;
+            uint32_t end = table->size();
+            while (begin < end && Value::isNull(table->uncheckedGetElement(begin))) {
+                begin++;
+            }
+            while (begin < end && Value::isNull(table->uncheckedGetElement(end - 1))) {
+                end--;
+            }
+            result.offset = begin;
+            for (uint32_t j = begin; j < end; j++) {
+                wabt::PreInitializedValue element;
+                if (!reference(table->uncheckedGetElement(j), element)) {
+                    return "table " + std::to_string(i) + " refers to a host object or a foreign function";
+                }
+                result.elements.push_back(element);
+            }
+            state.tables.push_back(std::move(result));
+        }
+
+        for (size_t i = 0; i < module->numberOfMemoryTypes(); i++) {
+            Memory* memory = m_instance->memory(i);
+            state.memories.push_back({ memory->sizeInPageSize(), memory->buffer(), memory->sizeInByte() });
+        }
+
+        for (size_t i = 0; i < module->numberOfDataSegments(); i++) {
+            state.droppedDataSegments.push_back(m_instance->dataSegment(i).sizeInByte() == 0);
+        }
+        for (size_t i = 0; i < module->numberOfElementSegments(); i++) {
+            state.droppedElemSegments.push_back(!m_instance->elementSegment(i).element());
+        }
+        return std::string();
+    }
+
+private:
+    // only references to the functions of the instance can be written
+    bool reference(void* reference, wabt::PreInitializedValue& result)
+    {
+        if (Value::isNull(reference)) {
+            result = { wabt::PreInitializedValue::RefNull, 0 };
+            return true;
+        }
+
+        auto iter = m_functionIndices.find(reference);
+        if (iter == m_functionIndices.end()) {
+            return false;
+        }
+        result = { wabt::PreInitializedValue::RefFunc, iter->second };
+        return true;
+    }
+
+    Instance* m_instance;
+    std::unordered_map<void*, uint32_t> m_functionIndices;
+};
+
+std::pair<std::vector<uint8_t>, std::string> WASMPreInitializer::preInitialize(Instance* instance, const std::string& initExportName,
+                                                                               const std::string& filename, const uint8_t* data, size_t len)
+{
+#if defined(WALRUS_BIG_ENDIAN)
+    return std::make_pair(std::vector<uint8_t>(), "pre-initialization is not supported on big endian hosts");
+#endif
+
+    if (!initExportName.empty()) {
+        std::string name = initExportName;
+        Function* function = instance->resolveExportFunction(name);
+        if (!function) {
+            return std::make_pair(std::vector<uint8_t>(), "unknown init export: " + initExportName);
+        }
+        if (function->functionType()->param().size() || function->functionType()->result().size()) {
+            return std::make_pair(std::vector<uint8_t>(), "init export must not have params and results: " + initExportName);
+        }
+
+        Trap trap;
+        auto result = trap.run([](ExecutionState& state, void* function) {
+            reinterpret_cast<Function*>(function)->call(state, 0, nullptr, nullptr);
+        },
+                               function);
+        if (result.exception) {
+            return std::make_pair(std::vector<uint8_t>(), result.exception->message());
+        }
+    }
+
+    wabt::PreInitializedState state;
+    std::string error = PreInitializedStateBuilder(instance).build(state);
+    if (!error.empty()) {
+        return std::make_pair(std::vector<uint8_t>(), error);
+    }
+
+    std::vector<uint8_t> binary;
+    error = wabt::PreInitializeWasmBinary(filename, data, len, state, &binary);
+    return std::make_pair(std::move(binary), error);
+}
+
+} // namespace Walrus
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusWASMPreInitializer__
+#define __WalrusWASMPreInitializer__
+
+namespace Walrus {
+
+class Instance;
+
+class WASMPreInitializer {
+public:
+    // Calls the init export of an instance created from the binary, if the
+    // name is not empty, and rewrites the binary to a module which starts in
+    // the resulting state: its data segments hold the memory image, its
+    // globals and tables the current values, and it has no start function.
+    // returns <binary, error>
+    static std::pair<std::vector<uint8_t>, std::string> preInitialize(Instance* instance, const std::string& initExportName,
+                                                                      const std::string& filename, const uint8_t* data, size_t len);
+};
+
+} // namespace Walrus
+
+#endif // __WalrusWASMPreInitializer__
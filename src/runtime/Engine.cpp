@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "runtime/Engine.h"
+#include "runtime/InstancePool.h"
+#include "runtime/ThreadPool.h"
+
+namespace Walrus {
+
+Engine::Engine()
+    : m_instancePool(nullptr)
+    , m_compilationThreadPool(nullptr)
+    , m_lazyCompilation(false)
+{
+}
+
+Engine::~Engine()
+{
+    delete m_instancePool;
+    delete m_compilationThreadPool;
+}
+
+void Engine::enableInstancePool(size_t instanceCount, const InstancePoolLimits& limits)
+{
+    // instances of the previous pool may still be alive
+    RELEASE_ASSERT(!m_instancePool);
+    m_instancePool = new InstancePool(instanceCount, limits);
+}
+
+void Engine::enableCompilationThreads(size_t threadCount)
+{
+    RELEASE_ASSERT(!m_compilationThreadPool);
+    m_compilationThreadPool = new ThreadPool(threadCount);
+}
+
+} // namespace Walrus
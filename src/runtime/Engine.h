@@ -19,7 +19,50 @@
 
 namespace Walrus {
 
+class InstancePool;
+struct InstancePoolLimits;
+class ThreadPool;
+
 class Engine {
+public:
+    Engine();
+    ~Engine();
+
+    // Instances of the modules which fit in the limits are created in one of
+    // instanceCount preallocated slots while a slot is free, and go back to
+    // the pool when they are released by Store::releaseInstance.
+    void enableInstancePool(size_t instanceCount, const InstancePoolLimits& limits);
+
+    InstancePool* instancePool() const
+    {
+        return m_instancePool;
+    }
+
+    // The function bodies of the modules are compiled by threadCount
+    // threads besides the thread which parses the module.
+    void enableCompilationThreads(size_t threadCount);
+
+    ThreadPool* compilationThreadPool() const
+    {
+        return m_compilationThreadPool;
+    }
+
+    // The modules are only validated when they are loaded, and the bytecode
+    // of their functions is generated on the first call.
+    void enableLazyCompilation()
+    {
+        m_lazyCompilation = true;
+    }
+
+    bool lazyCompilation() const
+    {
+        return m_lazyCompilation;
+    }
+
+private:
+    InstancePool* m_instancePool;
+    ThreadPool* m_compilationThreadPool;
+    bool m_lazyCompilation;
 };
 
 } // namespace Walrus
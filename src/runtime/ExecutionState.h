@@ -22,6 +22,7 @@
 namespace Walrus {
 
 class Function;
+struct InterpreterFrame;
 
 class ExecutionState {
 public:
@@ -70,6 +71,8 @@ private:
     Optional<Function*> m_currentFunction;
     size_t m_stackLimit;
     Optional<size_t*> m_programCounterPointer;
+    // innermost frame called by the interpreter loop without native recursion
+    Optional<InterpreterFrame*> m_interpreterFrame;
 };
 
 } // namespace Walrus
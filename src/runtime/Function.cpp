@@ -21,6 +21,7 @@
 #include "interpreter/Interpreter.h"
 #include "runtime/Module.h"
 #include "runtime/Value.h"
+#include "runtime/ValueStack.h"
 
 namespace Walrus {
 
@@ -45,7 +46,11 @@ void DefinedFunction::call(ExecutionState& state, const uint32_t argc, Value* ar
 {
     ExecutionState newState(state, this);
     checkStackLimit(newState);
-    ALLOCA(uint8_t, functionStackBase, m_moduleFunction->requiredStackSize(), isAlloca);
+    if (UNLIKELY(!m_moduleFunction->isCompiled())) {
+        Interpreter::compileFunction(newState, m_moduleFunction);
+    }
+    ValueStackFrame frame(newState, m_moduleFunction->requiredStackSize());
+    uint8_t* functionStackBase = frame.base();
     uint8_t* functionStackPointer = functionStackBase;
 
     // init parameter space
@@ -91,10 +96,6 @@ void DefinedFunction::call(ExecutionState& state, const uint32_t argc, Value* ar
     for (size_t i = 0; i < resultTypeInfo.size(); i++) {
         result[i] = Value(resultTypeInfo[i], functionStackBase + resultOffsets[i]);
     }
-
-    if (UNLIKELY(!isAlloca)) {
-        delete[] functionStackBase;
-    }
 }
 
 ImportedFunction* ImportedFunction::createImportedFunction(Store* store,
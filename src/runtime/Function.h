@@ -106,6 +106,7 @@ protected:
 
 class DefinedFunction : public Function {
     friend class Module;
+    friend class InstancePool;
 
 public:
     static DefinedFunction* createDefinedFunction(Store* store,
@@ -24,6 +24,8 @@
 #include "runtime/Memory.h"
 #include "runtime/Global.h"
 #include "runtime/Tag.h"
+#include "runtime/Engine.h"
+#include "runtime/InstancePool.h"
 
 namespace Walrus {
 
@@ -33,7 +35,7 @@ Instance* Instance::newInstance(Module* module)
     size_t numberOfRefs = module->numberOfMemoryTypes() + module->numberOfGlobalTypes()
         + module->numberOfTableTypes() + module->numberOfFunctions() + module->numberOfTagTypes();
 
-    void* result = malloc(alignedSize() + numberOfRefs * sizeof(void*));
+    void* result = malloc(allocationSize(numberOfRefs, module->numberOfDataSegments(), module->numberOfElementSegments()));
 
     // Placement new.
     new (result) Instance(module);
@@ -44,6 +46,12 @@ Instance* Instance::newInstance(Module* module)
 
 void Instance::freeInstance(Instance* instance)
 {
+    InstancePool* pool = instance->module()->store()->engine()->instancePool();
+    if (pool && pool->contains(instance)) {
+        pool->freeInstance(instance);
+        return;
+    }
+
     instance->~Instance();
 
     free(reinterpret_cast<void*>(instance));
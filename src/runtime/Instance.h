@@ -77,6 +77,8 @@ private:
 class Instance : public Object {
     friend class Module;
     friend class Interpreter;
+    friend class InstanceSnapshot;
+    friend class InstancePool;
 
 public:
     typedef Vector<Instance*, std::allocator<Instance*>> InstanceVector;
@@ -129,6 +131,13 @@ private:
         return (sizeof(Instance) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
     }
 
+    // the references and the segments are stored after the instance
+    static size_t allocationSize(size_t numberOfReferences, size_t numberOfDataSegments, size_t numberOfElementSegments)
+    {
+        return alignedSize() + numberOfReferences * sizeof(void*)
+            + numberOfDataSegments * sizeof(DataSegment) + numberOfElementSegments * sizeof(ElementSegment);
+    }
+
     Module* m_module;
 
     // The initialization in Module::instantiate and Instance::newInstance must follow this order.
@@ -139,8 +148,8 @@ private:
     Function** m_functions;
     Tag** m_tags;
 
-    VectorWithFixedSize<DataSegment, std::allocator<DataSegment>> m_dataSegments;
-    VectorWithFixedSize<ElementSegment, std::allocator<ElementSegment>> m_elementSegments;
+    DataSegment* m_dataSegments;
+    ElementSegment* m_elementSegments;
 };
 } // namespace Walrus
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "runtime/InstancePool.h"
+#include "runtime/Instance.h"
+#include "runtime/Module.h"
+#include "runtime/Function.h"
+#include "runtime/Table.h"
+#include "runtime/Memory.h"
+#include "runtime/Global.h"
+#include "runtime/Tag.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Walrus {
+
+static uint8_t* allocateStorage(size_t size)
+{
+    // the pages are committed when the objects are first placed on them
+    uint8_t* result = reinterpret_cast<uint8_t*>(malloc(std::max<size_t>(size, 1)));
+    RELEASE_ASSERT(result);
+    return result;
+}
+
+InstancePool::InstancePool(size_t instanceCount, const InstancePoolLimits& limits)
+    : m_limits(limits)
+    , m_slots(instanceCount)
+{
+    size_t numberOfReferences = static_cast<size_t>(limits.m_functions) + limits.m_globals + limits.m_tables + limits.m_tags + 1;
+    m_instanceStride = Instance::allocationSize(numberOfReferences, limits.m_dataSegments, limits.m_elementSegments);
+    m_instanceStride = (m_instanceStride + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    m_memoryReservationSize = MEMORY_GUARD_RESERVATION_SIZE;
+#else
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    m_memoryReservationSize = static_cast<size_t>(limits.m_memoryPages) * Memory::s_memoryPageSize;
+    m_memoryReservationSize = (std::max<size_t>(m_memoryReservationSize, 1) + pageSize - 1) & ~(pageSize - 1);
+#endif
+
+    m_instanceStorage = allocateStorage(instanceCount * m_instanceStride);
+    m_functionStorage = allocateStorage(instanceCount * limits.m_functions * sizeof(DefinedFunction));
+    m_globalStorage = allocateStorage(instanceCount * limits.m_globals * sizeof(Global));
+    m_tableStorage = allocateStorage(instanceCount * limits.m_tables * sizeof(Table));
+    m_tableElementStorage = allocateStorage(instanceCount * limits.m_tables * limits.m_tableElements * sizeof(Table::Entry));
+    m_memoryStorage = allocateStorage(instanceCount * sizeof(Memory));
+    m_tagStorage = allocateStorage(instanceCount * limits.m_tags * sizeof(Tag));
+
+    void* reservations = mmap(nullptr, instanceCount * m_memoryReservationSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    RELEASE_ASSERT(reservations != MAP_FAILED);
+    m_memoryReservations = reinterpret_cast<uint8_t*>(reservations);
+
+    m_freeSlots.reserve(instanceCount);
+    for (size_t i = instanceCount; i > 0; i--) {
+        m_freeSlots.push_back(i - 1);
+    }
+}
+
+InstancePool::~InstancePool()
+{
+    // the instances are released when their stores are deleted
+    ASSERT(m_freeSlots.size() == m_slots.size());
+
+    munmap(m_memoryReservations, m_slots.size() * m_memoryReservationSize);
+    free(m_instanceStorage);
+    free(m_functionStorage);
+    free(m_globalStorage);
+    free(m_tableStorage);
+    free(m_tableElementStorage);
+    free(m_memoryStorage);
+    free(m_tagStorage);
+}
+
+bool InstancePool::fits(Module* module) const
+{
+    if (module->numberOfFunctions() > m_limits.m_functions
+        || module->numberOfGlobalTypes() > m_limits.m_globals
+        || module->numberOfTableTypes() > m_limits.m_tables
+        || module->numberOfMemoryTypes() > 1
+        || module->numberOfTagTypes() > m_limits.m_tags
+        || module->numberOfDataSegments() > m_limits.m_dataSegments
+        || module->numberOfElementSegments() > m_limits.m_elementSegments) {
+        return false;
+    }
+
+    // pooled tables and memories cannot leave their slot, so they must be
+    // able to grow to their maximum in it, unbounded ones never fit
+    for (size_t i = 0; i < module->numberOfTableTypes(); i++) {
+        if (module->tableType(i)->maximumSize() > m_limits.m_tableElements) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < module->numberOfMemoryTypes(); i++) {
+        // 32-bit memories cannot grow beyond 4GB
+        uint64_t maximumSizeInByte = std::min<uint64_t>(module->memoryType(i)->maximumSize() * static_cast<uint64_t>(Memory::s_memoryPageSize), 1ULL << 32);
+        if (maximumSizeInByte > m_memoryReservationSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Instance* InstancePool::newInstance(Module* module)
+{
+    if (m_freeSlots.empty() || !fits(module)) {
+        return nullptr;
+    }
+
+    size_t index = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    m_slots[index] = Slot();
+
+    return new (m_instanceStorage + index * m_instanceStride) Instance(module);
+}
+
+void InstancePool::freeInstance(Instance* instance)
+{
+    size_t index = slotIndex(instance);
+    Slot& slot = m_slots[index];
+
+    for (uint32_t i = 0; i < slot.m_functionCount; i++) {
+        reinterpret_cast<DefinedFunction*>(storage<DefinedFunction>(m_functionStorage, index, m_limits.m_functions, i))->~DefinedFunction();
+    }
+    for (uint32_t i = 0; i < slot.m_globalCount; i++) {
+        reinterpret_cast<Global*>(storage<Global>(m_globalStorage, index, m_limits.m_globals, i))->~Global();
+    }
+    for (uint32_t i = 0; i < slot.m_tableCount; i++) {
+        reinterpret_cast<Table*>(storage<Table>(m_tableStorage, index, m_limits.m_tables, i))->~Table();
+    }
+    if (slot.m_memoryCount) {
+        reinterpret_cast<Memory*>(storage<Memory>(m_memoryStorage, index, 1, 0))->~Memory();
+    }
+    for (uint32_t i = 0; i < slot.m_tagCount; i++) {
+        reinterpret_cast<Tag*>(storage<Tag>(m_tagStorage, index, m_limits.m_tags, i))->~Tag();
+    }
+
+    instance->~Instance();
+    m_freeSlots.push_back(index);
+}
+
+DefinedFunction* InstancePool::createDefinedFunction(Instance* instance, ModuleFunction* moduleFunction)
+{
+    size_t index = slotIndex(instance);
+    void* result = storage<DefinedFunction>(m_functionStorage, index, m_limits.m_functions, m_slots[index].m_functionCount++);
+    return new (result) DefinedFunction(instance, moduleFunction);
+}
+
+Table* InstancePool::createTable(Instance* instance, Value::Type type, uint32_t initialSize, uint32_t maximumSize)
+{
+    size_t index = slotIndex(instance);
+    uint32_t tableIndex = m_slots[index].m_tableCount++;
+    void* result = storage<Table>(m_tableStorage, index, m_limits.m_tables, tableIndex);
+    Table::Entry* elements = reinterpret_cast<Table::Entry*>(storage<Table::Entry>(m_tableElementStorage, index * m_limits.m_tables + tableIndex,
+                                                                                    m_limits.m_tableElements, 0));
+    return new (result) Table(type, initialSize, maximumSize, elements, std::min(m_limits.m_tableElements, maximumSize));
+}
+
+Memory* InstancePool::createMemory(Instance* instance, uint32_t initialSizeInByte, uint32_t maximumSizeInByte)
+{
+    size_t index = slotIndex(instance);
+    ASSERT(!m_slots[index].m_memoryCount);
+    m_slots[index].m_memoryCount++;
+    return new (storage<Memory>(m_memoryStorage, index, 1, 0)) Memory(m_memoryReservations + index * m_memoryReservationSize,
+                                                                       m_memoryReservationSize, initialSizeInByte, maximumSizeInByte);
+}
+
+Memory* InstancePool::createMemory(Instance* instance, const MemorySnapshot& snapshot)
+{
+    size_t index = slotIndex(instance);
+    ASSERT(!m_slots[index].m_memoryCount);
+    m_slots[index].m_memoryCount++;
+    return new (storage<Memory>(m_memoryStorage, index, 1, 0)) Memory(m_memoryReservations + index * m_memoryReservationSize,
+                                                                       m_memoryReservationSize, snapshot);
+}
+
+Global* InstancePool::createGlobal(Instance* instance, const Value& value)
+{
+    size_t index = slotIndex(instance);
+    void* result = storage<Global>(m_globalStorage, index, m_limits.m_globals, m_slots[index].m_globalCount++);
+    return new (result) Global(value);
+}
+
+Tag* InstancePool::createTag(Instance* instance, FunctionType* functionType)
+{
+    size_t index = slotIndex(instance);
+    void* result = storage<Tag>(m_tagStorage, index, m_limits.m_tags, m_slots[index].m_tagCount++);
+    return new (result) Tag(functionType);
+}
+
+} // namespace Walrus
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusInstancePool__
+#define __WalrusInstancePool__
+
+#include "runtime/Value.h"
+
+namespace Walrus {
+
+class Module;
+class ModuleFunction;
+class Instance;
+class DefinedFunction;
+class FunctionType;
+class Table;
+class Memory;
+class MemorySnapshot;
+class Global;
+class Tag;
+
+// capacity of each slot of an instance pool
+struct InstancePoolLimits {
+    InstancePoolLimits()
+        : m_functions(10000)
+        , m_globals(1000)
+        , m_tables(1)
+        , m_tableElements(10000)
+        , m_memoryPages(160)
+        , m_tags(100)
+        , m_dataSegments(1000)
+        , m_elementSegments(1000)
+    {
+    }
+
+    // the imported objects are included in the numbers of objects
+    uint32_t m_functions;
+    uint32_t m_globals;
+    uint32_t m_tables;
+    // size of each table
+    uint32_t m_tableElements;
+    // size of the memory, which cannot grow beyond it
+    uint32_t m_memoryPages;
+    uint32_t m_tags;
+    uint32_t m_dataSegments;
+    uint32_t m_elementSegments;
+};
+
+// Preallocated storage of instances and of the objects they define. The
+// memory of each slot is reserved once and decommitted when the instance is
+// released, so creating and releasing pooled instances does not allocate.
+class InstancePool {
+public:
+    InstancePool(size_t instanceCount, const InstancePoolLimits& limits);
+    ~InstancePool();
+
+    // returns nullptr if the instance does not fit in a slot or every slot is in use
+    Instance* newInstance(Module* module);
+    void freeInstance(Instance* instance);
+
+    bool contains(Instance* instance) const
+    {
+        uint8_t* address = reinterpret_cast<uint8_t*>(instance);
+        return m_instanceStorage <= address && address < m_instanceStorage + m_slots.size() * m_instanceStride;
+    }
+
+    DefinedFunction* createDefinedFunction(Instance* instance, ModuleFunction* moduleFunction);
+    Table* createTable(Instance* instance, Value::Type type, uint32_t initialSize, uint32_t maximumSize);
+    Memory* createMemory(Instance* instance, uint32_t initialSizeInByte, uint32_t maximumSizeInByte);
+    Memory* createMemory(Instance* instance, const MemorySnapshot& snapshot);
+    Global* createGlobal(Instance* instance, const Value& value);
+    Tag* createTag(Instance* instance, FunctionType* functionType);
+
+private:
+    // numbers of objects created in the slot, they are destroyed by freeInstance
+    struct Slot {
+        uint32_t m_functionCount;
+        uint32_t m_globalCount;
+        uint32_t m_tableCount;
+        uint32_t m_memoryCount;
+        uint32_t m_tagCount;
+    };
+
+    bool fits(Module* module) const;
+
+    size_t slotIndex(Instance* instance) const
+    {
+        ASSERT(contains(instance));
+        return (reinterpret_cast<uint8_t*>(instance) - m_instanceStorage) / m_instanceStride;
+    }
+
+    // storage of the index-th object of a kind in a slot
+    template <typename T>
+    static void* storage(uint8_t* base, size_t slotIndex, size_t perSlot, size_t index)
+    {
+        ASSERT(index < perSlot);
+        return base + (slotIndex * perSlot + index) * sizeof(T);
+    }
+
+    InstancePoolLimits m_limits;
+    size_t m_instanceStride;
+    size_t m_memoryReservationSize;
+
+    std::vector<Slot> m_slots;
+    // indices of the free slots, the most recently freed one is reused first
+    std::vector<size_t> m_freeSlots;
+
+    uint8_t* m_instanceStorage;
+    uint8_t* m_functionStorage;
+    uint8_t* m_globalStorage;
+    uint8_t* m_tableStorage;
+    uint8_t* m_tableElementStorage;
+    uint8_t* m_memoryStorage;
+    uint8_t* m_tagStorage;
+    uint8_t* m_memoryReservations;
+};
+
+} // namespace Walrus
+
+#endif // __WalrusInstancePool__
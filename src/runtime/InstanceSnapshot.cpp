@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "runtime/InstanceSnapshot.h"
+#include "runtime/Instance.h"
+#include "runtime/Module.h"
+#include "runtime/Function.h"
+#include "runtime/Table.h"
+#include "runtime/Memory.h"
+#include "runtime/Global.h"
+
+namespace Walrus {
+
+InstanceSnapshot* InstanceSnapshot::create(Instance* instance)
+{
+    Module* module = instance->module();
+    size_t importedGlobalCount = 0;
+    for (auto import : module->imports()) {
+        if (import->importType() == ImportType::Memory || import->importType() == ImportType::Table) {
+            return nullptr;
+        }
+        if (import->importType() == ImportType::Global) {
+            importedGlobalCount++;
+        }
+    }
+
+    std::unordered_map<void*, uint32_t> functionIndices;
+    for (size_t i = 0; i < module->numberOfFunctions(); i++) {
+        functionIndices.insert(std::make_pair(instance->function(i), i));
+    }
+    auto toFunctionIndex = [&](void* reference, uint32_t& index) -> bool {
+        if (Value::isNull(reference)) {
+            index = NullFunctionIndex;
+            return true;
+        }
+        auto iter = functionIndices.find(reference);
+        if (iter == functionIndices.end()) {
+            return false;
+        }
+        index = iter->second;
+        return true;
+    };
+
+    std::unique_ptr<InstanceSnapshot> snapshot(new InstanceSnapshot(module));
+
+    for (size_t i = importedGlobalCount; i < module->numberOfGlobalTypes(); i++) {
+        GlobalSnapshot global = { instance->global(i)->value(), NullFunctionIndex };
+        if (global.m_value.type() == Value::FuncRef) {
+            if (!toFunctionIndex(global.m_value.asFunction(), global.m_functionIndex)) {
+                return nullptr;
+            }
+        } else if (global.m_value.type() == Value::ExternRef && !global.m_value.isNull()) {
+            return nullptr;
+        }
+        snapshot->m_globals.push_back(global);
+    }
+
+    for (size_t i = 0; i < module->numberOfTableTypes(); i++) {
+        Table* table = instance->table(i);
+        TableSnapshot tableSnapshot = { table->type(), table->maximumSize(), std::vector<uint32_t>() };
+        tableSnapshot.m_functionIndices.resize(table->size());
+        for (uint32_t j = 0; j < table->size(); j++) {
+            void* element = table->uncheckedGetElement(j);
+            if (table->type() == Value::ExternRef && !Value::isNull(element)) {
+                return nullptr;
+            }
+            if (!toFunctionIndex(element, tableSnapshot.m_functionIndices[j])) {
+                return nullptr;
+            }
+        }
+        snapshot->m_tables.push_back(std::move(tableSnapshot));
+    }
+
+    for (size_t i = 0; i < module->numberOfMemoryTypes(); i++) {
+        snapshot->m_memories.push_back(new MemorySnapshot(instance->memory(i)));
+    }
+
+    for (size_t i = 0; i < module->numberOfDataSegments(); i++) {
+        snapshot->m_droppedDataSegments.push_back(instance->m_dataSegments[i].sizeInByte() == 0);
+    }
+
+    for (size_t i = 0; i < module->numberOfElementSegments(); i++) {
+        snapshot->m_droppedElementSegments.push_back(!instance->m_elementSegments[i].element());
+    }
+
+    return snapshot.release();
+}
+
+InstanceSnapshot::~InstanceSnapshot()
+{
+    for (auto memory : m_memories) {
+        delete memory;
+    }
+}
+
+} // namespace Walrus
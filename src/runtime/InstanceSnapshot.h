@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusInstanceSnapshot__
+#define __WalrusInstanceSnapshot__
+
+#include "runtime/Value.h"
+
+namespace Walrus {
+
+class Instance;
+class Module;
+class MemorySnapshot;
+
+// Immutable copy of the memories, globals, tables and segment states of
+// an instance. Module::instantiate creates new instances from it without
+// running the global and segment initializers and the start function.
+class InstanceSnapshot {
+    friend class Module;
+
+public:
+    // Returns nullptr if the state of the instance cannot be captured,
+    // which is the case for imported memories and tables, and for
+    // references to host objects or to functions of other instances.
+    static InstanceSnapshot* create(Instance* instance);
+
+    ~InstanceSnapshot();
+
+    Module* module() const
+    {
+        return m_module;
+    }
+
+private:
+    // references are stored as function indices of the instance
+    static constexpr uint32_t NullFunctionIndex = std::numeric_limits<uint32_t>::max();
+
+    struct GlobalSnapshot {
+        Value m_value;
+        uint32_t m_functionIndex;
+    };
+
+    struct TableSnapshot {
+        Value::Type m_type;
+        uint32_t m_maximumSize;
+        std::vector<uint32_t> m_functionIndices;
+    };
+
+    InstanceSnapshot(Module* module)
+        : m_module(module)
+    {
+    }
+
+    Module* m_module;
+    // the imported globals are not part of the snapshot
+    std::vector<GlobalSnapshot> m_globals;
+    std::vector<TableSnapshot> m_tables;
+    std::vector<MemorySnapshot*> m_memories;
+    std::vector<bool> m_droppedDataSegments;
+    std::vector<bool> m_droppedElementSegments;
+};
+
+} // namespace Walrus
+
+#endif // __WalrusInstanceSnapshot__
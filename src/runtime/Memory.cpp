@@ -20,6 +20,19 @@
 #include "runtime/Trap.h"
 #include "runtime/Instance.h"
 #include "runtime/Module.h"
+#include "interpreter/Interpreter.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+#include <mutex>
+#endif
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+#define WALRUS_ENABLE_MEMFD_SNAPSHOT
+#endif
 
 namespace Walrus {
 
@@ -30,39 +43,362 @@ Memory* Memory::createMemory(Store* store, uint32_t initialSizeInByte, uint32_t
     return mem;
 }
 
+Memory* Memory::createMemory(Store* store, const MemorySnapshot& snapshot)
+{
+    Memory* mem = new Memory(snapshot);
+    store->appendExtern(mem);
+    return mem;
+}
+
+static size_t roundUpToPageSize(uint64_t size)
+{
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return (size + pageSize - 1) & ~(pageSize - 1);
+}
+
+std::pair<Optional<Memory*>, std::string> Memory::createMemoryFromFile(Store* store, const std::string& path, uint32_t initialSizeInByte, uint32_t maximumSizeInByte)
+{
+#if defined(WALRUS_BIG_ENDIAN)
+    // the content of the memory is stored in reverse order
+    return std::make_pair(nullptr, "file mapped memories are not supported on big endian hosts");
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::make_pair(nullptr, "cannot open " + path);
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return std::make_pair(nullptr, path + " is not a regular file");
+    }
+
+    uint64_t fileSize = fileStat.st_size;
+    uint64_t sizeInByte = (fileSize + s_memoryPageSize - 1) / s_memoryPageSize * s_memoryPageSize;
+    sizeInByte = std::max<uint64_t>(sizeInByte, initialSizeInByte);
+    if (sizeInByte > maximumSizeInByte || sizeInByte > std::numeric_limits<uint32_t>::max()) {
+        close(fd);
+        return std::make_pair(nullptr, path + " does not fit in the memory");
+    }
+
+    Memory* mem = new Memory(sizeInByte, maximumSizeInByte);
+    // the pages after the end of the file stay anonymous, since accessing
+    // them through the mapping would raise SIGBUS
+    if (fileSize && mmap(mem->m_buffer, roundUpToPageSize(fileSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        close(fd);
+        delete mem;
+        return std::make_pair(nullptr, "cannot map " + path);
+    }
+    // the mapping keeps the file open
+    close(fd);
+
+    mem->m_isFileMapped = fileSize != 0;
+    store->appendExtern(mem);
+    return std::make_pair(mem, std::string());
+#endif
+}
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+// reservations of the living memories, a fault inside them is an out of bounds access.
+// The signal handler cannot take locks, so the entries are atomics in a fixed array:
+// the array is only appended to, and an empty start marks a released entry
+struct GuardedReservation {
+    std::atomic<uint8_t*> m_start;
+    std::atomic<size_t> m_size;
+};
+
+// every reservation takes more than 8GB of the address space
+static constexpr size_t s_maxGuardedReservationCount = 16384;
+static GuardedReservation s_guardedReservations[s_maxGuardedReservationCount];
+static std::atomic<size_t> s_guardedReservationCount;
+// serializes the updates, the signal handler only reads
+static std::mutex s_guardedReservationsLock;
+static struct sigaction s_previousSegvAction;
+
+static void addGuardedReservation(uint8_t* start, size_t size)
+{
+    std::lock_guard<std::mutex> guard(s_guardedReservationsLock);
+    size_t count = s_guardedReservationCount.load(std::memory_order_relaxed);
+    size_t index = 0;
+    while (index < count && s_guardedReservations[index].m_start.load(std::memory_order_relaxed)) {
+        index++;
+    }
+    RELEASE_ASSERT(index < s_maxGuardedReservationCount);
+
+    // the size is visible before the start
+    s_guardedReservations[index].m_size.store(size, std::memory_order_relaxed);
+    s_guardedReservations[index].m_start.store(start, std::memory_order_release);
+    if (index == count) {
+        s_guardedReservationCount.store(count + 1, std::memory_order_release);
+    }
+}
+
+static void removeGuardedReservation(uint8_t* start)
+{
+    std::lock_guard<std::mutex> guard(s_guardedReservationsLock);
+    size_t count = s_guardedReservationCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        if (s_guardedReservations[i].m_start.load(std::memory_order_relaxed) == start) {
+            s_guardedReservations[i].m_start.store(nullptr, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+static bool isGuardedAddress(uint8_t* address)
+{
+    size_t count = s_guardedReservationCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* start = s_guardedReservations[i].m_start.load(std::memory_order_acquire);
+        if (start && start <= address && address < start + s_guardedReservations[i].m_size.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Memory::installGuardPageHandler()
+{
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = guardPageHandler;
+        sigemptyset(&action.sa_mask);
+        // the handler does not return when it throws, so the signal must not stay blocked
+        action.sa_flags = SA_SIGINFO | SA_NODEFER | SA_ONSTACK;
+        RELEASE_ASSERT(sigaction(SIGSEGV, &action, &s_previousSegvAction) == 0);
+    });
+}
+
+void Memory::guardPageHandler(int signal, siginfo_t* info, void* context)
+{
+    uint8_t* address = reinterpret_cast<uint8_t*>(info->si_addr);
+    ExecutionState* state = Interpreter::currentState();
+    if (isGuardedAddress(address) && state) {
+        Trap::throwException(*state, "out of bounds memory access");
+    }
+
+    // not a memory access of the interpreter
+    if (s_previousSegvAction.sa_flags & SA_SIGINFO) {
+        s_previousSegvAction.sa_sigaction(signal, info, context);
+    } else if (s_previousSegvAction.sa_handler == SIG_DFL || s_previousSegvAction.sa_handler == SIG_IGN) {
+        // the faulting instruction is executed again with the previous action
+        sigaction(SIGSEGV, &s_previousSegvAction, nullptr);
+    } else {
+        s_previousSegvAction.sa_handler(signal);
+    }
+}
+#endif
+
 Memory::Memory(uint32_t initialSizeInByte, uint32_t maximumSizeInByte)
     : m_sizeInByte(initialSizeInByte)
     , m_maximumSizeInByte(maximumSizeInByte)
-    , m_buffer(reinterpret_cast<uint8_t*>(calloc(1, initialSizeInByte)))
+    , m_reservedSizeInByte(0)
+    , m_buffer(nullptr)
+    , m_isPooled(false)
+    , m_isFileMapped(false)
 {
-    RELEASE_ASSERT(m_buffer);
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    // the memory never moves, out of bounds accesses fault on the inaccessible part
+    installGuardPageHandler();
+    RELEASE_ASSERT(reserve(MEMORY_GUARD_RESERVATION_SIZE, initialSizeInByte));
+    addGuardedReservation(m_buffer, m_reservedSizeInByte);
+#else
+    uint64_t reservedSizeInByte = std::min<uint64_t>(maximumSizeInByte, MEMORY_RESERVATION_LIMIT);
+    RELEASE_ASSERT(reserve(std::max<uint64_t>(reservedSizeInByte, initialSizeInByte), initialSizeInByte));
+#endif
+}
+
+Memory::Memory(const MemorySnapshot& snapshot)
+    : Memory(snapshot.sizeInByte(), snapshot.maximumSizeInByte())
+{
+    m_isFileMapped = snapshot.copyTo(m_buffer);
+}
+
+Memory::Memory(uint8_t* reservation, size_t reservedSizeInByte, uint32_t initialSizeInByte, uint32_t maximumSizeInByte)
+    : m_sizeInByte(initialSizeInByte)
+    , m_maximumSizeInByte(maximumSizeInByte)
+    , m_reservedSizeInByte(reservedSizeInByte)
+    , m_buffer(reservation)
+    , m_isPooled(true)
+    , m_isFileMapped(false)
+{
+    ASSERT(initialSizeInByte <= reservedSizeInByte);
+    size_t committedSize = roundUpToPageSize(initialSizeInByte);
+    RELEASE_ASSERT(!committedSize || mprotect(m_buffer, committedSize, PROT_READ | PROT_WRITE) == 0);
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    installGuardPageHandler();
+    addGuardedReservation(m_buffer, m_reservedSizeInByte);
+#endif
+}
+
+Memory::Memory(uint8_t* reservation, size_t reservedSizeInByte, const MemorySnapshot& snapshot)
+    : Memory(reservation, reservedSizeInByte, snapshot.sizeInByte(), snapshot.maximumSizeInByte())
+{
+    m_isFileMapped = snapshot.copyTo(m_buffer);
 }
 
 Memory::~Memory()
 {
     ASSERT(!!m_buffer);
-    free(m_buffer);
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    removeGuardedReservation(m_buffer);
+#endif
+    if (!m_isPooled) {
+        munmap(m_buffer, m_reservedSizeInByte);
+        return;
+    }
+
+    // the reservation goes back to the pool with zero filled inaccessible pages
+    size_t committedSize = roundUpToPageSize(m_sizeInByte);
+    if (!committedSize) {
+        return;
+    }
+    if (m_isFileMapped) {
+        // discarded pages of a file mapping would be read from the file again
+        RELEASE_ASSERT(mmap(m_buffer, committedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0) != MAP_FAILED);
+    } else {
+        madvise(m_buffer, committedSize, MADV_DONTNEED);
+        mprotect(m_buffer, committedSize, PROT_NONE);
+    }
+}
+
+// Reserves new address space for the memory, makes the first
+// committedSizeInByte bytes accessible and moves the current content there.
+bool Memory::reserve(uint64_t reservedSizeInByte, uint64_t committedSizeInByte)
+{
+    // the buffer is never null, even for empty memories
+    size_t reservedSize = roundUpToPageSize(std::max<uint64_t>(reservedSizeInByte, 1));
+    size_t committedSize = roundUpToPageSize(committedSizeInByte);
+
+    void* buffer = mmap(nullptr, reservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (buffer == MAP_FAILED) {
+        return false;
+    }
+    if (committedSize && mprotect(buffer, committedSize, PROT_READ | PROT_WRITE) != 0) {
+        munmap(buffer, reservedSize);
+        return false;
+    }
+
+    if (m_buffer) {
+        // the content of a file mapping is copied as well
+        memcpy(buffer, m_buffer, m_sizeInByte);
+        munmap(m_buffer, m_reservedSizeInByte);
+        m_isFileMapped = false;
+    }
+    m_buffer = reinterpret_cast<uint8_t*>(buffer);
+    m_reservedSizeInByte = reservedSize;
+    return true;
 }
 
 bool Memory::grow(uint64_t growSizeInByte)
 {
     uint64_t newSizeInByte = growSizeInByte + m_sizeInByte;
     if (newSizeInByte > m_sizeInByte && newSizeInByte <= m_maximumSizeInByte) {
-        uint8_t* newBuffer = reinterpret_cast<uint8_t*>(calloc(1, newSizeInByte));
-        if (newBuffer) {
-            memcpy(newBuffer, m_buffer, m_sizeInByte);
-            free(m_buffer);
-            m_buffer = newBuffer;
-            m_sizeInByte = newSizeInByte;
-            return true;
+        if (newSizeInByte <= m_reservedSizeInByte) {
+            // the new pages are zero filled by the kernel
+            size_t committedSize = roundUpToPageSize(m_sizeInByte);
+            size_t newCommittedSize = roundUpToPageSize(newSizeInByte);
+            if (newCommittedSize > committedSize
+                && mprotect(m_buffer + committedSize, newCommittedSize - committedSize, PROT_READ | PROT_WRITE) != 0) {
+                return false;
+            }
+        } else if (m_isPooled || !reserve(newSizeInByte, newSizeInByte)) {
+            // a pooled memory cannot leave the reservation of its slot
+            return false;
         }
+#if defined(WALRUS_BIG_ENDIAN)
+        // the content is stored from the end of the buffer
+        memmove(m_buffer + newSizeInByte - m_sizeInByte, m_buffer, m_sizeInByte);
+        memset(m_buffer, 0, newSizeInByte - m_sizeInByte);
+#endif
+        m_sizeInByte = newSizeInByte;
+        return true;
     } else if (newSizeInByte == m_sizeInByte) {
         return true;
     }
     return false;
 }
 
-void Memory::throwException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const
+#if defined(WALRUS_ENABLE_MEMFD_SNAPSHOT)
+// writes the content to the file, zero pages are left as holes
+static bool writeContent(int fd, const uint8_t* buffer, size_t size)
+{
+    static const size_t chunkSize = 4096;
+    for (size_t offset = 0; offset < size; offset += chunkSize) {
+        size_t length = std::min(chunkSize, size - offset);
+        const uint8_t* chunk = buffer + offset;
+        if (chunk[0] == 0 && memcmp(chunk, chunk + 1, length - 1) == 0) {
+            continue;
+        }
+
+        while (length) {
+            ssize_t written = pwrite(fd, chunk, length, chunk - buffer);
+            if (written <= 0) {
+                return false;
+            }
+            chunk += written;
+            length -= written;
+        }
+    }
+    return true;
+}
+#endif
+
+MemorySnapshot::MemorySnapshot(const Memory* memory)
+    : m_sizeInByte(memory->sizeInByte())
+    , m_maximumSizeInByte(memory->maximumSizeInByte())
+    , m_fd(-1)
+{
+#if defined(WALRUS_ENABLE_MEMFD_SNAPSHOT)
+    int fd = memfd_create("walrus-memory-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd >= 0) {
+        if (ftruncate(fd, m_sizeInByte) == 0 && writeContent(fd, memory->buffer(), m_sizeInByte)) {
+            // private mappings of a write sealed file stay writable
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+            m_fd = fd;
+            return;
+        }
+        close(fd);
+    }
+#endif
+    m_data.assign(memory->buffer(), memory->buffer() + m_sizeInByte);
+}
+
+MemorySnapshot::~MemorySnapshot()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+bool MemorySnapshot::copyTo(uint8_t* buffer) const
+{
+#if defined(WALRUS_ENABLE_MEMFD_SNAPSHOT)
+    if (m_fd >= 0) {
+        if (!m_sizeInByte) {
+            return false;
+        }
+        if (mmap(buffer, m_sizeInByte, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, m_fd, 0) == MAP_FAILED) {
+            // the anonymous pages of the memory are still in place
+            size_t offset = 0;
+            while (offset < m_sizeInByte) {
+                ssize_t result = pread(m_fd, buffer + offset, m_sizeInByte - offset, offset);
+                RELEASE_ASSERT(result > 0);
+                offset += result;
+            }
+            return false;
+        }
+        return true;
+    }
+#endif
+    memcpy(buffer, m_data.data(), m_sizeInByte);
+    return false;
+}
+
+void Memory::throwException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size)
 {
     std::string str = "out of bounds memory access: access at ";
     str += std::to_string(offset + addend);
@@ -21,16 +21,31 @@
 #include "runtime/ExecutionState.h"
 #include "runtime/Object.h"
 
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+#include <signal.h>
+#endif
+
 namespace Walrus {
 
 class Store;
 class DataSegment;
+class MemorySnapshot;
 
 class Memory : public Extern {
+    friend class InstancePool;
+
 public:
     static const uint32_t s_memoryPageSize = 1024 * 64;
 
     static Memory* createMemory(Store* store, uint32_t initialSizeInByte, uint32_t maximumSizeInByte = std::numeric_limits<uint32_t>::max());
+    static Memory* createMemory(Store* store, const MemorySnapshot& snapshot);
+    // Creates a memory whose content is a private mapping of a host file:
+    // only the accessed pages are read from the file, and the stores of the
+    // modules are not written back. The memory is at least as large as the
+    // file rounded up to pages. The file must not be truncated while the
+    // memory is alive.
+    static std::pair<Optional<Memory*>, std::string> createMemoryFromFile(Store* store, const std::string& path,
+                                                                          uint32_t initialSizeInByte, uint32_t maximumSizeInByte = std::numeric_limits<uint32_t>::max());
 
     ~Memory();
 
@@ -74,38 +89,93 @@ public:
     template <typename T>
     void load(ExecutionState& state, uint32_t offset, uint32_t addend, T* out) const
     {
-        checkAccess(state, offset, sizeof(T), addend);
-
-        memcpyEndianAware(out, m_buffer, sizeof(T), m_sizeInByte, 0, offset + addend, sizeof(T));
+        load(state, m_buffer, m_sizeInByte, offset, addend, out);
     }
 
     template <typename T>
     void load(ExecutionState& state, uint32_t offset, T* out) const
     {
-        checkAccess(state, offset, sizeof(T));
+        load(state, m_buffer, m_sizeInByte, offset, out);
+    }
+
+    template <typename T>
+    void store(ExecutionState& state, uint32_t offset, uint32_t addend, const T& val) const
+    {
+        store(state, m_buffer, m_sizeInByte, offset, addend, val);
+    }
+
+    template <typename T>
+    void store(ExecutionState& state, uint32_t offset, const T& val) const
+    {
+        store(state, m_buffer, m_sizeInByte, offset, val);
+    }
+
+    // Accessors for a buffer and size cached by the caller, they must be
+    // reloaded from the memory whenever it may have grown.
+    template <typename T>
+    static void load(ExecutionState& state, uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, uint32_t addend, T* out)
+    {
+        checkLoadStoreAccess(state, sizeInByte, offset, sizeof(T), addend);
 #if defined(WALRUS_BIG_ENDIAN)
-        *out = *(reinterpret_cast<T*>(&m_buffer[m_sizeInByte - sizeof(T) - offset]));
+        memcpyEndianAware(out, buffer, sizeof(T), sizeInByte, 0, static_cast<size_t>(offset) + addend, sizeof(T));
 #else
-        *out = *(reinterpret_cast<T*>(&m_buffer[offset]));
+        *out = *(reinterpret_cast<T*>(&buffer[static_cast<size_t>(offset) + addend]));
 #endif
     }
 
     template <typename T>
-    void store(ExecutionState& state, uint32_t offset, uint32_t addend, const T& val) const
+    static void load(ExecutionState& state, uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, T* out)
     {
-        checkAccess(state, offset, sizeof(T), addend);
+        checkLoadStoreAccess(state, sizeInByte, offset, sizeof(T));
+#if defined(WALRUS_BIG_ENDIAN)
+        *out = *(reinterpret_cast<T*>(&buffer[sizeInByte - sizeof(T) - offset]));
+#else
+        *out = *(reinterpret_cast<T*>(&buffer[offset]));
+#endif
+    }
+
+    template <typename T>
+    static void store(ExecutionState& state, uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, uint32_t addend, const T& val)
+    {
+        checkLoadStoreAccess(state, sizeInByte, offset, sizeof(T), addend);
+#if defined(WALRUS_BIG_ENDIAN)
+        memcpyEndianAware(buffer, &val, sizeInByte, sizeof(T), static_cast<size_t>(offset) + addend, 0, sizeof(T));
+#else
+        *(reinterpret_cast<T*>(&buffer[static_cast<size_t>(offset) + addend])) = val;
+#endif
+    }
 
-        memcpyEndianAware(m_buffer, &val, m_sizeInByte, sizeof(T), offset + addend, 0, sizeof(T));
+    template <typename T>
+    static void store(ExecutionState& state, uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, const T& val)
+    {
+        checkLoadStoreAccess(state, sizeInByte, offset, sizeof(T));
+#if defined(WALRUS_BIG_ENDIAN)
+        *(reinterpret_cast<T*>(&buffer[sizeInByte - sizeof(T) - offset])) = val;
+#else
+        *(reinterpret_cast<T*>(&buffer[offset])) = val;
+#endif
     }
 
+    // accessors for ranges which are proven to be in bounds before
     template <typename T>
-    void store(ExecutionState& state, uint32_t offset, const T& val) const
+    static void uncheckedLoad(uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, uint32_t addend, T* out)
     {
-        checkAccess(state, offset, sizeof(T));
+        ASSERT(isAccessInBounds(sizeInByte, offset, sizeof(T), addend));
 #if defined(WALRUS_BIG_ENDIAN)
-        *(reinterpret_cast<T*>(&m_buffer[m_sizeInByte - sizeof(T) - offset])) = val;
+        memcpyEndianAware(out, buffer, sizeof(T), sizeInByte, 0, static_cast<size_t>(offset) + addend, sizeof(T));
 #else
-        *(reinterpret_cast<T*>(&m_buffer[offset])) = val;
+        *out = *(reinterpret_cast<T*>(&buffer[static_cast<size_t>(offset) + addend]));
+#endif
+    }
+
+    template <typename T>
+    static void uncheckedStore(uint8_t* buffer, uint32_t sizeInByte, uint32_t offset, uint32_t addend, const T& val)
+    {
+        ASSERT(isAccessInBounds(sizeInByte, offset, sizeof(T), addend));
+#if defined(WALRUS_BIG_ENDIAN)
+        memcpyEndianAware(buffer, &val, sizeInByte, sizeof(T), static_cast<size_t>(offset) + addend, 0, sizeof(T));
+#else
+        *(reinterpret_cast<T*>(&buffer[static_cast<size_t>(offset) + addend])) = val;
 #endif
     }
 
@@ -115,11 +185,22 @@ public:
 
 private:
     Memory(uint32_t initialSizeInByte, uint32_t maximumSizeInByte);
+    Memory(const MemorySnapshot& snapshot);
+    // the memory uses the address space reserved by an instance pool slot,
+    // which is kept and decommitted when the memory is destroyed
+    Memory(uint8_t* reservation, size_t reservedSizeInByte, uint32_t initialSizeInByte, uint32_t maximumSizeInByte);
+    Memory(uint8_t* reservation, size_t reservedSizeInByte, const MemorySnapshot& snapshot);
 
-    void throwException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size) const;
+    bool reserve(uint64_t reservedSizeInByte, uint64_t committedSizeInByte);
+
+    static void throwException(ExecutionState& state, uint32_t offset, uint32_t addend, uint32_t size);
+    static inline bool isAccessInBounds(uint32_t sizeInByte, uint32_t offset, uint32_t size, uint32_t addend = 0)
+    {
+        return !UNLIKELY(!((uint64_t)offset + (uint64_t)addend + (uint64_t)size <= sizeInByte));
+    }
     inline bool checkAccess(uint32_t offset, uint32_t size, uint32_t addend = 0) const
     {
-        return !UNLIKELY(!((uint64_t)offset + (uint64_t)addend + (uint64_t)size <= m_sizeInByte));
+        return isAccessInBounds(m_sizeInByte, offset, size, addend);
     }
     inline void checkAccess(ExecutionState& state, uint32_t offset, uint32_t size, uint32_t addend = 0) const
     {
@@ -127,6 +208,19 @@ private:
             throwException(state, offset, addend, size);
         }
     }
+    static inline void checkLoadStoreAccess(ExecutionState& state, uint32_t sizeInByte, uint32_t offset, uint32_t size, uint32_t addend = 0)
+    {
+#if !defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+        if (!isAccessInBounds(sizeInByte, offset, size, addend)) {
+            throwException(state, offset, addend, size);
+        }
+#endif
+    }
+
+#if defined(WALRUS_ENABLE_GUARD_PAGE_BOUNDS_CHECK)
+    static void installGuardPageHandler();
+    static void guardPageHandler(int signal, siginfo_t* info, void* context);
+#endif
 
     inline void initMemory(DataSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize);
     inline void copyMemory(uint32_t dstStart, uint32_t srcStart, uint32_t size);
@@ -134,7 +228,44 @@ private:
 
     uint32_t m_sizeInByte;
     uint32_t m_maximumSizeInByte;
+    // m_buffer is reserved up to this size, only m_sizeInByte is accessible
+    size_t m_reservedSizeInByte;
     uint8_t* m_buffer;
+    bool m_isPooled;
+    // the content is a private mapping of a snapshot or host file
+    bool m_isFileMapped;
+};
+
+// Read only copy of the content of a memory. On hosts with memfd the
+// memories created from it map the content copy-on-write, so only the
+// pages they write are copied.
+class MemorySnapshot {
+public:
+    MemorySnapshot(const Memory* memory);
+    ~MemorySnapshot();
+
+    uint32_t sizeInByte() const
+    {
+        return m_sizeInByte;
+    }
+
+    uint32_t maximumSizeInByte() const
+    {
+        return m_maximumSizeInByte;
+    }
+
+private:
+    friend class Memory;
+
+    // maps or copies the content to the accessible start of buffer,
+    // returns true if it is mapped
+    bool copyTo(uint8_t* buffer) const;
+
+    uint32_t m_sizeInByte;
+    uint32_t m_maximumSizeInByte;
+    // file holding the content, or -1 if it is kept in m_data
+    int m_fd;
+    std::vector<uint8_t> m_data;
 };
 
 } // namespace Walrus
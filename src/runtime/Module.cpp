@@ -23,21 +23,40 @@
 #include "runtime/Table.h"
 #include "runtime/Memory.h"
 #include "runtime/Tag.h"
+#include "runtime/InstanceSnapshot.h"
+#include "runtime/InstancePool.h"
+#include "runtime/Engine.h"
 #include "runtime/Trap.h"
+#include "runtime/ValueStack.h"
 #include "interpreter/ByteCode.h"
 #include "interpreter/Interpreter.h"
 #include "parser/WASMParser.h"
 
+#if defined(WALRUS_BYTECODE_STATS)
+#include <cinttypes>
+#endif
+
 namespace Walrus {
 
 ModuleFunction::ModuleFunction(FunctionType* functionType)
     : m_functionType(functionType)
+    , m_lazyCompiler(nullptr)
+    , m_lazyBodyIndex(0)
     , m_requiredStackSize(std::max(m_functionType->paramStackSize(), m_functionType->resultStackSize()))
     , m_requiredStackSizeDueToLocal(0)
 {
 }
 
-Module::Module(Store* store, WASMParsingResult& result)
+std::string ModuleFunction::compile()
+{
+    LazyFunctionCompiler* compiler = m_lazyCompiler.load(std::memory_order_acquire);
+    if (!compiler) {
+        return std::string();
+    }
+    return compiler->compile(this);
+}
+
+Module::Module(Store* store, WASMParsingResult& result, LazyFunctionCompiler* lazyCompiler)
     : m_store(store)
     , m_seenStartAttribute(result.m_seenStartAttribute)
     , m_version(result.m_version)
@@ -52,12 +71,21 @@ Module::Module(Store* store, WASMParsingResult& result)
     , m_tableTypes(std::move(result.m_tableTypes))
     , m_memoryTypes(std::move(result.m_memoryTypes))
     , m_tagTypes(std::move(result.m_tagTypes))
+    , m_lazyCompiler(lazyCompiler)
 {
     store->appendModule(this);
 }
 
 Module::~Module()
 {
+#if defined(WALRUS_BYTECODE_STATS)
+    for (size_t i = 0; i < m_functions.size(); i++) {
+        m_functions[i]->dumpCallIndirectCacheStats(i);
+    }
+#endif
+
+    delete m_lazyCompiler;
+
     for (size_t i = 0; i < m_imports.size(); i++) {
         delete m_imports[i];
     }
@@ -99,9 +127,19 @@ Module::~Module()
     }
 }
 
-Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports)
+Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports, const InstanceSnapshot* snapshot)
 {
-    Instance* instance = Instance::newInstance(this);
+    if (snapshot && snapshot->module() != this) {
+        Trap::throwException(state, "incompatible instance snapshot");
+    }
+
+    // the objects of a pooled instance are created in its slot
+    InstancePool* pool = m_store->engine()->instancePool();
+    Instance* instance = pool ? pool->newInstance(this) : nullptr;
+    if (!instance) {
+        pool = nullptr;
+        instance = Instance::newInstance(this);
+    }
 
     void** references = reinterpret_cast<void**>(reinterpret_cast<uintptr_t>(instance) + Instance::alignedSize());
 
@@ -115,6 +153,9 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     instance->m_functions = reinterpret_cast<Function**>(references);
     references += numberOfFunctions();
     instance->m_tags = reinterpret_cast<Tag**>(references);
+    references += numberOfTagTypes();
+    instance->m_dataSegments = reinterpret_cast<DataSegment*>(references);
+    instance->m_elementSegments = reinterpret_cast<ElementSegment*>(instance->m_dataSegments + numberOfDataSegments());
 
     size_t funcIndex = 0;
     size_t globIndex = 0;
@@ -192,32 +233,70 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
 
     // init defined function
     while (funcIndex < m_functions.size()) {
-        instance->m_functions[funcIndex] = DefinedFunction::createDefinedFunction(m_store, instance, function(funcIndex));
+        instance->m_functions[funcIndex] = pool ? pool->createDefinedFunction(instance, function(funcIndex))
+                                                : DefinedFunction::createDefinedFunction(m_store, instance, function(funcIndex));
         funcIndex++;
     }
 
     // init table
     while (tableIndex < m_tableTypes.size()) {
-        instance->m_tables[tableIndex] = Table::createTable(m_store, m_tableTypes[tableIndex]->type(), m_tableTypes[tableIndex]->initialSize(), m_tableTypes[tableIndex]->maximumSize());
+        if (snapshot) {
+            const auto& tableSnapshot = snapshot->m_tables[tableIndex];
+            uint32_t size = tableSnapshot.m_functionIndices.size();
+            Table* table = pool ? pool->createTable(instance, tableSnapshot.m_type, size, tableSnapshot.m_maximumSize)
+                                : Table::createTable(m_store, tableSnapshot.m_type, size, tableSnapshot.m_maximumSize);
+            for (size_t i = 0; i < tableSnapshot.m_functionIndices.size(); i++) {
+                uint32_t index = tableSnapshot.m_functionIndices[i];
+                if (index != InstanceSnapshot::NullFunctionIndex) {
+                    table->uncheckedSetElement(i, instance->m_functions[index]);
+                }
+            }
+            instance->m_tables[tableIndex++] = table;
+            continue;
+        }
+        TableType* tableType = m_tableTypes[tableIndex];
+        instance->m_tables[tableIndex] = pool ? pool->createTable(instance, tableType->type(), tableType->initialSize(), tableType->maximumSize())
+                                              : Table::createTable(m_store, tableType->type(), tableType->initialSize(), tableType->maximumSize());
         tableIndex++;
     }
 
     // init memory
     while (memIndex < m_memoryTypes.size()) {
-        instance->m_memories[memIndex] = Memory::createMemory(m_store, m_memoryTypes[memIndex]->initialSize() * Memory::s_memoryPageSize, m_memoryTypes[memIndex]->maximumSize() * Memory::s_memoryPageSize);
+        if (snapshot) {
+            // the content is mapped copy-on-write from the snapshot if possible
+            const MemorySnapshot& memorySnapshot = *snapshot->m_memories[memIndex];
+            instance->m_memories[memIndex] = pool ? pool->createMemory(instance, memorySnapshot) : Memory::createMemory(m_store, memorySnapshot);
+            memIndex++;
+            continue;
+        }
+        uint32_t initialSizeInByte = m_memoryTypes[memIndex]->initialSize() * Memory::s_memoryPageSize;
+        uint32_t maximumSizeInByte = m_memoryTypes[memIndex]->maximumSize() * Memory::s_memoryPageSize;
+        instance->m_memories[memIndex] = pool ? pool->createMemory(instance, initialSizeInByte, maximumSizeInByte)
+                                              : Memory::createMemory(m_store, initialSizeInByte, maximumSizeInByte);
         memIndex++;
     }
 
     // init tag
     while (tagIndex < m_tagTypes.size()) {
-        instance->m_tags[tagIndex] = Tag::createTag(m_store, m_functionTypes[m_tagTypes[tagIndex]->sigIndex()]);
+        FunctionType* functionType = m_functionTypes[m_tagTypes[tagIndex]->sigIndex()];
+        instance->m_tags[tagIndex] = pool ? pool->createTag(instance, functionType) : Tag::createTag(m_store, functionType);
         tagIndex++;
     }
 
     // init global
+    size_t importedGlobalCount = globIndex;
     while (globIndex < m_globalTypes.size()) {
         GlobalType* globalType = m_globalTypes[globIndex];
-        instance->m_globals[globIndex] = Global::createGlobal(m_store, Value(globalType->type()));
+        if (snapshot) {
+            const auto& globalSnapshot = snapshot->m_globals[globIndex - importedGlobalCount];
+            Value value = globalSnapshot.m_value;
+            if (globalSnapshot.m_functionIndex != InstanceSnapshot::NullFunctionIndex) {
+                value = Value(instance->m_functions[globalSnapshot.m_functionIndex]);
+            }
+            instance->m_globals[globIndex++] = pool ? pool->createGlobal(instance, value) : Global::createGlobal(m_store, value);
+            continue;
+        }
+        instance->m_globals[globIndex] = pool ? pool->createGlobal(instance, Value(globalType->type())) : Global::createGlobal(m_store, Value(globalType->type()));
 
         if (globalType->function()) {
             struct RunData {
@@ -230,16 +309,12 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
             Walrus::Trap trap;
             trap.run([](Walrus::ExecutionState& state, void* d) {
                 RunData* data = reinterpret_cast<RunData*>(d);
-                ALLOCA(uint8_t, functionStackBase, data->mf->requiredStackSize(), isAlloca);
-
                 DefinedFunction fakeFunction(data->instance, data->mf);
                 ExecutionState newState(state, &fakeFunction);
+                ValueStackFrame frame(newState, data->mf->requiredStackSize());
+                uint8_t* functionStackBase = frame.base();
                 auto resultOffset = Interpreter::interpret(newState, functionStackBase);
                 data->instance->m_globals[data->index]->setValue(Value(data->type, functionStackBase + resultOffset[0]));
-
-                if (UNLIKELY(!isAlloca)) {
-                    delete[] functionStackBase;
-                }
             },
                      &data);
         }
@@ -248,12 +323,15 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     }
 
     // init table(elem segment)
-    instance->m_elementSegments.reserve(m_elements.size());
     for (size_t i = 0; i < m_elements.size(); i++) {
         Element* elem = m_elements[i];
-        instance->m_elementSegments[i] = ElementSegment(elem);
+        new (&instance->m_elementSegments[i]) ElementSegment(elem);
 
-        if (elem->mode() == SegmentMode::Active) {
+        if (snapshot) {
+            if (snapshot->m_droppedElementSegments[i]) {
+                instance->m_elementSegments[i].drop();
+            }
+        } else if (elem->mode() == SegmentMode::Active) {
             uint32_t index = 0;
             if (elem->hasModuleFunction()) {
                 struct RunData {
@@ -265,19 +343,15 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
                 Walrus::Trap trap;
                 trap.run([](Walrus::ExecutionState& state, void* d) {
                     RunData* data = reinterpret_cast<RunData*>(d);
-                    ALLOCA(uint8_t, functionStackBase, data->elem->moduleFunction()->requiredStackSize(), isAlloca);
-
                     DefinedFunction fakeFunction(data->instance,
                                                  data->elem->moduleFunction());
                     ExecutionState newState(state, &fakeFunction);
+                    ValueStackFrame frame(newState, data->elem->moduleFunction()->requiredStackSize());
+                    uint8_t* functionStackBase = frame.base();
 
                     auto resultOffset = Interpreter::interpret(newState, functionStackBase);
                     Value offset(Value::I32, functionStackBase + resultOffset[0]);
                     data->index = offset.asI32();
-
-                    if (UNLIKELY(!isAlloca)) {
-                        delete[] functionStackBase;
-                    }
                 },
                          &data);
             }
@@ -303,10 +377,16 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     }
 
     // init memory
-    instance->m_dataSegments.reserve(m_datas.size());
     for (size_t i = 0; i < m_datas.size(); i++) {
         Data* init = m_datas[i];
-        instance->m_dataSegments[i] = DataSegment(init);
+        new (&instance->m_dataSegments[i]) DataSegment(init);
+        if (snapshot) {
+            if (snapshot->m_droppedDataSegments[i]) {
+                instance->m_dataSegments[i].drop();
+            }
+            continue;
+        }
+
         struct RunData {
             Data* init;
             Instance* instance;
@@ -316,19 +396,15 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
         auto result = trap.run([](Walrus::ExecutionState& state, void* d) {
             RunData* data = reinterpret_cast<RunData*>(d);
             if (data->init->moduleFunction()->currentByteCodeSize()) {
-                ALLOCA(uint8_t, functionStackBase, data->init->moduleFunction()->requiredStackSize(), isAlloca);
-
                 DefinedFunction fakeFunction(data->instance,
                                              data->init->moduleFunction());
                 ExecutionState newState(state, &fakeFunction);
+                ValueStackFrame frame(newState, data->init->moduleFunction()->requiredStackSize());
+                uint8_t* functionStackBase = frame.base();
 
                 auto resultOffset = Interpreter::interpret(newState, functionStackBase);
                 Value offset(Value::I32, functionStackBase + resultOffset[0]);
 
-                if (UNLIKELY(!isAlloca)) {
-                    delete[] functionStackBase;
-                }
-
                 Memory* m = data->instance->memory(0);
                 const auto& initData = data->init->initData();
                 if (m->sizeInByte() >= initData.size() && (offset.asI32() + initData.size()) <= m->sizeInByte() && offset.asI32() >= 0) {
@@ -352,11 +428,9 @@ Instance* Module::instantiate(ExecutionState& state, const ExternVector& imports
     ASSERT(tableIndex == numberOfTableTypes());
     ASSERT(memIndex == numberOfMemoryTypes());
     ASSERT(tagIndex == numberOfTagTypes());
-    ASSERT(m_datas.size() == instance->m_dataSegments.size());
-    ASSERT(m_elements.size() == instance->m_elementSegments.size());
 #endif
 
-    if (m_seenStartAttribute) {
+    if (m_seenStartAttribute && !snapshot) {
         ASSERT(instance->m_functions[m_start]->functionType()->param().size() == 0);
         ASSERT(instance->m_functions[m_start]->functionType()->result().size() == 0);
         instance->m_functions[m_start]->call(state, 0, nullptr, nullptr);
@@ -395,4 +469,24 @@ void ModuleFunction::dumpByteCode()
 }
 #endif
 
+#if defined(WALRUS_BYTECODE_STATS)
+void ModuleFunction::dumpCallIndirectCacheStats(size_t functionIndex)
+{
+    size_t idx = 0;
+    while (idx < m_byteCode.size()) {
+        ByteCode* code = reinterpret_cast<ByteCode*>(&m_byteCode[idx]);
+        if (code->opcode() == ByteCode::CallIndirectOpcode) {
+            CallIndirect* callIndirect = static_cast<CallIndirect*>(code);
+            uint64_t hits = callIndirect->cacheHitCount();
+            uint64_t calls = hits + callIndirect->cacheMissCount();
+            if (calls) {
+                fprintf(stderr, "call_indirect cache of function %zu at %zu: %" PRIu64 " hits, %" PRIu64 " calls (%.1f%%)\n",
+                        functionIndex, idx, hits, calls, hits * 100.0 / calls);
+            }
+        }
+        idx += code->getSize();
+    }
+}
+#endif
+
 } // namespace Walrus
@@ -29,6 +29,9 @@ namespace Walrus {
 class Store;
 class Module;
 class Instance;
+class InstanceSnapshot;
+class StackSlotAllocator;
+class LazyFunctionCompiler;
 
 struct WASMParsingResult;
 
@@ -163,6 +166,9 @@ private:
 
 class ModuleFunction {
     friend class wabt::WASMBinaryReader;
+    friend class StackSlotAllocator;
+    friend class BoundsCheckEliminator;
+    friend class LazyFunctionCompiler;
 
 public:
     struct CatchInfo {
@@ -173,12 +179,23 @@ public:
         uint32_t m_tagIndex;
     };
 
+    // bytecode range of a loop, only kept while the module is parsed
+    struct LoopInfo {
+        size_t m_start;
+        size_t m_end;
+    };
+
     ModuleFunction(FunctionType* functionType);
 
     FunctionType* functionType() const { return m_functionType; }
     uint32_t requiredStackSize() const { return m_requiredStackSize; }
     uint32_t requiredStackSizeDueToLocal() const { return m_requiredStackSizeDueToLocal; }
 
+    // The bytecode of the functions of lazily compiled modules is generated
+    // on their first call. Returns the error of the generation.
+    bool isCompiled() const { return !m_lazyCompiler.load(std::memory_order_acquire); }
+    std::string compile();
+
     template <typename CodeType>
     void pushByteCode(const CodeType& code)
     {
@@ -203,6 +220,12 @@ public:
         m_byteCode.resizeWithUninitializedValues(m_byteCode.size() + s);
     }
 
+    void shrinkByteCode(size_t s)
+    {
+        ASSERT(s <= m_byteCode.size());
+        m_byteCode.resizeWithUninitializedValues(m_byteCode.size() - s);
+    }
+
     size_t currentByteCodeSize() const
     {
         return m_byteCode.size();
@@ -212,6 +235,9 @@ public:
 #if !defined(NDEBUG)
     void dumpByteCode();
 #endif
+#if defined(WALRUS_BYTECODE_STATS)
+    void dumpCallIndirectCacheStats(size_t functionIndex);
+#endif
 
     const Vector<CatchInfo, std::allocator<CatchInfo>>& catchInfo() const
     {
@@ -220,11 +246,15 @@ public:
 
 private:
     FunctionType* m_functionType;
+    // set until the bytecode is generated
+    std::atomic<LazyFunctionCompiler*> m_lazyCompiler;
+    uint32_t m_lazyBodyIndex;
     uint32_t m_requiredStackSize;
     uint32_t m_requiredStackSizeDueToLocal;
     ValueTypeVector m_local;
     Vector<uint8_t, std::allocator<uint8_t>> m_byteCode;
     Vector<CatchInfo, std::allocator<CatchInfo>> m_catchInfo;
+    Vector<LoopInfo, std::allocator<LoopInfo>> m_loopInfo;
 };
 
 class Data {
@@ -319,7 +349,7 @@ class Module : public Object {
     friend class wabt::WASMBinaryReader;
 
 public:
-    Module(Store* store, WASMParsingResult& result);
+    Module(Store* store, WASMParsingResult& result, LazyFunctionCompiler* lazyCompiler = nullptr);
 
     ~Module();
 
@@ -393,6 +423,16 @@ public:
         return m_tagTypes.size();
     }
 
+    size_t numberOfDataSegments()
+    {
+        return m_datas.size();
+    }
+
+    size_t numberOfElementSegments()
+    {
+        return m_elements.size();
+    }
+
     const VectorWithFixedSize<ImportType*, std::allocator<ImportType*>>& imports() const
     {
         return m_imports;
@@ -405,7 +445,9 @@ public:
 
     void postParsing();
 
-    Instance* instantiate(ExecutionState& state, const ExternVector& imports);
+    // Instances created from a snapshot of an instance of this module get the
+    // captured state instead of running the initializers and the start function.
+    Instance* instantiate(ExecutionState& state, const ExternVector& imports, const InstanceSnapshot* snapshot = nullptr);
 
 private:
     Store* m_store;
@@ -426,6 +468,8 @@ private:
     TableTypeVector m_tableTypes;
     MemoryTypeVector m_memoryTypes;
     TagTypeVector m_tagTypes;
+
+    LazyFunctionCompiler* m_lazyCompiler;
 };
 
 } // namespace Walrus
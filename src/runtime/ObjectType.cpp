@@ -19,31 +19,35 @@
 #include "runtime/ObjectType.h"
 #include "runtime/Module.h"
 
+#include <mutex>
+
 namespace Walrus {
 
-bool FunctionType::equals(const FunctionType* other) const
+uint32_t FunctionType::internSignature(const ValueTypeVector& param, const ValueTypeVector& result)
 {
-    if (this == other) {
-        return true;
-    }
+    static std::mutex lock;
+    static std::unordered_map<std::string, uint32_t> signatures;
 
-    if (m_paramTypes->size() != other->param().size()) {
-        return false;
+    std::string key;
+    key.reserve(param.size() + result.size() + 1);
+    for (size_t i = 0; i < param.size(); i++) {
+        key.push_back(static_cast<char>(param[i]));
     }
-
-    if (memcmp(m_paramTypes->data(), other->param().data(), sizeof(Value::Type) * other->param().size())) {
-        return false;
-    }
-
-    if (m_resultTypes->size() != other->result().size()) {
-        return false;
+    // separates the params from the results
+    key.push_back(static_cast<char>(Value::Void));
+    for (size_t i = 0; i < result.size(); i++) {
+        key.push_back(static_cast<char>(result[i]));
     }
 
-    if (memcmp(m_resultTypes->data(), other->result().data(), sizeof(Value::Type) * other->result().size())) {
-        return false;
+    std::lock_guard<std::mutex> guard(lock);
+    auto iter = signatures.find(key);
+    if (iter != signatures.end()) {
+        return iter->second;
     }
 
-    return true;
+    uint32_t id = signatures.size();
+    signatures.insert(std::make_pair(key, id));
+    return id;
 }
 
 GlobalType::GlobalType(Value::Type type, bool mut)
@@ -56,6 +56,7 @@ public:
         , m_resultTypes(result)
         , m_paramStackSize(computeStackSize(*m_paramTypes))
         , m_resultStackSize(computeStackSize(*m_resultTypes))
+        , m_signatureId(internSignature(*m_paramTypes, *m_resultTypes))
     {
     }
 
@@ -70,13 +71,22 @@ public:
     size_t paramStackSize() const { return m_paramStackSize; }
     size_t resultStackSize() const { return m_resultStackSize; }
 
-    bool equals(const FunctionType* other) const;
+    // structurally equal function types share the same id in the process
+    uint32_t signatureId() const { return m_signatureId; }
+
+    bool equals(const FunctionType* other) const
+    {
+        return m_signatureId == other->m_signatureId;
+    }
 
 private:
     ValueTypeVector* m_paramTypes;
     ValueTypeVector* m_resultTypes;
     size_t m_paramStackSize;
     size_t m_resultStackSize;
+    uint32_t m_signatureId;
+
+    static uint32_t internSignature(const ValueTypeVector& param, const ValueTypeVector& result);
 
     static size_t computeStackSize(const ValueTypeVector& v)
     {
@@ -19,6 +19,8 @@
 #include "runtime/Module.h"
 #include "runtime/Instance.h"
 #include "runtime/ObjectType.h"
+#include "runtime/Engine.h"
+#include "runtime/InstancePool.h"
 
 namespace Walrus {
 
@@ -45,6 +47,23 @@ Store::~Store()
     Store::finalize();
 }
 
+void Store::releaseInstance(Instance* instance)
+{
+    InstancePool* pool = m_engine->instancePool();
+    if (!pool || !pool->contains(instance)) {
+        return;
+    }
+
+    // recently created instances are usually released first
+    for (size_t i = m_instances.size(); i > 0; i--) {
+        if (m_instances[i - 1] == instance) {
+            m_instances.erase(m_instances.begin() + (i - 1));
+            break;
+        }
+    }
+    pool->freeInstance(instance);
+}
+
 void Store::finalize()
 {
     for (size_t i = 0; i < Value::Type::NUM; i++) {
@@ -61,11 +61,21 @@ public:
         return m_instances.back();
     }
 
+    Engine* engine() const
+    {
+        return m_engine;
+    }
+
+    // Returns a pooled instance to the instance pool of the engine, it must
+    // not be used afterwards. Other instances live until the store is deleted.
+    void releaseInstance(Instance* instance);
+
 private:
     Engine* m_engine;
 
     Vector<Module*> m_modules;
-    Vector<Instance*> m_instances;
+    // keeps its capacity when pooled instances are released
+    std::vector<Instance*> m_instances;
     Vector<Extern*> m_externs;
 
     // default FunctionTypes used for initialization of Data, Element and Global
@@ -23,6 +23,8 @@
 
 namespace Walrus {
 
+std::atomic<size_t> Table::s_lastVersion;
+
 Table* Table::createTable(Store* store, Value::Type type, uint32_t initialSize, uint32_t maximumSize)
 {
     Table* tbl = new Table(type, initialSize, maximumSize);
@@ -35,8 +37,56 @@ Table::Table(Value::Type type, uint32_t initialSize, uint32_t maximumSize)
     : m_type(type)
     , m_size(initialSize)
     , m_maximumSize(maximumSize)
+    , m_version(nextVersion())
+    , m_isPooled(false)
+    , m_capacity(initialSize)
+    , m_elements(reinterpret_cast<Entry*>(malloc(sizeof(Entry) * std::max<uint32_t>(initialSize, 1))))
+{
+    RELEASE_ASSERT(m_elements);
+    fillTable(initialSize, reinterpret_cast<void*>(Value::NullBits), 0);
+}
+
+Table::Table(Value::Type type, uint32_t initialSize, uint32_t maximumSize, Entry* elements, uint32_t capacity)
+    : m_type(type)
+    , m_size(initialSize)
+    , m_maximumSize(maximumSize)
+    , m_version(nextVersion())
+    , m_isPooled(true)
+    , m_capacity(capacity)
+    , m_elements(elements)
+{
+    ASSERT(initialSize <= capacity);
+    fillTable(initialSize, reinterpret_cast<void*>(Value::NullBits), 0);
+}
+
+Table::~Table()
+{
+    if (!m_isPooled) {
+        free(m_elements);
+    }
+}
+
+bool Table::grow(uint64_t newSize, void* val)
 {
-    m_elements.resize(initialSize, reinterpret_cast<void*>(Value::NullBits));
+    ASSERT(newSize <= m_maximumSize);
+    if (newSize > m_capacity) {
+        if (m_isPooled) {
+            return false;
+        }
+
+        uint64_t newCapacity = std::min<uint64_t>(std::max<uint64_t>(newSize, m_capacity * 2ULL), m_maximumSize);
+        Entry* elements = reinterpret_cast<Entry*>(realloc(m_elements, sizeof(Entry) * newCapacity));
+        if (!elements) {
+            return false;
+        }
+        m_elements = elements;
+        m_capacity = newCapacity;
+    }
+
+    uint32_t size = m_size;
+    m_size = newSize;
+    fillTable(newSize - size, val, size);
+    return true;
 }
 
 void Table::init(ExecutionState& state, Instance* instance, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize)
@@ -81,39 +131,33 @@ void Table::initTable(Instance* instance, ElementSegment* source, uint32_t dstSt
 {
     const auto& f = source->element()->functionIndex();
     uint32_t end = dstStart + srcSize;
+    m_version = nextVersion();
 
     for (uint32_t i = dstStart; i < end; i++) {
         auto idx = f[srcStart++];
 
         if (idx != std::numeric_limits<uint32_t>::max()) {
-            m_elements[i] = instance->function(idx);
+            m_elements[i] = makeEntry(instance->function(idx));
         } else {
-            m_elements[i] = reinterpret_cast<void*>(Value::NullBits);
+            m_elements[i] = makeEntry(reinterpret_cast<void*>(Value::NullBits));
         }
     }
 }
 
 void Table::copyTable(const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex)
 {
-    while (n > 0) {
-        if (dstIndex <= srcIndex) {
-            m_elements[dstIndex] = srcTable->uncheckedGetElement(srcIndex);
-            dstIndex++;
-            srcIndex++;
-        } else {
-            m_elements[dstIndex + n - 1] = srcTable->uncheckedGetElement(srcIndex + n - 1);
-        }
-        n--;
+    // both tables have the same element type, so the entries can be moved as they are
+    m_version = nextVersion();
+    if (n > 0) {
+        memmove(&m_elements[dstIndex], &srcTable->m_elements[srcIndex], sizeof(Entry) * n);
     }
 }
 
 void Table::fillTable(uint32_t n, void* value, uint32_t index)
 {
-    while (n > 0) {
-        m_elements[index] = value;
-        n--;
-        index++;
-    }
+    Entry entry = makeEntry(value);
+    m_version = nextVersion();
+    std::fill(m_elements + index, m_elements + index + n, entry);
 }
 
 } // namespace Walrus
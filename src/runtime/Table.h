@@ -19,6 +19,8 @@
 
 #include "runtime/Value.h"
 #include "runtime/Object.h"
+#include "runtime/ObjectType.h"
+#include "runtime/Function.h"
 
 namespace Walrus {
 
@@ -27,9 +29,23 @@ class ElementSegment;
 class Instance;
 
 class Table : public Extern {
+    friend class InstancePool;
+
 public:
+    // Funcref entries carry the signature id of the function next to it,
+    // so call_indirect checks the callee with a single compare.
+    struct Entry {
+        void* m_value;
+        uint32_t m_signatureId;
+    };
+
+    // signature id of null and externref entries
+    static constexpr uint32_t NoSignatureId = std::numeric_limits<uint32_t>::max();
+
     static Table* createTable(Store* store, Value::Type type, uint32_t initialSize, uint32_t maximumSize);
 
+    ~Table();
+
     virtual Object::Kind kind() const override
     {
         return Object::TableKind;
@@ -55,22 +71,30 @@ public:
         return m_maximumSize;
     }
 
-    void grow(uint64_t newSize, void* val)
+    // changes whenever an element or the size of the table changes
+    size_t version() const
     {
-        ASSERT(newSize <= m_maximumSize);
-        m_elements.resize(newSize, val);
-        m_size = newSize;
+        return m_version;
     }
 
+    // fails if the storage of a pooled table is exhausted
+    bool grow(uint64_t newSize, void* val);
+
     void* getElement(ExecutionState& state, uint32_t elemIndex) const
     {
         if (UNLIKELY(elemIndex >= m_size)) {
             throwException(state);
         }
-        return m_elements[elemIndex];
+        return m_elements[elemIndex].m_value;
     }
 
     void* uncheckedGetElement(uint32_t elemIndex) const
+    {
+        ASSERT(elemIndex < m_size);
+        return m_elements[elemIndex].m_value;
+    }
+
+    const Entry& uncheckedGetEntry(uint32_t elemIndex) const
     {
         ASSERT(elemIndex < m_size);
         return m_elements[elemIndex];
@@ -81,13 +105,15 @@ public:
         if (UNLIKELY(elemIndex >= m_size)) {
             throwException(state);
         }
-        m_elements[elemIndex] = val;
+        m_elements[elemIndex] = makeEntry(val);
+        m_version = nextVersion();
     }
 
     void uncheckedSetElement(uint32_t elemIndex, void* val)
     {
         ASSERT(elemIndex < m_size);
-        m_elements[elemIndex] = val;
+        m_elements[elemIndex] = makeEntry(val);
+        m_version = nextVersion();
     }
 
     void copy(ExecutionState& state, const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex);
@@ -96,9 +122,28 @@ public:
 
 private:
     Table(Value::Type type, uint32_t initialSize, uint32_t maximumSize);
+    // the elements are stored in the fixed size storage of an instance pool slot
+    Table(Value::Type type, uint32_t initialSize, uint32_t maximumSize, Entry* elements, uint32_t capacity);
 
     void throwException(ExecutionState& state) const;
 
+    // The versions are unique in the process, so a table created at the
+    // address of a deleted one (e.g. in an instance pool slot) never
+    // matches the call_indirect cache entries of the deleted table.
+    static size_t nextVersion()
+    {
+        return s_lastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    Entry makeEntry(void* val) const
+    {
+        Entry entry = { val, NoSignatureId };
+        if (m_type == Value::Type::FuncRef && !Value::isNull(val)) {
+            entry.m_signatureId = reinterpret_cast<Function*>(val)->functionType()->signatureId();
+        }
+        return entry;
+    }
+
     void initTable(Instance* instance, ElementSegment* source, uint32_t dstStart, uint32_t srcStart, uint32_t srcSize);
     void copyTable(const Table* srcTable, uint32_t n, uint32_t srcIndex, uint32_t dstIndex);
     void fillTable(uint32_t n, void* value, uint32_t index);
@@ -107,9 +152,13 @@ private:
     Value::Type m_type;
     uint32_t m_size;
     uint32_t m_maximumSize;
+    size_t m_version;
+    static std::atomic<size_t> s_lastVersion;
 
+    bool m_isPooled;
+    uint32_t m_capacity;
     // FIXME handle references of Function objects
-    Vector<void*> m_elements;
+    Entry* m_elements;
 };
 
 } // namespace Walrus
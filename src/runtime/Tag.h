@@ -25,6 +25,8 @@ namespace Walrus {
 class FunctionType;
 
 class Tag : public Extern {
+    friend class InstancePool;
+
 public:
     static Tag* createTag(Store* store, FunctionType* functionType)
     {
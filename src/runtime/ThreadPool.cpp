@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "runtime/ThreadPool.h"
+
+namespace Walrus {
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_job(nullptr)
+    , m_jobCount(0)
+    , m_nextJob(0)
+    , m_generation(0)
+    , m_runningWorkers(0)
+    , m_terminating(false)
+{
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_threads.push_back(std::thread(&ThreadPool::workerMain, this, i + 1));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_terminating = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t worker, size_t index)>& job)
+{
+    if (m_threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            job(0, i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runGuard(m_runMutex);
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_job = &job;
+        m_jobCount = count;
+        m_nextJob = 0;
+        m_runningWorkers = m_threads.size();
+        m_generation++;
+    }
+    m_wakeUp.notify_all();
+
+    runJobs(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_runningWorkers == 0; });
+    m_job = nullptr;
+}
+
+void ThreadPool::workerMain(size_t worker)
+{
+    size_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [this, generation] { return m_terminating || m_generation != generation; });
+            if (m_terminating) {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        runJobs(worker);
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (--m_runningWorkers == 0) {
+            m_finished.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runJobs(size_t worker)
+{
+    while (true) {
+        size_t index = m_nextJob++;
+        if (index >= m_jobCount) {
+            break;
+        }
+        (*m_job)(worker, index);
+    }
+}
+
+} // namespace Walrus
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusThreadPool__
+#define __WalrusThreadPool__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Walrus {
+
+// Fixed set of worker threads which run the jobs of one parallelFor call
+// at a time. The calling thread works on the jobs as well.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    // the workers are numbered from zero, the calling thread is worker zero
+    size_t workerCount() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    // Calls job(worker, index) for every index below count and returns when
+    // all of them finished. The jobs must not throw.
+    void parallelFor(size_t count, const std::function<void(size_t worker, size_t index)>& job);
+
+private:
+    void workerMain(size_t worker);
+    void runJobs(size_t worker);
+
+    std::vector<std::thread> m_threads;
+    // one parallelFor call runs at a time
+    std::mutex m_runMutex;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_finished;
+    const std::function<void(size_t, size_t)>* m_job;
+    size_t m_jobCount;
+    std::atomic<size_t> m_nextJob;
+    // incremented by each parallelFor call to wake up the workers
+    size_t m_generation;
+    size_t m_runningWorkers;
+    bool m_terminating;
+};
+
+} // namespace Walrus
+
+#endif // __WalrusThreadPool__
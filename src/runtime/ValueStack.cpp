@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Walrus.h"
+
+#include "runtime/ValueStack.h"
+#include "runtime/Trap.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Walrus {
+
+size_t ValueStack::s_size = VALUE_STACK_SIZE;
+MAY_THREAD_LOCAL uint8_t* ValueStack::s_top;
+MAY_THREAD_LOCAL uint8_t* ValueStack::s_end;
+
+// unmaps the stack and its guard page when the thread exits
+class ValueStackMapping {
+public:
+    ValueStackMapping(void* address, size_t size)
+        : m_address(address)
+        , m_size(size)
+    {
+    }
+
+    ~ValueStackMapping()
+    {
+        munmap(m_address, m_size);
+        ValueStack::s_top = nullptr;
+        ValueStack::s_end = nullptr;
+    }
+
+private:
+    void* m_address;
+    size_t m_size;
+};
+
+void ValueStack::setSize(size_t size)
+{
+    s_size = size;
+}
+
+uint8_t* ValueStack::allocateSlowCase(size_t size)
+{
+    if (s_end) {
+        return nullptr;
+    }
+
+    // the stack of the thread is kept until the thread exits
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t stackSize = (s_size + pageSize - 1) & ~(pageSize - 1);
+    void* stack = mmap(nullptr, stackSize + pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    RELEASE_ASSERT(stack != MAP_FAILED);
+    static thread_local ValueStackMapping mapping(stack, stackSize + pageSize);
+    s_top = reinterpret_cast<uint8_t*>(stack);
+    s_end = s_top + stackSize;
+    // guard page against writes beyond the required stack size of a function
+    RELEASE_ASSERT(mprotect(s_end, pageSize, PROT_NONE) == 0);
+    return allocate(size);
+}
+
+ValueStackFrame::ValueStackFrame(ExecutionState& state, size_t size)
+    : m_base(ValueStack::allocate(size))
+{
+    if (UNLIKELY(!m_base)) {
+        Trap::throwException(state, "call stack exhausted");
+    }
+}
+
+} // namespace Walrus
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WalrusValueStack__
+#define __WalrusValueStack__
+
+namespace Walrus {
+
+class ExecutionState;
+
+// Per-thread stack for the frames of the wasm functions. It is reserved
+// with mmap on the first use of the thread and followed by a guard page,
+// and unmapped when the thread exits.
+// Frames are released in reverse order of allocation.
+class ValueStack {
+public:
+    // returns nullptr when the stack is exhausted
+    static ALWAYS_INLINE uint8_t* allocate(size_t size)
+    {
+        uint8_t* frame = s_top;
+        if (UNLIKELY(static_cast<size_t>(s_end - frame) < size)) {
+            return allocateSlowCase(size);
+        }
+        s_top = frame + size;
+        return frame;
+    }
+
+    static ALWAYS_INLINE void release(uint8_t* frame)
+    {
+        s_top = frame;
+    }
+
+    // size of the stacks reserved after this call, VALUE_STACK_SIZE by default
+    static void setSize(size_t size);
+
+private:
+    friend class ValueStackMapping;
+    static uint8_t* allocateSlowCase(size_t size);
+
+    static size_t s_size;
+    static MAY_THREAD_LOCAL uint8_t* s_top;
+    static MAY_THREAD_LOCAL uint8_t* s_end;
+};
+
+// Frame allocated for a call from native code, released at the end of the scope
+class ValueStackFrame {
+public:
+    ValueStackFrame(ExecutionState& state, size_t size);
+
+    ~ValueStackFrame()
+    {
+        ValueStack::release(m_base);
+    }
+
+    uint8_t* base() const
+    {
+        return m_base;
+    }
+
+private:
+    uint8_t* m_base;
+};
+
+} // namespace Walrus
+
+#endif // __WalrusValueStack__
@@ -3,9 +3,13 @@
 #include <sstream>
 #include <iomanip>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "Walrus.h"
 #include "runtime/Engine.h"
+#include "runtime/InstancePool.h"
+#include "runtime/InstanceSnapshot.h"
 #include "runtime/Store.h"
 #include "runtime/Module.h"
 #include "runtime/Instance.h"
@@ -15,7 +19,10 @@
 #include "runtime/Global.h"
 #include "runtime/Tag.h"
 #include "runtime/Trap.h"
+#include "runtime/ValueStack.h"
 #include "parser/WASMParser.h"
+#include "parser/WASMPreInitializer.h"
+#include "interpreter/Interpreter.h"
 
 #include "wabt/wast-lexer.h"
 #include "wabt/wast-parser.h"
@@ -198,10 +205,36 @@ private:
     FunctionTypeVector m_vector;
 };
 
-static Trap::TrapResult executeWASM(Store* store, const std::string& filename, const std::vector<uint8_t>& src, SpecTestFunctionTypes& functionTypes,
-                                    std::map<std::string, Instance*>* registeredInstanceMap = nullptr)
+// the modules are passed to a WASMStreamingParser in chunks of this size
+// when it is not zero
+static size_t s_streamingChunkSize = 0;
+
+// the instances of wast scripts are created from a snapshot of a previous
+// instance of their module
+static bool s_instantiateFromSnapshot = false;
+
+// every import of "file" "memory" creates a memory mapping this file
+static std::string s_memoryFile;
+
+static std::pair<Optional<Module*>, std::string> parseWASM(Store* store, const std::string& filename, const std::vector<uint8_t>& src)
+{
+    if (!s_streamingChunkSize) {
+        return WASMParser::parseBinary(store, filename, src.data(), src.size());
+    }
+
+    WASMStreamingParser parser(store, filename);
+    for (size_t offset = 0; offset < src.size(); offset += s_streamingChunkSize) {
+        if (parser.append(src.data() + offset, std::min(s_streamingChunkSize, src.size() - offset)).length()) {
+            // finish reports the error
+            break;
+        }
+    }
+    return parser.finish();
+}
+
+static Trap::TrapResult executeModule(Store* store, const std::pair<Optional<Module*>, std::string>& parseResult, SpecTestFunctionTypes& functionTypes,
+                                      std::map<std::string, Instance*>* registeredInstanceMap = nullptr, const InstanceSnapshot* snapshot = nullptr)
 {
-    auto parseResult = WASMParser::parseBinary(store, filename, src.data(), src.size());
     if (!parseResult.second.empty()) {
         Trap::TrapResult tr;
         tr.exception = Exception::create(parseResult.second);
@@ -322,6 +355,18 @@ static Trap::TrapResult executeWASM(Store* store, const std::string& filename, c
                     },
                     nullptr));
             }
+        } else if (import->moduleName() == "file" && import->fieldName() == "memory" && !s_memoryFile.empty()
+                   && import->importType() == ImportType::Memory) {
+            uint64_t initialSizeInByte = import->memoryType()->initialSize() * static_cast<uint64_t>(Memory::s_memoryPageSize);
+            uint64_t maximumSizeInByte = std::min<uint64_t>(import->memoryType()->maximumSize() * static_cast<uint64_t>(Memory::s_memoryPageSize),
+                                                            std::numeric_limits<uint32_t>::max());
+            auto result = Memory::createMemoryFromFile(store, s_memoryFile, std::min(initialSizeInByte, maximumSizeInByte), maximumSizeInByte);
+            if (!result.first) {
+                Trap::TrapResult tr;
+                tr.exception = Exception::create(result.second);
+                return tr;
+            }
+            importValues.push_back(result.first.value());
         } else if (import->moduleName() == "wasi_snapshot_preview1") {
             // TODO wasi
             if (import->fieldName() == "proc_exit") {
@@ -362,15 +407,22 @@ static Trap::TrapResult executeWASM(Store* store, const std::string& filename, c
     struct RunData {
         Module* module;
         ExternVector& importValues;
-    } data = { module.value(), importValues };
+        const InstanceSnapshot* snapshot;
+    } data = { module.value(), importValues, snapshot };
     Walrus::Trap trap;
     return trap.run([](ExecutionState& state, void* d) {
         RunData* data = reinterpret_cast<RunData*>(d);
-        data->module->instantiate(state, data->importValues);
+        data->module->instantiate(state, data->importValues, data->snapshot);
     },
                     &data);
 }
 
+static Trap::TrapResult executeWASM(Store* store, const std::string& filename, const std::vector<uint8_t>& src, SpecTestFunctionTypes& functionTypes,
+                                    std::map<std::string, Instance*>* registeredInstanceMap = nullptr)
+{
+    return executeModule(store, parseWASM(store, filename, src), functionTypes, registeredInstanceMap);
+}
+
 static bool endsWith(const std::string& str, const std::string& suffix)
 {
     return str.size() >= suffix.size() && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
@@ -621,6 +673,32 @@ static Instance* fetchInstance(wabt::Var& moduleVar, std::map<size_t, Instance*>
     return registeredInstanceMap[moduleVar.name()];
 }
 
+// Creates a second instance of the module from a snapshot of the last
+// instance, which is released when nothing else can refer to it.
+static Trap::TrapResult executeModuleFromSnapshot(Store* store, const std::pair<Optional<Module*>, std::string>& parseResult, SpecTestFunctionTypes& functionTypes,
+                                                  std::map<std::string, Instance*>& registeredInstanceMap,
+                                                  std::map<Module*, std::unique_ptr<InstanceSnapshot>>& snapshots)
+{
+    Instance* source = store->getLastInstance();
+    std::unique_ptr<InstanceSnapshot> snapshot(InstanceSnapshot::create(source));
+    if (!snapshot) {
+        // the script uses the source instance
+        return Trap::TrapResult();
+    }
+
+    Module* module = source->module();
+    if (module->imports().size()) {
+        // the start function could have passed the references of the source instance to the imports
+        return executeModule(store, parseResult, functionTypes, &registeredInstanceMap, snapshot.get());
+    }
+
+    // the later instances of the module are created from the same snapshot
+    store->releaseInstance(source);
+    Trap::TrapResult trapResult = executeModule(store, parseResult, functionTypes, &registeredInstanceMap, snapshot.get());
+    snapshots[module] = std::move(snapshot);
+    return trapResult;
+}
+
 static void executeWAST(Store* store, const std::string& filename, const std::vector<uint8_t>& src, SpecTestFunctionTypes& functionTypes)
 {
     auto lexer = wabt::WastLexer::CreateBufferLexer("test.wabt", src.data(), src.size());
@@ -642,6 +720,16 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
 
     std::map<size_t, Instance*> instanceMap;
     std::map<std::string, Instance*> registeredInstanceMap;
+    // With an instance pool or snapshots, the modules of the script with the
+    // same binary are parsed once, so their instances reuse the slots and the
+    // snapshots like the instances of an embedder do.
+    bool reuseModules = store->engine()->instancePool() || s_instantiateFromSnapshot;
+    std::map<std::vector<uint8_t>, Module*> moduleCache;
+    // snapshots of the modules without imports
+    std::map<Module*, std::unique_ptr<InstanceSnapshot>> snapshots;
+    // the last instance, if the script cannot reach it after the next module
+    Instance* releasableInstance = nullptr;
+    size_t releasableCommand = 0;
     size_t commandCount = 0;
     for (const std::unique_ptr<wabt::Command>& command : script->commands) {
         switch (command->type) {
@@ -649,10 +737,41 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
         case wabt::CommandType::ScriptModule: {
             auto* moduleCommand = static_cast<wabt::ModuleCommand*>(command.get());
             auto buf = readModuleData(&moduleCommand->module);
-            executeWASM(store, filename, buf->data, functionTypes, &registeredInstanceMap);
+            if (releasableInstance) {
+                // a pooled instance gives its slot back
+                store->releaseInstance(releasableInstance);
+                instanceMap.erase(releasableCommand);
+                releasableInstance = nullptr;
+            }
+
+            std::pair<Optional<Module*>, std::string> parseResult;
+            auto cached = moduleCache.find(buf->data);
+            if (cached != moduleCache.end()) {
+                parseResult.first = cached->second;
+            } else {
+                parseResult = parseWASM(store, filename, buf->data);
+                if (reuseModules && parseResult.first) {
+                    moduleCache[buf->data] = parseResult.first.value();
+                }
+            }
+
+            Trap::TrapResult trapResult;
+            auto snapshot = parseResult.first ? snapshots.find(parseResult.first.value()) : snapshots.end();
+            if (snapshot != snapshots.end()) {
+                trapResult = executeModule(store, parseResult, functionTypes, &registeredInstanceMap, snapshot->second.get());
+            } else {
+                trapResult = executeModule(store, parseResult, functionTypes, &registeredInstanceMap);
+                if (s_instantiateFromSnapshot && !trapResult.exception) {
+                    trapResult = executeModuleFromSnapshot(store, parseResult, functionTypes, registeredInstanceMap, snapshots);
+                }
+            }
             instanceMap[commandCount] = store->getLastInstance();
             if (moduleCommand->module.name.size()) {
                 registeredInstanceMap[moduleCommand->module.name] = store->getLastInstance();
+            } else if (!trapResult.exception && !parseResult.first->imports().size()) {
+                // nothing but the script can refer to an unnamed instance without imports
+                releasableInstance = store->getLastInstance();
+                releasableCommand = commandCount;
             }
             break;
         }
@@ -718,6 +837,9 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
         case wabt::CommandType::Register: {
             auto* registerCommand = static_cast<wabt::RegisterCommand*>(command.get());
             registeredInstanceMap[registerCommand->module_name] = fetchInstance(registerCommand->var, instanceMap, registeredInstanceMap);
+            if (registeredInstanceMap[registerCommand->module_name] == releasableInstance) {
+                releasableInstance = nullptr;
+            }
             break;
         }
         case wabt::CommandType::Action: {
@@ -795,10 +917,8 @@ static void executeWAST(Store* store, const std::string& filename, const std::ve
     }
 }
 
-static void runExports(Store* store, const std::string& filename, const std::vector<uint8_t>& src, std::string& entry)
+static void runExports(Store* store, const std::pair<Optional<Module*>, std::string>& parseResult, std::string& entry)
 {
-    auto parseResult = WASMParser::parseBinary(store, filename, src.data(), src.size());
-
     if (!parseResult.second.empty()) {
         fprintf(stderr, "parse error: %s\n", parseResult.second.c_str());
         return;
@@ -868,6 +988,76 @@ static void runExports(Store* store, const std::string& filename, const std::vec
     }
 }
 
+static std::vector<uint8_t> firstModuleOfWAST(const std::string& filename, const std::vector<uint8_t>& src)
+{
+    auto lexer = wabt::WastLexer::CreateBufferLexer("test.wabt", src.data(), src.size());
+    if (!lexer) {
+        return std::vector<uint8_t>();
+    }
+
+    wabt::Errors errors;
+    std::unique_ptr<wabt::Script> script;
+    wabt::Features features;
+    features.EnableAll();
+    wabt::WastParseOptions parse_wast_options(features);
+    if (!wabt::Succeeded(wabt::ParseWastScript(lexer.get(), &script, &errors, &parse_wast_options))) {
+        for (const wabt::Error& error : errors) {
+            fprintf(stderr, "%s:%d: %s\n", filename.c_str(), error.loc.line, error.message.c_str());
+        }
+        return std::vector<uint8_t>();
+    }
+
+    for (const std::unique_ptr<wabt::Command>& command : script->commands) {
+        if (command->type == wabt::CommandType::Module || command->type == wabt::CommandType::ScriptModule) {
+            return readModuleData(&static_cast<wabt::ModuleCommand*>(command.get())->module)->data;
+        }
+    }
+
+    fprintf(stderr, "error: the script has no module\n");
+    return std::vector<uint8_t>();
+}
+
+static bool preInitializeWASM(Store* store, const std::string& filename, const std::vector<uint8_t>& src, SpecTestFunctionTypes& functionTypes,
+                              const std::string& initExportName, const std::string& outputPath)
+{
+    auto trapResult = executeWASM(store, filename, src, functionTypes);
+    if (trapResult.exception) {
+        fprintf(stderr, "Uncaught Exception: %s\n", trapResult.exception->message().data());
+        return false;
+    }
+
+    auto result = WASMPreInitializer::preInitialize(store->getLastInstance(), initExportName, filename, src.data(), src.size());
+    if (!result.second.empty()) {
+        fprintf(stderr, "pre-initialization error: %s\n", result.second.c_str());
+        return false;
+    }
+
+    FILE* fp = fopen(outputPath.data(), "wb");
+    if (!fp) {
+        fprintf(stderr, "error: cannot open file %s\n", outputPath.c_str());
+        return false;
+    }
+    bool written = fwrite(result.first.data(), 1, result.first.size(), fp) == result.first.size();
+    fclose(fp);
+    return written;
+}
+
+static bool runWASM(Store* store, const std::pair<Optional<Module*>, std::string>& parseResult, SpecTestFunctionTypes& functionTypes,
+                    bool runAllExports, std::string& entry)
+{
+    if (runAllExports || !entry.empty()) {
+        runExports(store, parseResult, entry);
+        return true;
+    }
+
+    auto trapResult = executeModule(store, parseResult, functionTypes);
+    if (trapResult.exception) {
+        fprintf(stderr, "Uncaught Exception: %s\n", trapResult.exception->message().data());
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char* argv[])
 {
 #ifndef NDEBUG
@@ -888,6 +1078,8 @@ int main(int argc, char* argv[])
     SpecTestFunctionTypes functionTypes;
     bool runAllExports = false;
     std::string entry;
+    std::string preInitializeOutput;
+    std::string initExport;
 
     for (int i = 1; i < argc; i++) {
         if (argv[i][0] == '-') {
@@ -903,11 +1095,105 @@ int main(int argc, char* argv[])
 
                 entry = argv[++i];
 
+                continue;
+            }
+            if (strcmp(argv[i], "--pre-initialize") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --pre-initialize requires an argument\n");
+                    return 1;
+                }
+
+                preInitializeOutput = argv[++i];
+
+                continue;
+            }
+            if (strcmp(argv[i], "--init-export") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --init-export requires an argument\n");
+                    return 1;
+                }
+
+                initExport = argv[++i];
+
+                continue;
+            }
+            if (strcmp(argv[i], "--instance-pool") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --instance-pool requires an argument\n");
+                    return 1;
+                }
+
+                engine->enableInstancePool(strtoull(argv[++i], nullptr, 10), InstancePoolLimits());
+
+                continue;
+            }
+            if (strcmp(argv[i], "--instantiate-from-snapshot") == 0) {
+                s_instantiateFromSnapshot = true;
+                continue;
+            }
+            if (strcmp(argv[i], "--memory-file") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --memory-file requires an argument\n");
+                    return 1;
+                }
+
+                s_memoryFile = argv[++i];
+
+                continue;
+            }
+            if (strcmp(argv[i], "--lazy-compilation") == 0) {
+                engine->enableLazyCompilation();
+                continue;
+            }
+            if (strcmp(argv[i], "--compilation-threads") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --compilation-threads requires an argument\n");
+                    return 1;
+                }
+
+                engine->enableCompilationThreads(strtoull(argv[++i], nullptr, 10));
+
+                continue;
+            }
+            if (strcmp(argv[i], "--streaming-compilation") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --streaming-compilation requires an argument\n");
+                    return 1;
+                }
+
+                s_streamingChunkSize = strtoull(argv[++i], nullptr, 10);
+
+                continue;
+            }
+            if (strcmp(argv[i], "--value-stack-size") == 0) {
+                if (i + 1 >= argc) {
+                    fprintf(stderr, "error: --value-stack-size requires an argument\n");
+                    return 1;
+                }
+
+                ValueStack::setSize(strtoull(argv[++i], nullptr, 10));
+
                 continue;
             }
         }
 
         std::string filePath = argv[i];
+        if (s_streamingChunkSize && endsWith(filePath, "wasm") && preInitializeOutput.empty()) {
+            // the module is compiled while the file is read
+            int fd = open(filePath.data(), O_RDONLY);
+            if (fd < 0) {
+                printf("Cannot open file %s\n", argv[i]);
+                return -1;
+            }
+            auto parseResult = WASMParser::parseFileDescriptor(store, filePath, fd, s_streamingChunkSize);
+            close(fd);
+
+            if (!runWASM(store, parseResult, functionTypes, runAllExports, entry)) {
+                return -1;
+            }
+            continue;
+        }
+
         FILE* fp = fopen(filePath.data(), "r");
         if (fp) {
             fseek(fp, 0, SEEK_END);
@@ -919,17 +1205,23 @@ int main(int argc, char* argv[])
             fclose(fp);
 
             if (endsWith(filePath, "wasm")) {
-                if (runAllExports || !entry.empty()) {
-                    runExports(store, filePath, buf, entry);
-                } else {
-                    auto trapResult = executeWASM(store, filePath, buf, functionTypes);
-                    if (trapResult.exception) {
-                        fprintf(stderr, "Uncaught Exception: %s\n", trapResult.exception->message().data());
+                if (!preInitializeOutput.empty()) {
+                    if (!preInitializeWASM(store, filePath, buf, functionTypes, initExport, preInitializeOutput)) {
                         return -1;
                     }
+                } else if (!runWASM(store, parseWASM(store, filePath, buf), functionTypes, runAllExports, entry)) {
+                    return -1;
                 }
             } else if (endsWith(filePath, "wat") || endsWith(filePath, "wast")) {
-                executeWAST(store, filePath, buf, functionTypes);
+                if (!preInitializeOutput.empty()) {
+                    // the first module of the script is pre-initialized
+                    std::vector<uint8_t> binary = firstModuleOfWAST(filePath, buf);
+                    if (binary.empty() || !preInitializeWASM(store, filePath, binary, functionTypes, initExport, preInitializeOutput)) {
+                        return -1;
+                    }
+                } else {
+                    executeWAST(store, filePath, buf, functionTypes);
+                }
             }
         } else {
             printf("Cannot open file %s\n", argv[i]);
@@ -937,6 +1229,10 @@ int main(int argc, char* argv[])
         }
     }
 
+#if defined(WALRUS_BYTECODE_STATS)
+    fprintf(stderr, "bytecode dispatch count: %" PRIu64 "\n", Interpreter::s_dispatchCount);
+#endif
+
     // finalize
     delete store;
     delete engine;
@@ -0,0 +1,65 @@
+(module
+  (func (export "i32_sub")(param i32)(result i32)
+    local.get 0
+    i32.const 7
+    i32.sub
+  )
+  (func (export "i32_shr_s")(param i32)(result i32)
+    local.get 0
+    i32.const 33
+    i32.shr_s
+  )
+  (func (export "i32_rotl")(param i32)(result i32)
+    local.get 0
+    i32.const 4
+    i32.rotl
+  )
+  (func (export "i32_div_u")(param i32)(result i32)
+    local.get 0
+    i32.const 0
+    i32.div_u
+  )
+  (func (export "i32_counter")(param i32)(result i32)(local i32)
+    (loop
+      local.get 1
+      i32.const 3
+      i32.add
+      local.set 1
+      local.get 0
+      i32.const -1
+      i32.add
+      local.tee 0
+      br_if 0)
+    local.get 1
+  )
+  (func (export "i64_shr_u")(param i64)(result i64)
+    local.get 0
+    i64.const 60
+    i64.shr_u
+  )
+  (func (export "i64_mul")(param i64)(result i64)
+    local.get 0
+    i64.const 0x100000000
+    i64.mul
+  )
+  (func (export "i64_rem_s")(param i64)(result i64)
+    local.get 0
+    i64.const -1
+    i64.rem_s
+  )
+  (func (export "const_set")(result i64)(local i64)
+    i64.const 42
+    local.set 0
+    local.get 0
+  )
+)
+
+(assert_return (invoke "i32_sub" (i32.const 5)) (i32.const -2))
+(assert_return (invoke "i32_shr_s" (i32.const -8)) (i32.const -4))
+(assert_return (invoke "i32_rotl" (i32.const 0xf0000001)) (i32.const 0x0000001f))
+(assert_trap (invoke "i32_div_u" (i32.const 1)) "integer divide by zero")
+(assert_return (invoke "i32_counter" (i32.const 5)) (i32.const 15))
+(assert_return (invoke "i64_shr_u" (i64.const -1)) (i64.const 15))
+(assert_return (invoke "i64_mul" (i64.const 3)) (i64.const 0x300000000))
+(assert_return (invoke "i64_rem_s" (i64.const 0x8000000000000000)) (i64.const 0))
+(assert_return (invoke "const_set") (i64.const 42))
@@ -0,0 +1,77 @@
+(module
+  (memory 1)
+  (data (i32.const 0) "\01\02\03\04\05\06\07\08")
+  (func (export "same_base")(param i32)(result i32)
+    local.get 0
+    i32.load offset=4
+    local.get 0
+    i32.load8_u offset=2
+    i32.add
+    local.get 0
+    i32.load16_u
+    i32.add
+  )
+  (func (export "smaller_first")(param i32)(result i32)
+    local.get 0
+    i32.load8_u
+    local.get 0
+    i32.load offset=4
+    i32.add
+  )
+  (func (export "redefined_base")(param i32)(result i64)
+    local.get 0
+    i64.load offset=8
+    drop
+    local.get 0
+    i32.const 65528
+    i32.add
+    local.set 0
+    local.get 0
+    i64.load
+  )
+  (func (export "store_then_load")(param i32 i32)(result i32)
+    local.get 0
+    local.get 1
+    i32.store offset=16
+    local.get 0
+    i32.load8_s offset=16
+  )
+  (func (export "constant_address")(result i32)
+    i32.const 65532
+    i32.load
+    i32.const 4
+    i32.load
+    i32.add
+  )
+  (func (export "constant_out_of_bounds")(result i32)
+    i32.const 65533
+    i32.load
+  )
+  (func (export "after_branch")(param i32 i32)(result i32)
+    local.get 0
+    i32.load8_u
+    drop
+    (block
+      local.get 1
+      br_if 0
+      local.get 0
+      i32.const 100
+      i32.add
+      local.set 0)
+    local.get 0
+    i32.load8_u
+  )
+)
+
+(assert_return (invoke "same_base" (i32.const 0)) (i32.const 0x08070809))
+(assert_return (invoke "smaller_first" (i32.const 0)) (i32.const 0x08070606))
+(assert_trap (invoke "same_base" (i32.const 65530)) "out of bounds memory access")
+(assert_trap (invoke "smaller_first" (i32.const 65533)) "out of bounds memory access")
+(assert_return (invoke "redefined_base" (i32.const 0)) (i64.const 0))
+(assert_trap (invoke "redefined_base" (i32.const 1)) "out of bounds memory access")
+(assert_return (invoke "store_then_load" (i32.const 0) (i32.const -1)) (i32.const -1))
+(assert_trap (invoke "store_then_load" (i32.const 65520) (i32.const 0)) "out of bounds memory access")
+(assert_return (invoke "constant_address") (i32.const 0x08070605))
+(assert_trap (invoke "constant_out_of_bounds") "out of bounds memory access")
+(assert_return (invoke "after_branch" (i32.const 65535) (i32.const 1)) (i32.const 0))
+(assert_trap (invoke "after_branch" (i32.const 65535) (i32.const 0)) "out of bounds memory access")
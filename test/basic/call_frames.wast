@@ -0,0 +1,81 @@
+(module
+  (tag $e (param i32))
+  (type $i32_to_i32 (func (param i32) (result i32)))
+  (table 2 funcref)
+  (elem (i32.const 0) $sum $throw_at)
+
+  (func $sum (export "sum") (param i32) (result i32)
+    local.get 0
+    i32.eqz
+    if (result i32)
+      i32.const 0
+    else
+      local.get 0
+      local.get 0
+      i32.const 1
+      i32.sub
+      call $sum
+      i32.add
+    end
+  )
+  (func $sum_indirect (export "sum_indirect") (param i32) (result i32)
+    local.get 0
+    i32.eqz
+    if (result i32)
+      i32.const 0
+    else
+      local.get 0
+      local.get 0
+      i32.const 1
+      i32.sub
+      i32.const 0
+      call_indirect (type $i32_to_i32)
+      i32.add
+    end
+  )
+  (func $throw_at (param i32) (result i32)
+    local.get 0
+    i32.eqz
+    if
+      i32.const 42
+      throw $e
+    end
+    local.get 0
+    i32.const 1
+    i32.sub
+    call $throw_at
+  )
+  (func (export "catch_deep") (param i32) (result i32)
+    (try (result i32)
+      (do
+        local.get 0
+        i32.const 1
+        call_indirect (type $i32_to_i32))
+      (catch $e
+        local.get 0
+        i32.add)
+    )
+  )
+  (func $divide (param i32) (result i32)
+    i32.const 100
+    local.get 0
+    i32.div_s
+  )
+  (func (export "trap_in_callee") (param i32) (result i32)
+    local.get 0
+    call $divide
+  )
+  (func $runaway (export "runaway") (param i32) (result i32)
+    local.get 0
+    call $runaway
+  )
+)
+
+(assert_return (invoke "sum" (i32.const 100000)) (i32.const 705082704))
+(assert_return (invoke "sum_indirect" (i32.const 100000)) (i32.const 705082704))
+(assert_return (invoke "catch_deep" (i32.const 1000)) (i32.const 1042))
+(assert_return (invoke "trap_in_callee" (i32.const 5)) (i32.const 20))
+(assert_trap (invoke "trap_in_callee" (i32.const 0)) "integer divide by zero")
+(assert_exhaustion (invoke "runaway" (i32.const 0)) "call stack exhausted")
+(assert_return (invoke "catch_deep" (i32.const 10)) (i32.const 52))
+(assert_return (invoke "sum" (i32.const 10)) (i32.const 55))
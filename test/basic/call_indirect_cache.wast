@@ -0,0 +1,74 @@
+(module
+  (type $t (func (result i32)))
+  (type $u (func (result i64)))
+  (table $tab 4 funcref)
+  (elem (i32.const 0) $one $two)
+  (elem $seg func $three)
+  (elem declare func $wide)
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $three (type $t) i32.const 3)
+  (func $wide (type $u) i64.const 4)
+  (func $call (export "call") (param i32) (result i32)
+    local.get 0
+    call_indirect (type $t)
+  )
+  (func (export "call_twice") (param i32 i32) (result i32)
+    local.get 0
+    call $call
+    local.get 1
+    call $call
+    i32.add
+  )
+  (func (export "set") (param i32 i32)
+    local.get 0
+    local.get 1
+    table.get $tab
+    table.set $tab
+  )
+  (func (export "set_wide") (param i32)
+    local.get 0
+    ref.func $wide
+    table.set $tab
+  )
+  (func (export "fill_null") (param i32 i32)
+    local.get 0
+    ref.null func
+    local.get 1
+    table.fill $tab
+  )
+  (func (export "copy") (param i32 i32 i32)
+    local.get 0
+    local.get 1
+    local.get 2
+    table.copy $tab $tab
+  )
+  (func (export "init") (param i32)
+    local.get 0
+    i32.const 0
+    i32.const 1
+    table.init $tab $seg
+  )
+  (func (export "grow") (result i32)
+    ref.func $three
+    i32.const 2
+    table.grow $tab
+  )
+)
+
+(assert_return (invoke "call_twice" (i32.const 0) (i32.const 1)) (i32.const 3))
+(assert_return (invoke "call_twice" (i32.const 0) (i32.const 1)) (i32.const 3))
+(assert_trap (invoke "call" (i32.const 2)) "uninitialized element")
+(invoke "set" (i32.const 0) (i32.const 1))
+(assert_return (invoke "call" (i32.const 0)) (i32.const 2))
+(invoke "set_wide" (i32.const 1))
+(assert_trap (invoke "call" (i32.const 1)) "indirect call type mismatch")
+(invoke "init" (i32.const 1))
+(assert_return (invoke "call" (i32.const 1)) (i32.const 3))
+(invoke "copy" (i32.const 0) (i32.const 1) (i32.const 1))
+(assert_return (invoke "call" (i32.const 0)) (i32.const 3))
+(invoke "fill_null" (i32.const 0) (i32.const 2))
+(assert_trap (invoke "call" (i32.const 0)) "uninitialized element")
+(assert_trap (invoke "call" (i32.const 4)) "undefined element")
+(assert_return (invoke "grow") (i32.const 4))
+(assert_return (invoke "call" (i32.const 4)) (i32.const 3))
@@ -0,0 +1,89 @@
+(module
+  (func (export "if_i32_lt_s")(param i32 i32)(result i32)
+    local.get 0
+    local.get 1
+    i32.lt_s
+    if (result i32)
+      i32.const 1
+    else
+      i32.const 0
+    end
+  )
+  (func (export "if_i64_ge_u")(param i64 i64)(result i32)
+    local.get 0
+    local.get 1
+    i64.ge_u
+    if (result i32)
+      i32.const 1
+    else
+      i32.const 0
+    end
+  )
+  (func (export "br_if_f32_lt")(param f32 f32)(result i32)
+    (block
+      local.get 0
+      local.get 1
+      f32.lt
+      br_if 0
+      i32.const 0
+      return)
+    i32.const 1
+  )
+  (func (export "br_if_f64_ne")(param f64 f64)(result i32)
+    (block
+      local.get 0
+      local.get 1
+      f64.ne
+      br_if 0
+      i32.const 0
+      return)
+    i32.const 1
+  )
+  (func (export "br_if_i64_eqz_result")(param i64)(result i32)
+    (block (result i32)
+      i32.const 42
+      local.get 0
+      i64.eqz
+      br_if 0
+      drop
+      i32.const 7)
+  )
+  (func (export "br_if_return")(param i32)(result i32)
+    i32.const 42
+    local.get 0
+    i32.eqz
+    br_if 0
+    drop
+    i32.const 7
+  )
+  (func (export "loop_count")(param i32)(result i32)(local i32)
+    (loop
+      local.get 1
+      i32.const 1
+      i32.add
+      local.set 1
+      local.get 1
+      local.get 0
+      i32.ne
+      br_if 0)
+    local.get 1
+  )
+)
+
+(assert_return (invoke "if_i32_lt_s" (i32.const -1) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "if_i32_lt_s" (i32.const 1) (i32.const -1)) (i32.const 0))
+(assert_return (invoke "if_i64_ge_u" (i64.const -1) (i64.const 1)) (i32.const 1))
+(assert_return (invoke "if_i64_ge_u" (i64.const 1) (i64.const 2)) (i32.const 0))
+
+(assert_return (invoke "br_if_f32_lt" (f32.const 1) (f32.const 2)) (i32.const 1))
+(assert_return (invoke "br_if_f32_lt" (f32.const 2) (f32.const 1)) (i32.const 0))
+(assert_return (invoke "br_if_f32_lt" (f32.const nan) (f32.const 1)) (i32.const 0))
+(assert_return (invoke "br_if_f64_ne" (f64.const 1) (f64.const 1)) (i32.const 0))
+(assert_return (invoke "br_if_f64_ne" (f64.const nan) (f64.const nan)) (i32.const 1))
+
+(assert_return (invoke "br_if_i64_eqz_result" (i64.const 0)) (i32.const 42))
+(assert_return (invoke "br_if_i64_eqz_result" (i64.const 5)) (i32.const 7))
+(assert_return (invoke "br_if_return" (i32.const 0)) (i32.const 42))
+(assert_return (invoke "br_if_return" (i32.const 1)) (i32.const 7))
+
+(assert_return (invoke "loop_count" (i32.const 10)) (i32.const 10))
@@ -0,0 +1,27 @@
+(module
+  (table $ext 2 externref)
+  (table $fn 3 funcref)
+  (elem declare func $seven)
+  (elem (table $fn) (i32.const 1) func $seven)
+  (func $seven (result i32) (i32.const 7))
+
+  (func (export "ref_is_null") (result i32)
+    (ref.is_null (ref.func $seven))
+  )
+  (func (export "call") (result i32)
+    (call_indirect $fn (result i32) (i32.const 1))
+  )
+)
+
+(assert_return (invoke "ref_is_null") (i32.const 0))
+(assert_return (invoke "call") (i32.const 7))
+
+(module
+  (table $fn 1 funcref)
+  (elem $p externref (ref.null extern))
+  (func (export "drop")
+    (elem.drop $p)
+  )
+)
+
+(assert_return (invoke "drop"))
@@ -0,0 +1,80 @@
+;; With --instance-pool, every module below takes the slot released by the
+;; previous instance of the same module, so the table, memory and globals
+;; are created at the addresses of the previous ones.
+(module
+  (type $t (func (result i32)))
+  (type $u (func (result i64)))
+  (table $tab 1 1 funcref)
+  (memory 1 1)
+  (global $g (mut i32) (i32.const 10))
+  (elem declare func $one $two $wide)
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $wide (type $u) i64.const 3)
+  (func (export "set_one") (table.set $tab (i32.const 0) (ref.func $one)))
+  (func (export "set_two") (table.set $tab (i32.const 0) (ref.func $two)))
+  (func (export "set_wide") (table.set $tab (i32.const 0) (ref.func $wide)))
+  (func (export "call") (result i32) (call_indirect (type $t) (i32.const 0)))
+  (func (export "store") (param i32) (i32.store (i32.const 100) (local.get 0)))
+  (func (export "load") (result i32) (i32.load (i32.const 100)))
+  (func (export "inc") (result i32)
+    (global.set $g (i32.add (global.get $g) (i32.const 1)))
+    (global.get $g)
+  )
+)
+(invoke "set_one")
+(assert_return (invoke "call") (i32.const 1))
+(invoke "store" (i32.const 42))
+(assert_return (invoke "load") (i32.const 42))
+(assert_return (invoke "inc") (i32.const 11))
+
+;; the call site caches the first table, which had the same address
+(module
+  (type $t (func (result i32)))
+  (type $u (func (result i64)))
+  (table $tab 1 1 funcref)
+  (memory 1 1)
+  (global $g (mut i32) (i32.const 10))
+  (elem declare func $one $two $wide)
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $wide (type $u) i64.const 3)
+  (func (export "set_one") (table.set $tab (i32.const 0) (ref.func $one)))
+  (func (export "set_two") (table.set $tab (i32.const 0) (ref.func $two)))
+  (func (export "set_wide") (table.set $tab (i32.const 0) (ref.func $wide)))
+  (func (export "call") (result i32) (call_indirect (type $t) (i32.const 0)))
+  (func (export "store") (param i32) (i32.store (i32.const 100) (local.get 0)))
+  (func (export "load") (result i32) (i32.load (i32.const 100)))
+  (func (export "inc") (result i32)
+    (global.set $g (i32.add (global.get $g) (i32.const 1)))
+    (global.get $g)
+  )
+)
+(invoke "set_two")
+(assert_return (invoke "call") (i32.const 2))
+(assert_return (invoke "load") (i32.const 0))
+(assert_return (invoke "inc") (i32.const 11))
+
+(module
+  (type $t (func (result i32)))
+  (type $u (func (result i64)))
+  (table $tab 1 1 funcref)
+  (memory 1 1)
+  (global $g (mut i32) (i32.const 10))
+  (elem declare func $one $two $wide)
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $wide (type $u) i64.const 3)
+  (func (export "set_one") (table.set $tab (i32.const 0) (ref.func $one)))
+  (func (export "set_two") (table.set $tab (i32.const 0) (ref.func $two)))
+  (func (export "set_wide") (table.set $tab (i32.const 0) (ref.func $wide)))
+  (func (export "call") (result i32) (call_indirect (type $t) (i32.const 0)))
+  (func (export "store") (param i32) (i32.store (i32.const 100) (local.get 0)))
+  (func (export "load") (result i32) (i32.load (i32.const 100)))
+  (func (export "inc") (result i32)
+    (global.set $g (i32.add (global.get $g) (i32.const 1)))
+    (global.get $g)
+  )
+)
+(invoke "set_wide")
+(assert_trap (invoke "call") "indirect call type mismatch")
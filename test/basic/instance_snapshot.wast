@@ -0,0 +1,113 @@
+;; With --instantiate-from-snapshot, both instances of the module are created
+;; from a snapshot taken after the start function of a first instance.
+(module
+  (type $t (func (result i32)))
+  (memory 1 2)
+  (data (i32.const 0) "\01\02\03\04")
+  (data $passive "\05\06\07\08")
+  (data $dropped "\09")
+  (table $tab 3 3 funcref)
+  (elem (i32.const 0) $one)
+  (elem $seg func $two)
+  (elem $droppedElem func $one)
+  (global $g (mut i32) (i32.const 0))
+  (global $ref (mut funcref) (ref.null func))
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $start
+    (global.set $g (i32.const 7))
+    (global.set $ref (ref.func $two))
+    (table.set $tab (i32.const 1) (ref.func $two))
+    (i32.store (i32.const 65532) (i32.const 0x11223344))
+    (data.drop $dropped)
+    (elem.drop $droppedElem)
+  )
+  (start $start)
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+  (func (export "store") (param i32 i32) (i32.store (local.get 0) (local.get 1)))
+  (func (export "grow") (result i32) (memory.grow (i32.const 1)))
+  (func (export "global") (result i32) (global.get $g))
+  (func (export "set_global") (param i32) (global.set $g (local.get 0)))
+  (func (export "call") (param i32) (result i32) (call_indirect (type $t) (local.get 0)))
+  (func (export "set_from_global")
+    (table.set $tab (i32.const 2) (global.get $ref))
+  )
+  (func (export "init_passive") (memory.init $passive (i32.const 16) (i32.const 0) (i32.const 4)))
+  (func (export "init_dropped") (memory.init $dropped (i32.const 16) (i32.const 0) (i32.const 1)))
+  (func (export "init_seg") (table.init $tab $seg (i32.const 0) (i32.const 0) (i32.const 1)))
+  (func (export "init_dropped_elem") (table.init $tab $droppedElem (i32.const 0) (i32.const 0) (i32.const 1)))
+)
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x04030201))
+(assert_return (invoke "load" (i32.const 65532)) (i32.const 0x11223344))
+(assert_return (invoke "global") (i32.const 7))
+(assert_return (invoke "call" (i32.const 0)) (i32.const 1))
+(assert_return (invoke "call" (i32.const 1)) (i32.const 2))
+(assert_trap (invoke "call" (i32.const 2)) "uninitialized element")
+(invoke "set_from_global")
+(assert_return (invoke "call" (i32.const 2)) (i32.const 2))
+(invoke "init_passive")
+(assert_return (invoke "load" (i32.const 16)) (i32.const 0x08070605))
+(assert_trap (invoke "init_dropped") "out of bounds memory access")
+(invoke "init_seg")
+(assert_return (invoke "call" (i32.const 0)) (i32.const 2))
+(assert_trap (invoke "init_dropped_elem") "out of bounds table access")
+
+;; the stores of the instance are private
+(invoke "store" (i32.const 0) (i32.const 0x55667788))
+(invoke "store" (i32.const 65532) (i32.const 0))
+(invoke "set_global" (i32.const 8))
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x55667788))
+(assert_return (invoke "grow") (i32.const 1))
+(assert_return (invoke "load" (i32.const 65536)) (i32.const 0))
+(invoke "store" (i32.const 65536) (i32.const 1))
+
+(module
+  (type $t (func (result i32)))
+  (memory 1 2)
+  (data (i32.const 0) "\01\02\03\04")
+  (data $passive "\05\06\07\08")
+  (data $dropped "\09")
+  (table $tab 3 3 funcref)
+  (elem (i32.const 0) $one)
+  (elem $seg func $two)
+  (elem $droppedElem func $one)
+  (global $g (mut i32) (i32.const 0))
+  (global $ref (mut funcref) (ref.null func))
+  (func $one (type $t) i32.const 1)
+  (func $two (type $t) i32.const 2)
+  (func $start
+    (global.set $g (i32.const 7))
+    (global.set $ref (ref.func $two))
+    (table.set $tab (i32.const 1) (ref.func $two))
+    (i32.store (i32.const 65532) (i32.const 0x11223344))
+    (data.drop $dropped)
+    (elem.drop $droppedElem)
+  )
+  (start $start)
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+  (func (export "store") (param i32 i32) (i32.store (local.get 0) (local.get 1)))
+  (func (export "grow") (result i32) (memory.grow (i32.const 1)))
+  (func (export "global") (result i32) (global.get $g))
+  (func (export "set_global") (param i32) (global.set $g (local.get 0)))
+  (func (export "call") (param i32) (result i32) (call_indirect (type $t) (local.get 0)))
+  (func (export "set_from_global")
+    (table.set $tab (i32.const 2) (global.get $ref))
+  )
+  (func (export "init_passive") (memory.init $passive (i32.const 16) (i32.const 0) (i32.const 4)))
+  (func (export "init_dropped") (memory.init $dropped (i32.const 16) (i32.const 0) (i32.const 1)))
+  (func (export "init_seg") (table.init $tab $seg (i32.const 0) (i32.const 0) (i32.const 1)))
+  (func (export "init_dropped_elem") (table.init $tab $droppedElem (i32.const 0) (i32.const 0) (i32.const 1)))
+)
+;; the snapshot is not changed by the first instance
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x04030201))
+(assert_return (invoke "load" (i32.const 16)) (i32.const 0))
+(assert_return (invoke "load" (i32.const 65532)) (i32.const 0x11223344))
+(assert_return (invoke "global") (i32.const 7))
+(assert_return (invoke "call" (i32.const 0)) (i32.const 1))
+(assert_return (invoke "call" (i32.const 1)) (i32.const 2))
+(assert_trap (invoke "call" (i32.const 2)) "uninitialized element")
+(assert_trap (invoke "load" (i32.const 65536)) "out of bounds memory access")
+(assert_return (invoke "grow") (i32.const 1))
+(assert_return (invoke "load" (i32.const 65536)) (i32.const 0))
+(assert_trap (invoke "init_dropped") "out of bounds memory access")
+(assert_trap (invoke "init_dropped_elem") "out of bounds table access")
@@ -0,0 +1,107 @@
+(module
+  (memory 1)
+  (data (i32.const 0) "\01\02\03\04\05\06\07\08")
+  (func (export "sum_lt")(param $p i32)(param $end i32)(result i32)(local $s i32)
+    (loop $l
+      (local.set $s (i32.add (local.get $s) (i32.load8_u (local.get $p))))
+      (local.set $p (i32.add (local.get $p) (i32.const 1)))
+      (br_if $l (i32.lt_u (local.get $p) (local.get $end))))
+    (local.get $s)
+  )
+  (func (export "sum_gt")(param $p i32)(param $end i32)(result i32)(local $s i32)
+    (loop $l
+      (local.set $s (i32.add (local.get $s) (i32.load16_u offset=2 (local.get $p))))
+      (local.set $p (i32.add (local.get $p) (i32.const 2)))
+      (br_if $l (i32.gt_u (local.get $end) (local.get $p))))
+    (local.get $s)
+  )
+  (func (export "sum_le")(param $p i32)(param $last i32)(result i64)(local $s i64)
+    (loop $l
+      (local.set $s (i64.add (local.get $s) (i64.load (local.get $p))))
+      (local.set $p (i32.add (local.get $p) (i32.const 8)))
+      (br_if $l (i32.le_u (local.get $p) (local.get $last))))
+    (local.get $s)
+  )
+  (func (export "fill_ne")(param $p i32)(param $end i32)(param $v i32)
+    (loop $l
+      (i32.store (local.get $p) (local.get $v))
+      (local.set $p (i32.add (local.get $p) (i32.const 4)))
+      (br_if $l (i32.ne (local.get $p) (local.get $end))))
+  )
+  (func (export "sum_while")(param $p i32)(param $end i32)(result i32)(local $s i32)
+    (block $b
+      (loop $l
+        (br_if $b (i32.ge_u (local.get $p) (local.get $end)))
+        (local.set $s (i32.add (local.get $s) (i32.load8_u (local.get $p))))
+        (local.set $p (i32.add (local.get $p) (i32.const 1)))
+        (br $l)))
+    (local.get $s)
+  )
+  (func (export "copy_rows")(param $rows i32)(param $n i32)(local $i i32)(local $p i32)
+    (loop $outer
+      (local.set $p (i32.const 0))
+      (loop $inner
+        (i32.store8 offset=256 (i32.add (local.get $p) (i32.mul (local.get $i) (i32.const 16))) (i32.load8_u (local.get $p)))
+        (i32.store8 offset=512 (local.get $p) (i32.load8_u (local.get $p)))
+        (local.set $p (i32.add (local.get $p) (i32.const 1)))
+        (br_if $inner (i32.lt_u (local.get $p) (local.get $n))))
+      (local.set $i (i32.add (local.get $i) (i32.const 1)))
+      (br_if $outer (i32.lt_u (local.get $i) (local.get $rows))))
+  )
+  (func (export "two_loops")(param $n i32)(result i32)(local $p i32)(local $q i32)(local $s i32)
+    (loop $first
+      (local.set $s (i32.add (local.get $s) (i32.load8_u (local.get $p))))
+      (local.set $p (i32.add (local.get $p) (i32.const 1)))
+      (br_if $first (i32.lt_u (local.get $p) (local.get $n))))
+    (loop $second
+      (local.set $s (i32.add (local.get $s) (i32.load8_u offset=4 (local.get $q))))
+      (local.set $q (i32.add (local.get $q) (i32.const 1)))
+      (br_if $second (i32.lt_u (local.get $q) (local.get $n))))
+    (local.get $s)
+  )
+  (func (export "load") (param i32) (result i32)
+    (i32.load (local.get 0))
+  )
+  ;; the stack slot allocator removes the move of the br value, which shifts the loop
+  (func (export "sum_after_br")(param $p i32)(param $end i32)(param $c i32)(result i32)(local $s i32)
+    (local.set $s
+      (block $b (result i32)
+        (i32.add (local.get $c) (i32.const 5))
+        (i32.add (local.get $c) (i32.const 1))
+        (br_if $b (local.get $c))
+        (drop)
+        (drop)
+        (i32.add (local.get $c) (i32.const 2))))
+    (loop $l
+      (local.set $s (i32.add (local.get $s) (i32.load (local.get $p))))
+      (local.set $p (i32.add (local.get $p) (i32.const 4)))
+      (br_if $l (i32.lt_u (local.get $p) (local.get $end))))
+    (local.get $s)
+  )
+)
+
+(assert_return (invoke "sum_lt" (i32.const 0) (i32.const 8)) (i32.const 36))
+(assert_return (invoke "sum_lt" (i32.const 4) (i32.const 0)) (i32.const 5))
+(assert_return (invoke "sum_lt" (i32.const 65535) (i32.const 0)) (i32.const 0))
+(assert_trap (invoke "sum_lt" (i32.const 65530) (i32.const 65537)) "out of bounds memory access")
+(assert_return (invoke "sum_gt" (i32.const 0) (i32.const 4)) (i32.const 0x0a08))
+(assert_trap (invoke "sum_gt" (i32.const 65528) (i32.const 65535)) "out of bounds memory access")
+(assert_return (invoke "sum_le" (i32.const 0) (i32.const 65528)) (i64.const 0x0807060504030201))
+(assert_trap (invoke "sum_le" (i32.const 65521) (i32.const 65529)) "out of bounds memory access")
+(assert_return (invoke "fill_ne" (i32.const 65520) (i32.const 65536) (i32.const 7)))
+(assert_return (invoke "load" (i32.const 65532)) (i32.const 7))
+(assert_trap (invoke "fill_ne" (i32.const 65524) (i32.const 65538) (i32.const 9)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 65532)) (i32.const 9))
+(assert_return (invoke "sum_while" (i32.const 0) (i32.const 0)) (i32.const 0))
+(assert_return (invoke "sum_while" (i32.const 2) (i32.const 6)) (i32.const 18))
+(assert_return (invoke "sum_while" (i32.const 65535) (i32.const 65536)) (i32.const 0))
+(assert_trap (invoke "sum_while" (i32.const 65535) (i32.const 65537)) "out of bounds memory access")
+(assert_return (invoke "copy_rows" (i32.const 2) (i32.const 8)))
+(assert_return (invoke "load" (i32.const 256)) (i32.const 0x04030201))
+(assert_return (invoke "load" (i32.const 276)) (i32.const 0x08070605))
+(assert_return (invoke "load" (i32.const 516)) (i32.const 0x08070605))
+(assert_return (invoke "two_loops" (i32.const 4)) (i32.const 36))
+(assert_trap (invoke "two_loops" (i32.const 65533)) "out of bounds memory access")
+(assert_return (invoke "sum_after_br" (i32.const 0) (i32.const 8) (i32.const 0)) (i32.const 0x0c0a0808))
+(assert_return (invoke "sum_after_br" (i32.const 0) (i32.const 4) (i32.const 1)) (i32.const 0x04030203))
+(assert_trap (invoke "sum_after_br" (i32.const 65528) (i32.const 65540) (i32.const 1)) "out of bounds memory access")
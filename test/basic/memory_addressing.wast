@@ -0,0 +1,83 @@
+(module
+  (memory 1)
+  (data (i32.const 0) "\80\ff\01\02\03\04\05\06\07\08\09\0a")
+
+  (func (export "load8_s") (param i32) (result i32)
+    local.get 0
+    i32.load8_s)
+  (func (export "load16_u") (param i32) (result i64)
+    local.get 0
+    i64.load16_u)
+  (func (export "load32_s") (param i32) (result i64)
+    local.get 0
+    i64.load32_s)
+  (func (export "store8") (param i32 i32) (result i32)
+    local.get 0
+    local.get 1
+    i32.store8
+    local.get 0
+    i32.load)
+
+  (func (export "load_add") (param i32) (result i32)
+    local.get 0
+    i32.const 4
+    i32.add
+    i32.load offset=2)
+  (func (export "load_sub") (param i32) (result i32)
+    local.get 0
+    i32.const -4
+    i32.add
+    i32.load8_u)
+  (func (export "load_add_f64") (param i32) (result f64)
+    local.get 0
+    i32.const 8
+    i32.add
+    f64.load)
+  (func (export "store_add") (param i32 i64) (result i64)
+    local.get 0
+    i32.const 16
+    i32.add
+    local.get 1
+    i64.store offset=8
+    local.get 0
+    i64.load offset=24)
+  (func (export "store_sub") (param i32 i32) (result i32)
+    local.get 0
+    i32.const -1
+    i32.add
+    local.get 1
+    i32.store16
+    local.get 0
+    i32.const -1
+    i32.add
+    i32.load16_s)
+  (func (export "add_tee") (param i32) (result i32) (local i32)
+    local.get 0
+    i32.const 1
+    i32.add
+    local.tee 1
+    i32.load8_u
+    local.get 1
+    i32.add)
+)
+
+(assert_return (invoke "load8_s" (i32.const 0)) (i32.const -128))
+(assert_return (invoke "load16_u" (i32.const 1)) (i64.const 0x01ff))
+(assert_return (invoke "load32_s" (i32.const 0)) (i64.const 0x0201ff80))
+(assert_trap (invoke "load32_s" (i32.const 65533)) "out of bounds memory access")
+(assert_return (invoke "store8" (i32.const 100) (i32.const 0x1234)) (i32.const 0x34))
+(assert_trap (invoke "store8" (i32.const 65536) (i32.const 1)) "out of bounds memory access")
+
+(assert_return (invoke "load_add" (i32.const 0)) (i32.const 0x08070605))
+(assert_trap (invoke "load_add" (i32.const 65528)) "out of bounds memory access")
+;; the address wraps around before the static offset is applied
+(assert_return (invoke "load_add" (i32.const -4)) (i32.const 0x04030201))
+(assert_trap (invoke "load_add" (i32.const -6)) "out of bounds memory access")
+(assert_return (invoke "load_sub" (i32.const 5)) (i32.const 0xff))
+(assert_trap (invoke "load_sub" (i32.const 3)) "out of bounds memory access")
+(assert_return (invoke "load_add_f64" (i32.const 200)) (f64.const 0))
+(assert_return (invoke "store_add" (i32.const 200) (i64.const -2)) (i64.const -2))
+(assert_trap (invoke "store_add" (i32.const -24) (i64.const 1)) "out of bounds memory access")
+(assert_return (invoke "store_sub" (i32.const 301) (i32.const 0x8001)) (i32.const -32767))
+(assert_trap (invoke "store_sub" (i32.const 0) (i32.const 1)) "out of bounds memory access")
+(assert_return (invoke "add_tee" (i32.const 0)) (i32.const 0x100))
@@ -0,0 +1,43 @@
+(module $grower
+  (memory (export "mem") 1)
+  (func (export "grow") (param i32) (result i32)
+    local.get 0
+    memory.grow)
+)
+(register "grower" $grower)
+
+(module
+  (import "grower" "mem" (memory 1))
+  (import "grower" "grow" (func $import_grow (param i32) (result i32)))
+  (func $grow (param i32) (result i32)
+    local.get 0
+    memory.grow)
+  (func (export "grow_in_callee") (result i32)
+    i32.const 1
+    call $grow
+    drop
+    i32.const 0x1fffc
+    i32.const 7
+    i32.store
+    i32.const 0x1fffc
+    i32.load)
+  (func (export "grow_in_import") (result i32)
+    i32.const 1
+    call $import_grow
+    drop
+    i32.const 0x2fffc
+    i32.const 9
+    i32.store
+    i32.const 0x2fffc
+    i32.load)
+  (func (export "load") (param i32) (result i32)
+    local.get 0
+    i32.load)
+)
+
+(assert_trap (invoke "load" (i32.const 0x1fffc)) "out of bounds memory access")
+(assert_return (invoke "grow_in_callee") (i32.const 7))
+(assert_return (invoke "load" (i32.const 0x1fffc)) (i32.const 7))
+(assert_trap (invoke "load" (i32.const 0x2fffc)) "out of bounds memory access")
+(assert_return (invoke "grow_in_import") (i32.const 9))
+(assert_trap (invoke "load" (i32.const 0x3fffd)) "out of bounds memory access")
@@ -0,0 +1,73 @@
+(module
+  (func (export "block_results")(param i32)(result i32)
+    (block (result i32)
+      (block (result i32)
+        i32.const 10
+        local.get 0
+        br_if 1
+        drop
+        i32.const 20)
+      i32.const 1
+      i32.add)
+  )
+  (func (export "br_table_value")(param i32)(result i64)
+    (block (result i64)
+      (block (result i64)
+        (block (result i64)
+          i64.const 100
+          local.get 0
+          br_table 0 1 2)
+        i64.const 1
+        i64.add)
+      i64.const 2
+      i64.add)
+  )
+  (func (export "loop_carried")(param i32)(result i32 i64)(local i32 i64)
+    (loop
+      local.get 1
+      local.get 0
+      i32.add
+      local.set 1
+      local.get 2
+      i64.const 3
+      i64.add
+      local.set 2
+      local.get 0
+      i32.const 1
+      i32.sub
+      local.tee 0
+      br_if 0)
+    local.get 1
+    local.get 2
+  )
+  (func $pair (param i32 i32)(result i32 i32)
+    local.get 1
+    local.get 0
+  )
+  (func (export "swap_twice")(param i32 i32)(result i32)
+    local.get 0
+    local.get 1
+    call $pair
+    call $pair
+    i32.sub
+  )
+  (func (export "select_chain")(param i32)(result f64)
+    f64.const 1.5
+    f64.const 2.5
+    local.get 0
+    select
+    f64.const 4
+    f64.mul
+  )
+)
+
+(assert_return (invoke "block_results" (i32.const 1)) (i32.const 10))
+(assert_return (invoke "block_results" (i32.const 0)) (i32.const 21))
+(assert_return (invoke "br_table_value" (i32.const 0)) (i64.const 103))
+(assert_return (invoke "br_table_value" (i32.const 1)) (i64.const 102))
+(assert_return (invoke "br_table_value" (i32.const 2)) (i64.const 100))
+(assert_return (invoke "br_table_value" (i32.const 9)) (i64.const 100))
+(assert_return (invoke "loop_carried" (i32.const 4)) (i32.const 10) (i64.const 12))
+(assert_return (invoke "swap_twice" (i32.const 7) (i32.const 2)) (i32.const 5))
+(assert_return (invoke "select_chain" (i32.const 1)) (f64.const 6))
+(assert_return (invoke "select_chain" (i32.const 0)) (f64.const 10))
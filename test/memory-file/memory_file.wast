@@ -0,0 +1,50 @@
+;; Run with --memory-file pointing to a file of 4100 bytes, where byte i is i % 256.
+(module
+  (import "file" "memory" (memory 1 3))
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+  (func (export "store") (param i32 i32) (i32.store (local.get 0) (local.get 1)))
+  (func (export "grow") (param i32) (result i32) (memory.grow (local.get 0)))
+  (func (export "size") (result i32) (memory.size))
+)
+;; the file is read, and the rest of the page is zero
+(assert_return (invoke "size") (i32.const 1))
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 256)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 4094)) (i32.const 0x0100fffe))
+(assert_return (invoke "load" (i32.const 4096)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 4098)) (i32.const 0x00000302))
+(assert_return (invoke "load" (i32.const 65532)) (i32.const 0))
+(assert_trap (invoke "load" (i32.const 65536)) "out of bounds memory access")
+
+;; the stores are private to the memory
+(invoke "store" (i32.const 0) (i32.const 0x55667788))
+(invoke "store" (i32.const 4096) (i32.const 0x11223344))
+(invoke "store" (i32.const 8192) (i32.const 7))
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x55667788))
+(assert_return (invoke "load" (i32.const 4096)) (i32.const 0x11223344))
+
+;; growing past the file keeps the mapped content
+(assert_return (invoke "grow" (i32.const 2)) (i32.const 1))
+(assert_return (invoke "size") (i32.const 3))
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x55667788))
+(assert_return (invoke "load" (i32.const 256)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 8192)) (i32.const 7))
+(assert_return (invoke "load" (i32.const 131068)) (i32.const 0))
+(invoke "store" (i32.const 131068) (i32.const 9))
+(assert_return (invoke "load" (i32.const 131068)) (i32.const 9))
+(assert_return (invoke "grow" (i32.const 1)) (i32.const -1))
+
+;; a new memory sees the content of the file
+(module
+  (import "file" "memory" (memory 1))
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+)
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 4096)) (i32.const 0x03020100))
+(assert_return (invoke "load" (i32.const 8192)) (i32.const 0))
+
+;; the file does not fit in a memory smaller than a page
+(assert_unlinkable
+  (module (import "file" "memory" (memory 0 0)))
+  "does not fit"
+)
@@ -0,0 +1,66 @@
+(module
+  (memory 32)
+  ;; a, b and c are n x n matrices of i32 at 0, n * n * 4 and n * n * 8,
+  ;; the accesses follow the counters of the loops
+  (func $init (param $n i32)
+    (local $i i32)
+    (local $j i32)
+    (local $offset i32)
+    (loop $rows
+      (local.set $j (i32.const 0))
+      (loop $columns
+        (local.set $offset (i32.shl (i32.add (i32.mul (local.get $i) (local.get $n)) (local.get $j)) (i32.const 2)))
+        (i32.store (local.get $offset) (i32.add (i32.mul (local.get $i) (local.get $j)) (i32.const 1)))
+        (i32.store offset=0 (i32.add (local.get $offset) (i32.shl (i32.mul (local.get $n) (local.get $n)) (i32.const 2)))
+          (i32.add (local.get $i) (i32.shl (local.get $j) (i32.const 1))))
+        (br_if $columns (i32.lt_u (local.tee $j (i32.add (local.get $j) (i32.const 1))) (local.get $n)))
+      )
+      (br_if $rows (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1))) (local.get $n)))
+    )
+  )
+
+  (func (export "multiply") (param $n i32) (result i32)
+    (local $i i32)
+    (local $j i32)
+    (local $k i32)
+    (local $size i32)
+    (local $a i32)
+    (local $b i32)
+    (local $value i32)
+    (local $sum i32)
+    (call $init (local.get $n))
+    (local.set $size (i32.shl (i32.mul (local.get $n) (local.get $n)) (i32.const 2)))
+    (loop $rows
+      (local.set $j (i32.const 0))
+      (loop $columns
+        (local.set $a (i32.shl (i32.mul (local.get $i) (local.get $n)) (i32.const 2)))
+        (local.set $b (i32.add (local.get $size) (i32.shl (local.get $j) (i32.const 2))))
+        (local.set $value (i32.const 0))
+        (local.set $k (i32.const 0))
+        (loop $products
+          (local.set $value (i32.add (local.get $value)
+            (i32.mul (i32.load (local.get $a)) (i32.load (local.get $b)))))
+          (local.set $a (i32.add (local.get $a) (i32.const 4)))
+          (local.set $b (i32.add (local.get $b) (i32.shl (local.get $n) (i32.const 2))))
+          (br_if $products (i32.lt_u (local.tee $k (i32.add (local.get $k) (i32.const 1))) (local.get $n)))
+        )
+        (i32.store (i32.add (i32.shl (local.get $size) (i32.const 1))
+                            (i32.shl (i32.add (i32.mul (local.get $i) (local.get $n)) (local.get $j)) (i32.const 2)))
+                   (local.get $value))
+        (br_if $columns (i32.lt_u (local.tee $j (i32.add (local.get $j) (i32.const 1))) (local.get $n)))
+      )
+      (br_if $rows (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 1))) (local.get $n)))
+    )
+
+    ;; the sum of c
+    (local.set $i (i32.shl (local.get $size) (i32.const 1)))
+    (local.set $size (i32.mul (local.get $size) (i32.const 3)))
+    (loop $sum
+      (local.set $sum (i32.add (local.get $sum) (i32.load (local.get $i))))
+      (br_if $sum (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 4))) (local.get $size)))
+    )
+    (local.get $sum)
+  )
+)
+
+(assert_return (invoke "multiply" (i32.const 400)) (i32.const 510932992))
@@ -0,0 +1,19 @@
+(module
+  (memory 256)
+  ;; loads and stores at pseudo random addresses of a 16MB memory, the
+  ;; accesses of the loop cannot be checked before the loop
+  (func (export "random_access") (param $n i32) (param $x i32) (result i32)
+    (local $address i32)
+    (local $sum i32)
+    (loop $loop
+      (local.set $x (i32.add (i32.mul (local.get $x) (i32.const 1664525)) (i32.const 1013904223)))
+      (local.set $address (i32.and (i32.shr_u (local.get $x) (i32.const 8)) (i32.const 0xfffffc)))
+      (local.set $sum (i32.add (local.get $sum) (i32.load (local.get $address))))
+      (i32.store (i32.xor (local.get $address) (i32.const 0x400)) (i32.add (local.get $sum) (local.get $x)))
+      (br_if $loop (local.tee $n (i32.sub (local.get $n) (i32.const 1))))
+    )
+    (local.get $sum)
+  )
+)
+
+(assert_return (invoke "random_access" (i32.const 32000000) (i32.const 1)) (i32.const 1872925636))
@@ -0,0 +1,30 @@
+(module
+  (memory 1)
+  (func (export "grow_pages") (param i32) (result i32)
+    i32.const 0
+    i32.const 42
+    i32.store
+    (loop
+      i32.const 1
+      memory.grow
+      i32.const 1
+      i32.add
+      i32.const 65536
+      i32.mul
+      i32.const 4
+      i32.sub
+      i32.const 7
+      i32.store
+      local.get 0
+      i32.const 1
+      i32.sub
+      local.tee 0
+      br_if 0)
+    memory.size
+    i32.const 0
+    i32.load
+    i32.add
+  )
+)
+
+(assert_return (invoke "grow_pages" (i32.const 2047)) (i32.const 2090))
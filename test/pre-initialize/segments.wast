@@ -0,0 +1,32 @@
+;; the start function and the init export ran once, before the binary was written
+(assert_return (invoke "starts") (i32.const 1))
+(assert_return (invoke "inits") (i32.const 1))
+(assert_return (invoke "value") (i64.const 0x123456789a))
+
+;; the memory image
+(assert_return (invoke "load" (i32.const 0)) (i32.const 0x64636261))
+(assert_return (invoke "load" (i32.const 16)) (i32.const 0x01020304))
+(assert_return (invoke "load" (i32.const 32)) (i32.const 0x7a797877))
+(assert_return (invoke "load" (i32.const 64)) (i32.const 0))
+
+;; the table
+(assert_trap (invoke "call" (i32.const 0)) "uninitialized element")
+(assert_return (invoke "call" (i32.const 1)) (i32.const 11))
+(assert_return (invoke "call" (i32.const 2)) (i32.const 22))
+(assert_return (invoke "call" (i32.const 3)) (i32.const 11))
+
+;; the passive segments can still be used
+(invoke "init_passive" (i32.const 48))
+(assert_return (invoke "load" (i32.const 48)) (i32.const 0x7a797877))
+(invoke "init_passive_elem" (i32.const 0))
+(assert_return (invoke "call" (i32.const 0)) (i32.const 22))
+
+;; the dropped segments stay dropped
+(invoke "init_dropped" (i32.const 0))
+(assert_trap (invoke "init_dropped" (i32.const 1)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 64)) (i32.const 0))
+(invoke "init_dropped_elem" (i32.const 0))
+(assert_trap (invoke "init_dropped_elem" (i32.const 1)) "out of bounds table access")
+
+;; the state is not shared with the pre-initialized instance
+(assert_return (invoke "starts") (i32.const 1))
@@ -0,0 +1,50 @@
+(module
+  (memory 1)
+  (table 4 funcref)
+  (global $starts (mut i32) (i32.const 0))
+  (global $inits (mut i32) (i32.const 0))
+  (global $value (mut i64) (i64.const 0))
+
+  (data (i32.const 0) "abcd")
+  (data $passive "wxyz")
+  (data $dropped "1234")
+  (elem $passive_elem func $eleven $twenty_two)
+  (elem $dropped_elem func $twenty_two)
+
+  (func $eleven (result i32) (i32.const 11))
+  (func $twenty_two (result i32) (i32.const 22))
+
+  (func $start
+    (global.set $starts (i32.add (global.get $starts) (i32.const 1)))
+    (i32.store (i32.const 16) (i32.const 0x01020304))
+    (table.init $passive_elem (i32.const 1) (i32.const 0) (i32.const 2))
+    (data.drop $dropped)
+    (elem.drop $dropped_elem)
+  )
+  (start $start)
+
+  (func (export "init")
+    (global.set $inits (i32.add (global.get $inits) (i32.const 1)))
+    (global.set $value (i64.const 0x123456789a))
+    (memory.init $passive (i32.const 32) (i32.const 0) (i32.const 4))
+    (table.set 0 (i32.const 3) (ref.func $eleven))
+  )
+
+  (func (export "starts") (result i32) (global.get $starts))
+  (func (export "inits") (result i32) (global.get $inits))
+  (func (export "value") (result i64) (global.get $value))
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+  (func (export "call") (param i32) (result i32) (call_indirect (result i32) (local.get 0)))
+  (func (export "init_passive") (param i32)
+    (memory.init $passive (local.get 0) (i32.const 0) (i32.const 4))
+  )
+  (func (export "init_dropped") (param i32)
+    (memory.init $dropped (i32.const 64) (i32.const 0) (local.get 0))
+  )
+  (func (export "init_passive_elem") (param i32)
+    (table.init $passive_elem (local.get 0) (i32.const 1) (i32.const 1))
+  )
+  (func (export "init_dropped_elem") (param i32)
+    (table.init $dropped_elem (i32.const 0) (i32.const 0) (local.get 0))
+  )
+)
@@ -0,0 +1,10 @@
+;; the start function ran once, before the binary was written
+(assert_return (invoke "counter") (i32.const 1))
+(assert_return (invoke "f32") (f32.const 1.5))
+(assert_return (invoke "f64") (f64.const -2.25))
+(assert_return (invoke "ref_is_null") (i32.const 0))
+
+;; the memory keeps its grown size and content
+(assert_return (invoke "size") (i32.const 2))
+(assert_return (invoke "load" (i32.const 131068)) (i32.const 1))
+(assert_trap (invoke "load" (i32.const 131069)) "out of bounds memory access")
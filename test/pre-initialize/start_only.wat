@@ -0,0 +1,28 @@
+(module
+  (memory 1 4)
+  (global $counter (mut i32) (i32.const 0))
+  (global $f32 (mut f32) (f32.const 0))
+  (global $f64 (mut f64) (f64.const 0))
+  (global $ref (mut funcref) (ref.null func))
+
+  (func $seven (result i32) (i32.const 7))
+  (elem declare func $seven)
+
+  (func $start
+    (global.set $counter (i32.add (global.get $counter) (i32.const 1)))
+    (global.set $f32 (f32.const 1.5))
+    (global.set $f64 (f64.const -2.25))
+    (global.set $ref (ref.func $seven))
+    (drop (memory.grow (i32.const 1)))
+    ;; the last bytes of the grown memory
+    (i32.store (i32.const 131068) (global.get $counter))
+  )
+  (start $start)
+
+  (func (export "counter") (result i32) (global.get $counter))
+  (func (export "f32") (result f32) (global.get $f32))
+  (func (export "f64") (result f64) (global.get $f64))
+  (func (export "ref_is_null") (result i32) (ref.is_null (global.get $ref)))
+  (func (export "size") (result i32) (memory.size))
+  (func (export "load") (param i32) (result i32) (i32.load (local.get 0)))
+)
@@ -493,6 +493,34 @@ Result ReadBinary(const void* data,
                   BinaryReaderDelegate* reader,
                   const ReadBinaryOptions& options);
 
+// Reads the body of a function of a module which was already read, offset
+// points after the size of the body. The memories are the limits of the
+// imported and defined memories of the module.
+Result ReadBinaryFunctionBody(const void* data,
+                              size_t size,
+                              const std::vector<Limits>& memories,
+                              Index func_index,
+                              Offset offset,
+                              Offset body_size,
+                              BinaryReaderDelegate* reader,
+                              const ReadBinaryOptions& options);
+
+// Reads a module whose bytes arrive in order. Read takes every byte received
+// so far and reads the sections and function bodies which are complete, the
+// bytes may be moved between the calls. Finish reads the rest of the module.
+// The reader stops at the first error.
+class StreamingBinaryReader {
+ public:
+  virtual ~StreamingBinaryReader() {}
+
+  virtual Result Read(const void* data, size_t size) = 0;
+  virtual Result Finish() = 0;
+};
+
+std::unique_ptr<StreamingBinaryReader> CreateStreamingBinaryReader(
+    BinaryReaderDelegate* reader,
+    const ReadBinaryOptions& options);
+
 size_t ReadU32Leb128(const uint8_t* ptr,
                      const uint8_t* end,
                      uint32_t* out_value);
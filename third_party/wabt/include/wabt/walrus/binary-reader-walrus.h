@@ -93,6 +93,9 @@ public:
     virtual void OnStartFunction(Index funcIndex) = 0;
 
     virtual void BeginFunctionBody(Index index, Offset size) = 0;
+    // called instead of the callbacks of the body when the function bodies
+    // are skipped, offset points after the size of the body
+    virtual void OnSkippedFunctionBody(Index index, size_t offset, size_t size) { }
 
     virtual void OnLocalDeclCount(Index count) = 0;
     virtual void OnLocalDecl(Index decl_index, Index count, Type type) = 0;
@@ -183,7 +186,28 @@ protected:
     size_t m_skipValidationUntil;
 };
 
-std::string ReadWasmBinary(const std::string& filename, const uint8_t *data, size_t size, WASMBinaryReaderDelegate* delegate);
+std::string ReadWasmBinary(const std::string& filename, const uint8_t *data, size_t size, WASMBinaryReaderDelegate* delegate, bool skipFunctionBodies = false);
+// Reads one function body of a module which was already read, the module
+// must be validated before. memoryCount includes the imported memories.
+std::string ReadWasmFunctionBody(const std::string& filename, const uint8_t *data, size_t size, Index memoryCount, Index funcIndex, size_t offset, size_t bodySize, WASMBinaryReaderDelegate* delegate);
+
+// Reads a module whose bytes arrive in order. read takes every byte received
+// so far, and passes the sections and function bodies whose bytes are
+// complete to the delegate. The bytes may move between the calls.
+class WASMStreamingBinaryReader {
+public:
+    WASMStreamingBinaryReader(const std::string& filename, WASMBinaryReaderDelegate* delegate, bool skipFunctionBodies = false);
+    ~WASMStreamingBinaryReader();
+
+    // returns the error, the reader must not be used after an error
+    std::string read(const uint8_t *data, size_t size);
+    // reads the rest of the module when no more bytes arrive
+    std::string finish();
+
+private:
+    struct State;
+    State* m_state;
+};
 
 }  // namespace wabt
 
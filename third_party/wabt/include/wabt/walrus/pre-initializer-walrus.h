@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WABT_PRE_INITIALIZER_WALRUS_H_
+#define WABT_PRE_INITIALIZER_WALRUS_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "wabt/base-types.h"
+
+namespace wabt {
+
+// value of a global or of a table element, references can only refer to
+// the functions of the module
+struct PreInitializedValue {
+    enum Kind {
+        I32,
+        I64,
+        F32,
+        F64,
+        RefNull,
+        RefFunc,
+    };
+
+    Kind kind;
+    // bits of numeric values, function index of RefFunc
+    uint64_t value;
+};
+
+struct PreInitializedTable {
+    Index size;
+    // the elements from offset, the remaining elements are null
+    Index offset;
+    std::vector<PreInitializedValue> elements;
+};
+
+struct PreInitializedMemory {
+    Index sizeInPages;
+    const uint8_t* buffer;
+    size_t sizeInByte;
+};
+
+// State of an instance of the module, the objects are listed in the order
+// of their index spaces and imported objects are not included.
+struct PreInitializedState {
+    Index functionCount;
+    std::vector<PreInitializedValue> globals;
+    std::vector<PreInitializedTable> tables;
+    std::vector<PreInitializedMemory> memories;
+    std::vector<bool> droppedDataSegments;
+    std::vector<bool> droppedElemSegments;
+};
+
+// Rewrites the module to a module which starts in the state: its data
+// segments hold the memory image, its globals and tables the values of the
+// state, and it has no start function. Returns the error message.
+std::string PreInitializeWasmBinary(const std::string& filename, const uint8_t* data, size_t size,
+                                    const PreInitializedState& state, std::vector<uint8_t>* output);
+
+}  // namespace wabt
+
+#endif  // WABT_PRE_INITIALIZER_WALRUS_H_
@@ -76,6 +76,16 @@ class BinaryReader {
                const ReadBinaryOptions& options);
 
   Result ReadModule(const ReadModuleOptions& options);
+  Result ReadFunctionBodyOfModule(const std::vector<Limits>& memories,
+                                  Index func_index,
+                                  Offset offset,
+                                  Offset body_size);
+  // Reads the sections and function bodies of a module whose bytes arrive
+  // in order. The data holds every byte received so far, the items which
+  // are not complete yet are read by a later call.
+  Result ReadAvailable(const void* data, size_t size);
+  // Reads the rest of the module when no more bytes arrive.
+  Result FinishModule();
 
  private:
   template <typename T, T BinaryReader::*member>
@@ -174,10 +184,24 @@ class BinaryReader {
   Result ReadStartSection(Offset section_size) WABT_WARN_UNUSED;
   Result ReadElemSection(Offset section_size) WABT_WARN_UNUSED;
   Result ReadCodeSection(Offset section_size) WABT_WARN_UNUSED;
+  Result ReadCode(Index func_index, Offset body_size) WABT_WARN_UNUSED;
   Result ReadDataSection(Offset section_size) WABT_WARN_UNUSED;
   Result ReadDataCountSection(Offset section_size) WABT_WARN_UNUSED;
   Result ReadTagSection(Offset section_size) WABT_WARN_UNUSED;
   Result ReadSections(const ReadSectionsOptions& options) WABT_WARN_UNUSED;
+  Result ReadHeader() WABT_WARN_UNUSED;
+  Result BeginSection(Index section_index,
+                      BinarySection section,
+                      Offset section_size,
+                      bool* seen_section_code) WABT_WARN_UNUSED;
+  Result ReadSectionContents(Index section_index,
+                             BinarySection section,
+                             Offset section_size,
+                             Result* result,
+                             bool* stop_on_first_error) WABT_WARN_UNUSED;
+  Result BeginCodeSection(Offset section_size) WABT_WARN_UNUSED;
+  Result ReadNextFunctionBody(Index body_index) WABT_WARN_UNUSED;
+  Result ReadAvailableItem(bool* out_read) WABT_WARN_UNUSED;
   Result ReportUnexpectedOpcode(Opcode opcode, const char* message = nullptr);
 
   size_t read_end_ = 0;  // Either the section end or data_size.
@@ -202,6 +226,18 @@ class BinaryReader {
   Index data_count_ = kInvalidIndex;
   std::vector<Limits> memories;
 
+  // state of a module which is read as its bytes arrive
+  struct StreamState {
+    bool header_read = false;
+    bool finished = false;
+    bool in_code_section = false;
+    Index section_index = 0;
+    bool seen_section_code[static_cast<int>(BinarySection::Last) + 1] = {false};
+    Offset code_section_end = 0;
+    Index next_function_body = 0;
+  };
+  StreamState stream_;
+
   using ReadEndRestoreGuard =
       ValueRestoreGuard<size_t, &BinaryReader::read_end_>;
 };
@@ -2731,46 +2767,58 @@ Result BinaryReader::ReadElemSection(Offset section_size) {
 }
 
 Result BinaryReader::ReadCodeSection(Offset section_size) {
+  CHECK_RESULT(BeginCodeSection(section_size));
+  for (Index i = 0; i < num_function_bodies_; ++i) {
+    CHECK_RESULT(ReadNextFunctionBody(i));
+  }
+  CALLBACK0(EndCodeSection);
+  return Result::Ok;
+}
+
+Result BinaryReader::BeginCodeSection(Offset section_size) {
   CALLBACK(BeginCodeSection, section_size);
   CHECK_RESULT(ReadCount(&num_function_bodies_, "function body count"));
   ERROR_UNLESS(num_function_signatures_ == num_function_bodies_,
                "function signature count != function body count");
   CALLBACK(OnFunctionBodyCount, num_function_bodies_);
-  for (Index i = 0; i < num_function_bodies_; ++i) {
-    Index func_index = num_func_imports_ + i;
-    Offset func_offset = state_.offset;
-    state_.offset = func_offset;
-    uint32_t body_size;
-    CHECK_RESULT(ReadU32Leb128(&body_size, "function body size"));
-    Offset body_start_offset = state_.offset;
-    Offset end_offset = body_start_offset + body_size;
-    CALLBACK(BeginFunctionBody, func_index, body_size);
-
-    uint64_t total_locals = 0;
-    Index num_local_decls;
-    CHECK_RESULT(ReadCount(&num_local_decls, "local declaration count"));
-    CALLBACK(OnLocalDeclCount, num_local_decls);
-    for (Index k = 0; k < num_local_decls; ++k) {
-      Index num_local_types;
-      CHECK_RESULT(ReadIndex(&num_local_types, "local type count"));
-      total_locals += num_local_types;
-      ERROR_UNLESS(total_locals < UINT32_MAX,
-                   "local count must be < 0x10000000");
-      Type local_type;
-      CHECK_RESULT(ReadType(&local_type, "local type"));
-      ERROR_UNLESS(IsConcreteType(local_type), "expected valid local type");
-      CALLBACK(OnLocalDecl, k, num_local_types, local_type);
-    }
+  return Result::Ok;
+}
 
-    if (options_.skip_function_bodies) {
-      state_.offset = end_offset;
-    } else {
-      CHECK_RESULT(ReadFunctionBody(end_offset));
-    }
+Result BinaryReader::ReadNextFunctionBody(Index body_index) {
+  Index func_index = num_func_imports_ + body_index;
+  uint32_t body_size;
+  CHECK_RESULT(ReadU32Leb128(&body_size, "function body size"));
+  return ReadCode(func_index, body_size);
+}
 
-    CALLBACK(EndFunctionBody, func_index);
+Result BinaryReader::ReadCode(Index func_index, Offset body_size) {
+  Offset body_start_offset = state_.offset;
+  Offset end_offset = body_start_offset + body_size;
+  CALLBACK(BeginFunctionBody, func_index, body_size);
+
+  uint64_t total_locals = 0;
+  Index num_local_decls;
+  CHECK_RESULT(ReadCount(&num_local_decls, "local declaration count"));
+  CALLBACK(OnLocalDeclCount, num_local_decls);
+  for (Index k = 0; k < num_local_decls; ++k) {
+    Index num_local_types;
+    CHECK_RESULT(ReadIndex(&num_local_types, "local type count"));
+    total_locals += num_local_types;
+    ERROR_UNLESS(total_locals < UINT32_MAX,
+                 "local count must be < 0x10000000");
+    Type local_type;
+    CHECK_RESULT(ReadType(&local_type, "local type"));
+    ERROR_UNLESS(IsConcreteType(local_type), "expected valid local type");
+    CALLBACK(OnLocalDecl, k, num_local_types, local_type);
   }
-  CALLBACK0(EndCodeSection);
+
+  if (options_.skip_function_bodies) {
+    state_.offset = end_offset;
+  } else {
+    CHECK_RESULT(ReadFunctionBody(end_offset));
+  }
+
+  CALLBACK(EndFunctionBody, func_index);
   return Result::Ok;
 }
 
@@ -2820,6 +2868,122 @@ Result BinaryReader::ReadDataCountSection(Offset section_size) {
   return Result::Ok;
 }
 
+Result BinaryReader::BeginSection(Index section_index,
+                                  BinarySection section,
+                                  Offset section_size,
+                                  bool* seen_section_code) {
+  if (section != BinarySection::Custom) {
+    int section_code = static_cast<int>(section);
+    if (seen_section_code[section_code]) {
+      PrintError("multiple %s sections", GetSectionName(section));
+      return Result::Error;
+    }
+    seen_section_code[section_code] = true;
+  }
+
+  ERROR_UNLESS(read_end_ <= state_.size,
+               "invalid section size: extends past end");
+
+  ERROR_UNLESS(
+      last_known_section_ == BinarySection::Invalid ||
+          section == BinarySection::Custom ||
+          GetSectionOrder(section) > GetSectionOrder(last_known_section_),
+      "section %s out of order", GetSectionName(section));
+
+  ERROR_UNLESS(!did_read_names_section_ || section == BinarySection::Custom,
+               "%s section can not occur after Name section",
+               GetSectionName(section));
+
+  ERROR_UNLESS(section != BinarySection::Tag ||
+                   options_.features.exceptions_enabled(),
+               "invalid section code: %u", static_cast<unsigned int>(section));
+  ERROR_UNLESS(section != BinarySection::DataCount ||
+                   options_.features.bulk_memory_enabled(),
+               "invalid section code: %u", static_cast<unsigned int>(section));
+
+  CALLBACK(BeginSection, section_index, section, section_size);
+  return Result::Ok;
+}
+
+Result BinaryReader::ReadSectionContents(Index section_index,
+                                         BinarySection section,
+                                         Offset section_size,
+                                         Result* result,
+                                         bool* stop_on_first_error) {
+  Result section_result = Result::Error;
+  switch (section) {
+    case BinarySection::Custom:
+      section_result = ReadCustomSection(section_index, section_size);
+      if (options_.fail_on_custom_section_error) {
+        *result |= section_result;
+      } else {
+        *stop_on_first_error = false;
+      }
+      break;
+    case BinarySection::Type:
+      section_result = ReadTypeSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Import:
+      section_result = ReadImportSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Function:
+      section_result = ReadFunctionSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Table:
+      section_result = ReadTableSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Memory:
+      section_result = ReadMemorySection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Global:
+      section_result = ReadGlobalSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Export:
+      section_result = ReadExportSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Start:
+      section_result = ReadStartSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Elem:
+      section_result = ReadElemSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Code:
+      section_result = ReadCodeSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Data:
+      section_result = ReadDataSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Tag:
+      section_result = ReadTagSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::DataCount:
+      section_result = ReadDataCountSection(section_size);
+      *result |= section_result;
+      break;
+    case BinarySection::Invalid:
+      WABT_UNREACHABLE;
+  }
+
+  if (Succeeded(section_result) && state_.offset != read_end_) {
+    PrintError("unfinished section (expected end: 0x%" PRIzx ")", read_end_);
+    section_result = Result::Error;
+    *result |= section_result;
+  }
+  return section_result;
+}
+
 Result BinaryReader::ReadSections(const ReadSectionsOptions& options) {
   Result result = Result::Ok;
   Index section_index = 0;
@@ -2848,107 +3012,12 @@ Result BinaryReader::ReadSections(const ReadSectionsOptions& options) {
     }
 
     BinarySection section = static_cast<BinarySection>(section_code);
-    if (section != BinarySection::Custom) {
-      if (seen_section_code[section_code]) {
-        PrintError("multiple %s sections", GetSectionName(section));
-        return Result::Error;
-      }
-      seen_section_code[section_code] = true;
-    }
-
-    ERROR_UNLESS(read_end_ <= state_.size,
-                 "invalid section size: extends past end");
-
-    ERROR_UNLESS(
-        last_known_section_ == BinarySection::Invalid ||
-            section == BinarySection::Custom ||
-            GetSectionOrder(section) > GetSectionOrder(last_known_section_),
-        "section %s out of order", GetSectionName(section));
-
-    ERROR_UNLESS(!did_read_names_section_ || section == BinarySection::Custom,
-                 "%s section can not occur after Name section",
-                 GetSectionName(section));
-
-    CALLBACK(BeginSection, section_index, section, section_size);
+    CHECK_RESULT(
+        BeginSection(section_index, section, section_size, seen_section_code));
 
     bool stop_on_first_error = options_.stop_on_first_error;
-    Result section_result = Result::Error;
-    switch (section) {
-      case BinarySection::Custom:
-        section_result = ReadCustomSection(section_index, section_size);
-        if (options_.fail_on_custom_section_error) {
-          result |= section_result;
-        } else {
-          stop_on_first_error = false;
-        }
-        break;
-      case BinarySection::Type:
-        section_result = ReadTypeSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Import:
-        section_result = ReadImportSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Function:
-        section_result = ReadFunctionSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Table:
-        section_result = ReadTableSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Memory:
-        section_result = ReadMemorySection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Global:
-        section_result = ReadGlobalSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Export:
-        section_result = ReadExportSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Start:
-        section_result = ReadStartSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Elem:
-        section_result = ReadElemSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Code:
-        section_result = ReadCodeSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Data:
-        section_result = ReadDataSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Tag:
-        ERROR_UNLESS(options_.features.exceptions_enabled(),
-                     "invalid section code: %u",
-                     static_cast<unsigned int>(section));
-        section_result = ReadTagSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::DataCount:
-        ERROR_UNLESS(options_.features.bulk_memory_enabled(),
-                     "invalid section code: %u",
-                     static_cast<unsigned int>(section));
-        section_result = ReadDataCountSection(section_size);
-        result |= section_result;
-        break;
-      case BinarySection::Invalid:
-        WABT_UNREACHABLE;
-    }
-
-    if (Succeeded(section_result) && state_.offset != read_end_) {
-      PrintError("unfinished section (expected end: 0x%" PRIzx ")", read_end_);
-      section_result = Result::Error;
-      result |= section_result;
-    }
+    Result section_result = ReadSectionContents(
+        section_index, section, section_size, &result, &stop_on_first_error);
 
     if (Failed(section_result)) {
       if (stop_on_first_error) {
@@ -2969,7 +3038,7 @@ Result BinaryReader::ReadSections(const ReadSectionsOptions& options) {
   return result;
 }
 
-Result BinaryReader::ReadModule(const ReadModuleOptions& options) {
+Result BinaryReader::ReadHeader() {
   uint32_t magic = 0;
   CHECK_RESULT(ReadU32(&magic, "magic"));
   ERROR_UNLESS(magic == WABT_BINARY_MAGIC, "bad magic value");
@@ -2980,6 +3049,11 @@ Result BinaryReader::ReadModule(const ReadModuleOptions& options) {
                WABT_BINARY_VERSION);
 
   CALLBACK(BeginModule, version);
+  return Result::Ok;
+}
+
+Result BinaryReader::ReadModule(const ReadModuleOptions& options) {
+  CHECK_RESULT(ReadHeader());
   CHECK_RESULT(ReadSections(ReadSectionsOptions{options.stop_on_first_error}));
   // This is checked in ReadCodeSection, but it must be checked at the end too,
   // in case the code section was omitted.
@@ -2990,6 +3064,196 @@ Result BinaryReader::ReadModule(const ReadModuleOptions& options) {
   return Result::Ok;
 }
 
+// A u32 leb128 can be read or reported as malformed when it ends before the
+// end of the data.
+static bool IsU32Leb128Complete(const uint8_t* p, const uint8_t* end) {
+  for (const uint8_t* byte = p; byte < end && byte < p + 5; ++byte) {
+    if (!(*byte & 0x80)) {
+      return true;
+    }
+  }
+  return end - p >= 5;
+}
+
+Result BinaryReader::ReadAvailable(const void* data, size_t size) {
+  // the bytes may be moved by the caller between the calls
+  state_.data = static_cast<const uint8_t*>(data);
+  state_.size = size;
+  bool read;
+  do {
+    CHECK_RESULT(ReadAvailableItem(&read));
+  } while (read);
+  return Result::Ok;
+}
+
+Result BinaryReader::FinishModule() {
+  // every item is read now, and the missing bytes are reported by the
+  // readers of the items
+  stream_.finished = true;
+  bool read;
+  do {
+    CHECK_RESULT(ReadAvailableItem(&read));
+  } while (read);
+  // This is checked in ReadCodeSection, but it must be checked at the end too,
+  // in case the code section was omitted.
+  ERROR_UNLESS(num_function_signatures_ == num_function_bodies_,
+               "function signature count != function body count");
+  CALLBACK0(EndModule);
+  return Result::Ok;
+}
+
+Result BinaryReader::ReadAvailableItem(bool* out_read) {
+  *out_read = false;
+  const uint8_t* end = state_.data + state_.size;
+  read_end_ = state_.size;
+
+  if (!stream_.header_read) {
+    if (!stream_.finished && state_.size < 8) {
+      return Result::Ok;
+    }
+    CHECK_RESULT(ReadHeader());
+    stream_.header_read = true;
+    *out_read = true;
+    return Result::Ok;
+  }
+
+  if (stream_.in_code_section) {
+    // the reads stop at the end of the section like in ReadSections
+    read_end_ = std::min(stream_.code_section_end, state_.size);
+    const uint8_t* p = state_.data + state_.offset;
+    bool section_complete = read_end_ == stream_.code_section_end;
+    ERROR_UNLESS(section_complete || !stream_.finished,
+                 "invalid section size: extends past end");
+    if (stream_.next_function_body < num_function_bodies_) {
+      if (!section_complete) {
+        uint32_t body_size;
+        size_t length = wabt::ReadU32Leb128(p, end, &body_size);
+        if (length == 0 ? !IsU32Leb128Complete(p, end)
+                        : state_.offset + length + body_size > state_.size) {
+          return Result::Ok;
+        }
+      }
+      CHECK_RESULT(ReadNextFunctionBody(stream_.next_function_body++));
+      *out_read = true;
+      return Result::Ok;
+    }
+
+    if (state_.offset != stream_.code_section_end) {
+      if (!section_complete) {
+        return Result::Ok;
+      }
+      PrintError("unfinished section (expected end: 0x%" PRIzx ")",
+                 stream_.code_section_end);
+      return Result::Error;
+    }
+    CALLBACK0(EndCodeSection);
+    stream_.in_code_section = false;
+    last_known_section_ = BinarySection::Code;
+    *out_read = true;
+    return Result::Ok;
+  }
+
+  if (state_.offset == state_.size) {
+    return Result::Ok;
+  }
+
+  const uint8_t* p = state_.data + state_.offset;
+  if (!stream_.finished) {
+    // a section is read when its bytes are complete, the code section when
+    // its function body count is complete
+    if (!IsU32Leb128Complete(p + 1, end)) {
+      return Result::Ok;
+    }
+    uint32_t section_size;
+    size_t length = wabt::ReadU32Leb128(p + 1, end, &section_size);
+    Offset contents_offset = state_.offset + 1 + length;
+    if (length && contents_offset + section_size > state_.size) {
+      if (*p != static_cast<uint8_t>(BinarySection::Code) ||
+          !IsU32Leb128Complete(state_.data + contents_offset, end)) {
+        return Result::Ok;
+      }
+    }
+  }
+
+  uint8_t section_code;
+  Offset section_size;
+  CHECK_RESULT(ReadU8(&section_code, "section code"));
+  CHECK_RESULT(ReadOffset(&section_size, "section size"));
+  ERROR_UNLESS(section_code < kBinarySectionCount, "invalid section code: %u",
+               section_code);
+
+  Index section_index = stream_.section_index++;
+  BinarySection section = static_cast<BinarySection>(section_code);
+  Offset section_end = state_.offset + section_size;
+  *out_read = true;
+  if (section == BinarySection::Code) {
+    // the bodies are checked against the section end as they arrive, only
+    // the function body count is read before the section is complete
+    read_end_ =
+        stream_.finished ? section_end : std::min(section_end, state_.size);
+    CHECK_RESULT(BeginSection(section_index, section, section_size,
+                              stream_.seen_section_code));
+    read_end_ = section_end;
+    CHECK_RESULT(BeginCodeSection(section_size));
+    stream_.in_code_section = true;
+    stream_.code_section_end = section_end;
+    stream_.next_function_body = 0;
+    return Result::Ok;
+  }
+
+  read_end_ = section_end;
+  CHECK_RESULT(BeginSection(section_index, section, section_size,
+                            stream_.seen_section_code));
+  Result result = Result::Ok;
+  bool stop_on_first_error = true;
+  Result section_result = ReadSectionContents(
+      section_index, section, section_size, &result, &stop_on_first_error);
+  if (Failed(section_result)) {
+    if (stop_on_first_error) {
+      return Result::Error;
+    }
+    state_.offset = read_end_;
+  }
+
+  if (section != BinarySection::Custom) {
+    last_known_section_ = section;
+  }
+  return Result::Ok;
+}
+
+Result BinaryReader::ReadFunctionBodyOfModule(
+    const std::vector<Limits>& memories,
+    Index func_index,
+    Offset offset,
+    Offset body_size) {
+  // the module was read before, so the instructions which need the data
+  // count section are valid
+  this->memories = memories;
+  data_count_ = 0;
+  ERROR_UNLESS(offset + body_size <= read_end_,
+               "function body out of the module");
+  state_.offset = offset;
+  return ReadCode(func_index, body_size);
+}
+
+class StreamingBinaryReaderImpl : public StreamingBinaryReader {
+ public:
+  StreamingBinaryReaderImpl(BinaryReaderDelegate* delegate,
+                            const ReadBinaryOptions& options)
+      : options_(options), reader_(nullptr, 0, delegate, options_) {}
+
+  Result Read(const void* data, size_t size) override {
+    return reader_.ReadAvailable(data, size);
+  }
+
+  Result Finish() override { return reader_.FinishModule(); }
+
+ private:
+  // the reader refers to the options
+  ReadBinaryOptions options_;
+  BinaryReader reader_;
+};
+
 }  // end anonymous namespace
 
 Result ReadBinary(const void* data,
@@ -3001,4 +3265,24 @@ Result ReadBinary(const void* data,
       BinaryReader::ReadModuleOptions{options.stop_on_first_error});
 }
 
+Result ReadBinaryFunctionBody(const void* data,
+                              size_t size,
+                              const std::vector<Limits>& memories,
+                              Index func_index,
+                              Offset offset,
+                              Offset body_size,
+                              BinaryReaderDelegate* delegate,
+                              const ReadBinaryOptions& options) {
+  BinaryReader reader(data, size, delegate, options);
+  return reader.ReadFunctionBodyOfModule(memories, func_index, offset,
+                                         body_size);
+}
+
+std::unique_ptr<StreamingBinaryReader> CreateStreamingBinaryReader(
+    BinaryReaderDelegate* delegate,
+    const ReadBinaryOptions& options) {
+  assert(options.stop_on_first_error);
+  return std::make_unique<StreamingBinaryReaderImpl>(delegate, options);
+}
+
 }  // namespace wabt
@@ -87,8 +87,8 @@ static Features getFeatures() {
 
 class BinaryReaderDelegateWalrus: public BinaryReaderDelegate {
 public:
-    BinaryReaderDelegateWalrus(WASMBinaryReaderDelegate *delegate, const std::string &filename) :
-        m_externalDelegate(delegate), m_filename(filename), m_validator(&m_errors, ValidateOptions(getFeatures())), m_lastInitType(Type::___), m_currentElementTableIndex(0) {
+    BinaryReaderDelegateWalrus(WASMBinaryReaderDelegate *delegate, const std::string &filename, bool skipFunctionBodies = false) :
+        m_externalDelegate(delegate), m_filename(filename), m_validator(&m_errors, ValidateOptions(getFeatures())), m_lastInitType(Type::___), m_currentElementTableIndex(0), m_skipFunctionBodies(skipFunctionBodies) {
 
     }
 
@@ -390,6 +390,10 @@ public:
         return Result::Ok;
     }
     Result BeginFunctionBody(Index index, Offset size) override {
+        if (m_skipFunctionBodies) {
+            m_externalDelegate->OnSkippedFunctionBody(index, state->offset, size);
+            return Result::Ok;
+        }
         m_labelStack.clear();
         CHECK_RESULT(m_validator.BeginFunctionBody(GetLocation(), index));
         PushLabel(LabelKind::Try);
@@ -397,10 +401,16 @@ public:
         return Result::Ok;
     }
     Result OnLocalDeclCount(Index count) override {
+        if (m_skipFunctionBodies) {
+            return Result::Ok;
+        }
         m_externalDelegate->OnLocalDeclCount(count);
         return Result::Ok;
     }
     Result OnLocalDecl(Index decl_index, Index count, Type type) override {
+        if (m_skipFunctionBodies) {
+            return Result::Ok;
+        }
         CHECK_RESULT(m_validator.OnLocalDecl(GetLocation(), count, type));
         m_externalDelegate->OnLocalDecl(decl_index, count, type);
         return Result::Ok;
@@ -909,6 +919,9 @@ public:
         return Result::Ok;
     }
     Result EndFunctionBody(Index index) override {
+        if (m_skipFunctionBodies) {
+            return Result::Ok;
+        }
         Index drop_count, keep_count;
         CHECK_RESULT(GetReturnDropKeepCount(&drop_count, &keep_count));
         CHECK_RESULT(m_validator.EndFunctionBody(GetLocation()));
@@ -965,7 +978,8 @@ public:
         CHECK_RESULT(m_validator.OnElemSegment(GetLocation(), Var(table_index, GetLocation()), mode));
         m_externalDelegate->BeginElemSegment(index, table_index, flags);
         m_lastInitType = Type::I32;
-        m_currentElementTableIndex = table_index;
+        // only the elements of active segments must match the type of the table
+        m_currentElementTableIndex = mode == SegmentKind::Active ? table_index : std::numeric_limits<Index>::max();
         return Result::Ok;
     }
     Result BeginElemSegmentInitExpr(Index index) override {
@@ -983,7 +997,7 @@ public:
         return Result::Ok;
     }
     Result OnElemSegmentElemType(Index index, Type elem_type) override {
-        m_validator.OnElemSegmentElemType(elem_type);
+        EXECUTE_VALIDATOR(m_validator.OnElemSegmentElemType(elem_type));
         m_externalDelegate->OnElemSegmentElemType(index, elem_type);
         return Result::Ok;
     }
@@ -1317,14 +1331,17 @@ public:
     Type m_lastInitType;
     std::vector<Type> m_tableTypes;
     Index m_currentElementTableIndex;
+    // only the ranges of the function bodies are reported
+    bool m_skipFunctionBodies;
 };
 
-std::string ReadWasmBinary(const std::string &filename, const uint8_t *data, size_t size, WASMBinaryReaderDelegate *delegate) {
+std::string ReadWasmBinary(const std::string &filename, const uint8_t *data, size_t size, WASMBinaryReaderDelegate *delegate, bool skipFunctionBodies) {
     const bool kReadDebugNames = false;
     const bool kStopOnFirstError = true;
     const bool kFailOnCustomSectionError = true;
     ReadBinaryOptions options(getFeatures(), nullptr, kReadDebugNames, kStopOnFirstError, kFailOnCustomSectionError);
-    BinaryReaderDelegateWalrus binaryReaderDelegateWalrus(delegate, filename);
+    options.skip_function_bodies = skipFunctionBodies;
+    BinaryReaderDelegateWalrus binaryReaderDelegateWalrus(delegate, filename, skipFunctionBodies);
     try {
         ReadBinary(data, size, &binaryReaderDelegateWalrus, options);
     } catch(const std::string& err) {
@@ -1338,4 +1355,77 @@ std::string ReadWasmBinary(const std::string &filename, const uint8_t *data, siz
     return std::string();
 }
 
+std::string ReadWasmFunctionBody(const std::string &filename, const uint8_t *data, size_t size, Index memoryCount, Index funcIndex, size_t offset, size_t bodySize, WASMBinaryReaderDelegate *delegate) {
+    const bool kReadDebugNames = false;
+    const bool kStopOnFirstError = true;
+    const bool kFailOnCustomSectionError = true;
+    ReadBinaryOptions options(getFeatures(), nullptr, kReadDebugNames, kStopOnFirstError, kFailOnCustomSectionError);
+    BinaryReaderDelegateWalrus binaryReaderDelegateWalrus(delegate, filename);
+    try {
+        // memory64 is disabled, so only the number of memories matters
+        std::vector<Limits> memories(memoryCount);
+        ReadBinaryFunctionBody(data, size, memories, funcIndex, offset, bodySize, &binaryReaderDelegateWalrus, options);
+    } catch(const std::string& err) {
+        // error from WASMBinaryReader
+        return err;
+    }
+
+    if (binaryReaderDelegateWalrus.m_errors.size()) {
+        return std::move(binaryReaderDelegateWalrus.m_errors.begin()->message);
+    }
+    return std::string();
+}
+
+struct WASMStreamingBinaryReader::State {
+    State(const std::string &filename, WASMBinaryReaderDelegate *delegate, bool skipFunctionBodies)
+        : m_options(getFeatures(), nullptr, false, true, true)
+        , m_delegate(delegate, filename, skipFunctionBodies)
+    {
+        m_options.skip_function_bodies = skipFunctionBodies;
+        m_reader = CreateStreamingBinaryReader(&m_delegate, m_options);
+    }
+
+    std::string error() {
+        if (m_delegate.m_errors.size()) {
+            return std::move(m_delegate.m_errors.begin()->message);
+        }
+        return std::string();
+    }
+
+    // not read debug names, stop on first error, fail on custom section error
+    ReadBinaryOptions m_options;
+    BinaryReaderDelegateWalrus m_delegate;
+    std::unique_ptr<StreamingBinaryReader> m_reader;
+};
+
+WASMStreamingBinaryReader::WASMStreamingBinaryReader(const std::string &filename, WASMBinaryReaderDelegate *delegate, bool skipFunctionBodies)
+    : m_state(new State(filename, delegate, skipFunctionBodies))
+{
+}
+
+WASMStreamingBinaryReader::~WASMStreamingBinaryReader()
+{
+    delete m_state;
+}
+
+std::string WASMStreamingBinaryReader::read(const uint8_t *data, size_t size) {
+    try {
+        m_state->m_reader->Read(data, size);
+    } catch(const std::string& err) {
+        // error from WASMBinaryReader
+        return err;
+    }
+    return m_state->error();
+}
+
+std::string WASMStreamingBinaryReader::finish() {
+    try {
+        m_state->m_reader->Finish();
+    } catch(const std::string& err) {
+        // error from WASMBinaryReader
+        return err;
+    }
+    return m_state->error();
+}
+
 }  // namespace wabt
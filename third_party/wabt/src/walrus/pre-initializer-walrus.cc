@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022-present Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wabt/binary-reader.h"
+#include "wabt/binary-reader-ir.h"
+#include "wabt/binary-writer.h"
+#include "wabt/ir.h"
+#include "wabt/stream.h"
+
+#include "wabt/walrus/pre-initializer-walrus.h"
+
+namespace wabt {
+
+// zero bytes between two non-zero ranges of the memory image which are
+// worth an extra data segment instead of being stored
+static const size_t kMinimumZeroGap = 32;
+
+static void AppendValue(ExprList& expr, Type type, const PreInitializedValue& value) {
+    switch (value.kind) {
+    case PreInitializedValue::I32:
+        expr.push_back(std::make_unique<ConstExpr>(Const::I32(static_cast<uint32_t>(value.value))));
+        break;
+    case PreInitializedValue::I64:
+        expr.push_back(std::make_unique<ConstExpr>(Const::I64(value.value)));
+        break;
+    case PreInitializedValue::F32:
+        expr.push_back(std::make_unique<ConstExpr>(Const::F32(static_cast<uint32_t>(value.value))));
+        break;
+    case PreInitializedValue::F64:
+        expr.push_back(std::make_unique<ConstExpr>(Const::F64(value.value)));
+        break;
+    case PreInitializedValue::RefNull:
+        expr.push_back(std::make_unique<RefNullExpr>(type));
+        break;
+    case PreInitializedValue::RefFunc:
+        expr.push_back(std::make_unique<RefFuncExpr>(Var(static_cast<Index>(value.value), Location())));
+        break;
+    }
+}
+
+static void RewriteGlobals(Module& module, const PreInitializedState& state) {
+    for (size_t i = 0; i < state.globals.size(); i++) {
+        Global* global = module.globals[module.num_global_imports + i];
+        global->init_expr.clear();
+        AppendValue(global->init_expr, global->type, state.globals[i]);
+    }
+}
+
+static void RewriteTables(Module& module, const PreInitializedState& state) {
+    // active segments were dropped during instantiation, and dropped
+    // segments are declarative ones, which still declare their functions
+    for (size_t i = 0; i < module.elem_segments.size(); i++) {
+        ElemSegment* segment = module.elem_segments[i];
+        if (segment->kind == SegmentKind::Active || (segment->kind == SegmentKind::Passive && state.droppedElemSegments[i])) {
+            segment->kind = SegmentKind::Declared;
+            segment->offset.clear();
+        }
+    }
+
+    for (size_t i = 0; i < state.tables.size(); i++) {
+        Table* table = module.tables[i];
+        const PreInitializedTable& current = state.tables[i];
+        table->elem_limits.initial = current.size;
+        if (current.elements.empty()) {
+            continue;
+        }
+
+        auto field = std::make_unique<ElemSegmentModuleField>();
+        ElemSegment& segment = field->elem_segment;
+        segment.kind = SegmentKind::Active;
+        segment.table_var = Var(i, Location());
+        segment.elem_type = table->elem_type;
+        segment.offset.push_back(std::make_unique<ConstExpr>(Const::I32(current.offset)));
+        for (const PreInitializedValue& element : current.elements) {
+            ExprList expr;
+            AppendValue(expr, table->elem_type, element);
+            segment.elem_exprs.push_back(std::move(expr));
+        }
+        module.AppendField(std::move(field));
+    }
+}
+
+static void RewriteMemories(Module& module, const PreInitializedState& state) {
+    // the image replaces the active segments, which were dropped during
+    // instantiation like the segments dropped by data.drop
+    for (size_t i = 0; i < module.data_segments.size(); i++) {
+        DataSegment* segment = module.data_segments[i];
+        if (segment->kind == SegmentKind::Active || state.droppedDataSegments[i]) {
+            segment->kind = SegmentKind::Passive;
+            segment->offset.clear();
+            segment->data.clear();
+        }
+    }
+
+    for (size_t i = 0; i < state.memories.size(); i++) {
+        const PreInitializedMemory& memory = state.memories[i];
+        module.memories[i]->page_limits.initial = memory.sizeInPages;
+
+        const uint8_t* buffer = memory.buffer;
+        size_t size = memory.sizeInByte;
+        size_t offset = 0;
+        while (true) {
+            while (offset < size && buffer[offset] == 0) {
+                offset++;
+            }
+            if (offset == size) {
+                break;
+            }
+
+            // the range ends at the first long enough run of zero bytes
+            size_t end = offset;
+            size_t zeroCount = 0;
+            while (end < size && zeroCount < kMinimumZeroGap) {
+                zeroCount = buffer[end] ? 0 : zeroCount + 1;
+                end++;
+            }
+            end -= zeroCount;
+
+            auto field = std::make_unique<DataSegmentModuleField>();
+            DataSegment& segment = field->data_segment;
+            segment.kind = SegmentKind::Active;
+            segment.memory_var = Var(i, Location());
+            segment.offset.push_back(std::make_unique<ConstExpr>(Const::I32(offset)));
+            segment.data.assign(buffer + offset, buffer + end);
+            module.AppendField(std::move(field));
+            offset = end;
+        }
+    }
+}
+
+std::string PreInitializeWasmBinary(const std::string& filename, const uint8_t* data, size_t size,
+                                    const PreInitializedState& state, std::vector<uint8_t>* output) {
+    Features features;
+    features.EnableAll();
+
+    Errors errors;
+    Module module;
+    ReadBinaryOptions readOptions(features, nullptr, true, true, false);
+    if (Failed(ReadBinaryIr(filename.c_str(), data, size, readOptions, &errors, &module))) {
+        return errors.size() ? errors.front().message : "failed to read " + filename;
+    }
+
+    if (module.num_memory_imports || module.num_table_imports) {
+        return "imported memories and tables are not supported";
+    }
+    if (module.globals.size() != module.num_global_imports + state.globals.size()
+        || module.tables.size() != state.tables.size()
+        || module.memories.size() != state.memories.size()
+        || module.funcs.size() != state.functionCount
+        || module.data_segments.size() != state.droppedDataSegments.size()
+        || module.elem_segments.size() != state.droppedElemSegments.size()) {
+        return "the binary does not match the module of the instance";
+    }
+
+    // the start function already ran
+    module.starts.clear();
+    for (auto it = module.fields.begin(); it != module.fields.end();) {
+        if (it->type() == ModuleFieldType::Start) {
+            it = module.fields.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    RewriteGlobals(module, state);
+    RewriteTables(module, state);
+    RewriteMemories(module, state);
+
+    MemoryStream stream;
+    WriteBinaryOptions writeOptions(features, true, false, true);
+    if (Failed(WriteBinaryModule(&stream, &module, writeOptions))) {
+        return "failed to write the pre-initialized module";
+    }
+    *output = std::move(stream.ReleaseOutputBuffer()->data);
+    return std::string();
+}
+
+}  // namespace wabt
@@ -28,6 +28,7 @@ from glob import glob
 from os.path import abspath, basename, dirname, join, relpath
 from shutil import copy
 from subprocess import PIPE, Popen
+from tempfile import NamedTemporaryFile
 
 
 PROJECT_SOURCE_DIR = dirname(dirname(abspath(__file__)))
@@ -100,10 +101,10 @@ def readfile(filename):
     with open(filename, 'r') as f:
         return f.readlines()
     
-def _run_wast_tests(engine, files, is_fail):
+def _run_wast_tests(engine, files, is_fail, options=[]):
     fails = 0
     for file in files:
-        proc = Popen([engine, file], stdout=PIPE)
+        proc = Popen([engine] + options + [file], stdout=PIPE)
         out, _ = proc.communicate()
 
         if is_fail and proc.returncode or not is_fail and not proc.returncode:
@@ -151,6 +152,305 @@ def run_basic_tests(engine):
     if fail_total > 0:
         raise Exception("basic wasm-test-core failed")
 
+def _run_basic_tests_with_options(engine, name, options):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'basic')
+
+    print('Running basic tests with %s:' % ' '.join(options))
+    xpass = glob(join(TEST_DIR, '*'))
+    xpass_result = _run_wast_tests(engine, xpass, False, options)
+
+    tests_total = len(xpass)
+    fail_total = xpass_result
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("%s failed" % name)
+
+def _run_wasm_test_core_with_options(engine, name, options):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'wasm-spec', 'core')
+
+    print('Running wasm-test-core tests with %s:' % ' '.join(options))
+    xpass = glob(join(TEST_DIR, '*.wast'))
+    xpass_result = _run_wast_tests(engine, xpass, False, options)
+
+    tests_total = len(xpass)
+    fail_total = xpass_result
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("%s failed" % name)
+
+@runner('instance-pool-tests', default=True)
+def run_instance_pool_tests(engine):
+    # a small pool, so the later modules of a script also use the normal allocation
+    _run_basic_tests_with_options(engine, 'instance pool tests', ['--instance-pool', '8'])
+    _run_wasm_test_core_with_options(engine, 'instance pool tests', ['--instance-pool', '8'])
+
+@runner('instance-snapshot-tests', default=True)
+def run_instance_snapshot_tests(engine):
+    _run_basic_tests_with_options(engine, 'instance snapshot tests', ['--instantiate-from-snapshot'])
+    _run_wasm_test_core_with_options(engine, 'instance snapshot tests', ['--instantiate-from-snapshot'])
+    # the snapshots are mapped into the memory reservations of the pool slots
+    _run_basic_tests_with_options(engine, 'instance snapshot tests', ['--instantiate-from-snapshot', '--instance-pool', '8'])
+
+@runner('memory-file-tests', default=True)
+def run_memory_file_tests(engine):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'memory-file')
+
+    print('Running memory file tests:')
+    content = bytearray(i % 256 for i in range(4100))
+    with NamedTemporaryFile() as memory_file:
+        memory_file.write(content)
+        memory_file.flush()
+
+        xpass = glob(join(TEST_DIR, '*.wast'))
+        xpass_result = _run_wast_tests(engine, xpass, False, ['--memory-file', memory_file.name])
+
+        # the stores of the memories are not written back
+        memory_file.seek(0)
+        if memory_file.read() != content:
+            print('%sFAIL: the content of %s changed%s' % (COLOR_RED, memory_file.name, COLOR_RESET))
+            xpass_result += 1
+
+    tests_total = len(xpass)
+    fail_total = xpass_result
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("memory file tests failed")
+
+@runner('pre-initialize-tests', default=True)
+def run_pre_initialize_tests(engine):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'pre-initialize')
+
+    # each .wat module is pre-initialized and the output is checked by the
+    # commands of the .wast file with the same name
+    print('Running pre-initialize tests:')
+    xpass = glob(join(TEST_DIR, '*.wat'))
+    fail_total = 0
+    for file in xpass:
+        options = ['--pre-initialize']
+        with NamedTemporaryFile(suffix='.wasm') as output, NamedTemporaryFile(mode='w', suffix='.wast') as script:
+            options.append(output.name)
+            if '(export "init")' in ''.join(readfile(file)):
+                options += ['--init-export', 'init']
+            proc = Popen([engine] + options + [file], stdout=PIPE)
+            out, _ = proc.communicate()
+            if not proc.returncode:
+                binary = ''.join('\\%02x' % byte for byte in output.read())
+                script.write('(module binary "%s")\n' % binary)
+                script.writelines(readfile(file[:-len('.wat')] + '.wast'))
+                script.flush()
+                proc = Popen([engine, script.name], stdout=PIPE)
+                out, _ = proc.communicate()
+
+            if not proc.returncode:
+                print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+            else:
+                print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+                print(out)
+                fail_total += 1
+
+    tests_total = len(xpass)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fail_total, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fail_total, COLOR_RESET))
+
+    if fail_total > 0:
+        raise Exception("pre-initialize tests failed")
+
+@runner('compilation-threads-tests', default=True)
+def run_compilation_threads_tests(engine):
+    _run_basic_tests_with_options(engine, 'compilation threads tests', ['--compilation-threads', '3'])
+
+@runner('lazy-compilation-tests', default=True)
+def run_lazy_compilation_tests(engine):
+    _run_basic_tests_with_options(engine, 'lazy compilation tests', ['--lazy-compilation'])
+
+@runner('streaming-compilation-tests', default=True)
+def run_streaming_compilation_tests(engine):
+    # small odd chunks split the section and body sizes
+    _run_basic_tests_with_options(engine, 'streaming compilation tests', ['--streaming-compilation', '7', '--compilation-threads', '2'])
+
+# statistics printed by an engine built with WALRUS_BYTECODE_STATS
+BYTECODE_STATS_EXPECTATIONS = {
+    'loop_bounds_check.wast': ['loop bounds check hoisting of %s: 9 of 10 loops hoisted'],
+}
+
+@runner('bytecode-stats-tests')
+def run_bytecode_stats_tests(engine):
+    TEST_DIR = join(PROJECT_SOURCE_DIR, 'test', 'basic')
+
+    print('Running bytecode stats tests:')
+    fails = 0
+    for name, expectations in sorted(BYTECODE_STATS_EXPECTATIONS.items()):
+        file = join(TEST_DIR, name)
+        proc = Popen([engine, file], stdout=PIPE, stderr=PIPE)
+        _, err = proc.communicate()
+        lines = err.decode('utf-8').splitlines()
+
+        missing = [line % file for line in expectations if line % file not in lines]
+        if proc.returncode or missing:
+            print('%sFAIL(%d): %s%s' % (COLOR_RED, proc.returncode, file, COLOR_RESET))
+            for line in missing:
+                print('expected: %s' % line)
+            print('\n'.join(lines))
+            fails += 1
+        else:
+            print('%sOK: %s%s' % (COLOR_GREEN, file, COLOR_RESET))
+
+    tests_total = len(BYTECODE_STATS_EXPECTATIONS)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fails, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fails, COLOR_RESET))
+
+    if fails > 0:
+        raise Exception("bytecode stats tests failed")
+
+def _run_perf_tests(engine, name, test_dir):
+    print('Running %s:' % name)
+    fails = 0
+    files = glob(join(test_dir, '*.wast'))
+    for file in files:
+        start = time.time()
+        fails += _run_wast_tests(engine, [file], False)
+        print('%s: %.3fs' % (basename(file), time.time() - start))
+
+    tests_total = len(files)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fails, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fails, COLOR_RESET))
+
+    if fails > 0:
+        raise Exception("%s failed" % name)
+
+@runner('perf-tests')
+def run_perf_tests(engine):
+    _run_perf_tests(engine, 'perf tests', join(PROJECT_SOURCE_DIR, 'test', 'perf'))
+
+# compares the bounds checks of WALRUS_BOUNDS_CHECK=explicit and guard_page
+@runner('memory-perf-tests')
+def run_memory_perf_tests(engine):
+    _run_perf_tests(engine, 'memory perf tests', join(PROJECT_SOURCE_DIR, 'test', 'memory-perf'))
+
+def _write_parse_benchmark(file, function_count, local_count, statement_count):
+    # every statement swaps two locals, so the locals are updated while
+    # their values are still on the stack
+    param = 1
+    locals = [param] + [0] * local_count
+    for i in range(statement_count):
+        a = 1 + i % local_count
+        b = 1 + (i * 7 + 3) % local_count
+        locals[a], locals[b] = (locals[b] + param) & 0xffffffff, locals[a]
+    result = (locals[1] + locals[local_count]) & 0xffffffff
+
+    file.write('(module\n')
+    for func in range(function_count):
+        file.write('  (func $f%d (export "f%d") (param i32) (result i32)\n' % (func, func))
+        file.write('    (local%s)\n' % (' i32' * local_count))
+        for i in range(statement_count):
+            a = 1 + i % local_count
+            b = 1 + (i * 7 + 3) % local_count
+            file.write('    local.get %d local.get %d local.get 0 i32.add local.set %d local.set %d\n' % (a, b, a, b))
+        file.write('    local.get 1 local.get %d i32.add)\n' % local_count)
+    file.write(')\n')
+    file.write('(assert_return (invoke "f0" (i32.const %d)) (i32.const %d))\n' % (param, result))
+
+def _write_late_update_benchmark(file, function_count, local_count, statement_count):
+    # the locals are updated while they are still on the stack only at the
+    # end of the function, so a function which is compiled again for every
+    # updated local is compiled local_count + 1 times
+    param = 1
+    locals = [param] + list(range(1, local_count + 1))
+    for i in range(statement_count):
+        locals[0] = (locals[1 + i % local_count] + locals[1 + (i * 7 + 3) % local_count]) & 0xffffffff
+    for i in range(1, local_count + 1):
+        locals[0], locals[i] = (locals[i] + locals[0]) & 0xffffffff, locals[0]
+    result = locals[0]
+
+    file.write('(module\n')
+    for func in range(function_count):
+        file.write('  (func $f%d (export "f%d") (param i32) (result i32)\n' % (func, func))
+        file.write('    (local%s)\n' % (' i32' * local_count))
+        for i in range(1, local_count + 1):
+            file.write('    i32.const %d local.set %d\n' % (i, i))
+        for i in range(statement_count):
+            file.write('    local.get %d local.get %d i32.add local.set 0\n' % (1 + i % local_count, 1 + (i * 7 + 3) % local_count))
+        for i in range(1, local_count + 1):
+            file.write('    local.get %d local.get 0 local.set %d local.get %d i32.add local.set 0\n' % (i, i, i))
+        file.write('    local.get 0)\n')
+    file.write(')\n')
+    file.write('(assert_return (invoke "f0" (i32.const %d)) (i32.const %d))\n' % (param, result))
+
+def _write_nesting_benchmark(file, local_count, depth):
+    # every block takes a parameter and leaves a value of the enclosing
+    # block below it, so the value stack grows with the nesting
+    param = 1
+    locals = [param] + list(range(1, local_count + 1))
+    a = [1 + (k * 13) % local_count for k in range(depth)]
+    b = [local_count - (k * 7) % local_count for k in range(depth)]
+    result = locals[b[depth - 1]] + param
+    for k in range(depth - 2, -1, -1):
+        result = locals[b[k]] + locals[a[k + 1]] + result
+    result = (locals[a[0]] + result) & 0xffffffff
+
+    file.write('(module\n')
+    file.write('  (type $t (func (param i32) (result i32)))\n')
+    file.write('  (func (export "f") (param i32) (result i32)\n')
+    file.write('    (local%s)\n' % (' i32' * local_count))
+    for i in range(1, local_count + 1):
+        file.write('    i32.const %d local.set %d\n' % (i, i))
+    for k in range(depth):
+        file.write('    local.get %d local.get %d block (type $t)\n' % (a[k], b[k]))
+    file.write('    local.get 0 i32.add\n')
+    for k in range(depth - 1):
+        file.write('    end i32.add i32.add\n')
+    file.write('    end i32.add)\n')
+    file.write(')\n')
+    file.write('(assert_return (invoke "f" (i32.const %d)) (i32.const %d))\n' % (param, result))
+
+@runner('parse-perf-tests')
+def run_parse_perf_tests(engine):
+    import tempfile
+
+    print('Running parse perf tests:')
+    fails = 0
+    configs = [
+        ('%d functions, %d locals, %d statements' % config, _write_parse_benchmark, config)
+        for config in [(16, 64, 20000), (2000, 8, 200)]
+    ] + [
+        # stack offsets of the bytecode are 16 bit wide, which limits the
+        # size of a single function
+        ('%d locals, %d nested blocks' % config, _write_nesting_benchmark, config)
+        for config in [(3000, 2500)]
+    ] + [
+        ('%d functions, %d locals updated after %d statements' % config, _write_late_update_benchmark, config)
+        for config in [(16, 64, 20000)]
+    ]
+    for name, write, config in configs:
+        with tempfile.NamedTemporaryFile(mode='w', suffix='.wast', delete=False) as file:
+            write(file, *config)
+        try:
+            start = time.time()
+            fails += _run_wast_tests(engine, [file.name], False)
+            print('%s: %.3fs' % (name, time.time() - start))
+        finally:
+            os.remove(file.name)
+
+    tests_total = len(configs)
+    print('TOTAL: %d' % (tests_total))
+    print('%sPASS : %d%s' % (COLOR_GREEN, tests_total - fails, COLOR_RESET))
+    print('%sFAIL : %d%s' % (COLOR_RED, fails, COLOR_RESET))
+
+    if fails > 0:
+        raise Exception("parse perf tests failed")
+
 def main():
     parser = ArgumentParser(description='Walrus Test Suite Runner')
     parser.add_argument('--engine', metavar='PATH', default=DEFAULT_WALRUS,